@@ -0,0 +1,257 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016-2019, Regents of the University of California,
+ *                          Colorado State University,
+ *                          University Pierre & Marie Curie, Sorbonne University.
+ *
+ * This file is part of ndn-tools (Named Data Networking Essential Tools).
+ * See AUTHORS.md for complete list of ndn-tools authors and contributors.
+ *
+ * ndn-tools is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-tools is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-tools, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tools/chunks/crypto/content-decryptor.hpp"
+#include "tools/chunks/crypto/aes.hpp"
+#include "tools/chunks/crypto/data-enc-dec.hpp"
+#include "tools/chunks/crypto/error.hpp"
+#include "tools/chunks/crypto/rsa.hpp"
+#include "tools/chunks/crypto/x25519.hpp"
+
+#include "tests/test-common.hpp"
+
+#include <ndn-cxx/encoding/block-helpers.hpp>
+
+#include <sstream>
+
+namespace ndn {
+namespace chunks {
+namespace tests {
+
+using namespace ndn::tests;
+
+class ContentDecryptorFixture
+{
+protected:
+  ContentDecryptorFixture()
+    : privateKey(crypto::X25519::generateKey())
+    , publicKey(crypto::X25519::deriveEncryptKey(privateKey))
+    , payload(10000)
+  {
+    for (size_t i = 0; i < payload.size(); ++i) {
+      payload[i] = static_cast<uint8_t>(i * 31);
+    }
+  }
+
+  /**
+   * @brief Feed the encoding of @p content to @p decryptor in pieces of @p pieceSize bytes
+   */
+  static void
+  writeInPieces(ContentDecryptor& decryptor, const Block& content, size_t pieceSize)
+  {
+    for (size_t offset = 0; offset < content.size(); offset += pieceSize) {
+      decryptor.write(content.wire() + offset, std::min(pieceSize, content.size() - offset));
+    }
+  }
+
+  void
+  checkOutput() const
+  {
+    std::string output = os.str();
+    BOOST_CHECK_EQUAL_COLLECTIONS(output.begin(), output.end(), payload.begin(), payload.end());
+  }
+
+protected:
+  const Buffer privateKey;
+  const Buffer publicKey;
+  Buffer payload;
+  std::ostringstream os;
+};
+
+BOOST_AUTO_TEST_SUITE(Chunks)
+BOOST_FIXTURE_TEST_SUITE(TestContentDecryptor, ContentDecryptorFixture)
+
+BOOST_AUTO_TEST_CASE(KeyFirst)
+{
+  Block content = encryptDataContentWithCK(payload.data(), payload.size(),
+                                           publicKey.data(), publicKey.size(),
+                                           crypto::KEY_WRAP_X25519);
+
+  for (size_t pieceSize : {1, 7, 1000, 100000}) {
+    os.str("");
+    ContentDecryptor decryptor(privateKey, os);
+    writeInPieces(decryptor, content, pieceSize);
+
+    // the key and the IV come first, so decryption overlaps with the input
+    BOOST_CHECK_GT(os.str().size(), 0);
+    BOOST_CHECK_EQUAL(decryptor.isFinished(), false);
+
+    decryptor.end();
+    BOOST_CHECK_EQUAL(decryptor.isFinished(), true);
+    checkOutput();
+  }
+}
+
+BOOST_AUTO_TEST_CASE(KeyFirstRsa)
+{
+  RsaKeyParams params;
+  Buffer rsaPrivateKey = crypto::Rsa::generateKey(params);
+  Buffer rsaPublicKey = crypto::Rsa::deriveEncryptKey(rsaPrivateKey);
+  Block content = encryptDataContentWithCK(payload.data(), payload.size(),
+                                           rsaPublicKey.data(), rsaPublicKey.size(),
+                                           crypto::KEY_WRAP_RSA);
+
+  ContentDecryptor decryptor(rsaPrivateKey, os);
+  writeInPieces(decryptor, content, 100);
+  decryptor.end();
+  checkOutput();
+}
+
+BOOST_AUTO_TEST_CASE(PayloadFirst)
+{
+  // layout of content encrypted before the key and the IV were moved to the front
+  AesKeyParams params;
+  Buffer aesKey = crypto::Aes::generateKey(params);
+  Buffer iv = crypto::Aes::generateIV();
+  Buffer encryptedPayload = crypto::Aes::encrypt(aesKey.data(), aesKey.size(),
+                                                 payload.data(), payload.size(), iv);
+  Block content = makeEmptyBlock(tlv::Content);
+  content.push_back(makeBinaryBlock(ENCRYPTED_PAYLOAD,
+                                    encryptedPayload.data(), encryptedPayload.size()));
+  wrapContentKey(content, aesKey, publicKey.data(), publicKey.size(), crypto::KEY_WRAP_X25519);
+  content.push_back(makeBinaryBlock(INITIAL_VECTOR, iv.data(), iv.size()));
+  content.encode();
+
+  ContentDecryptor decryptor(privateKey, os);
+  writeInPieces(decryptor, content, 100);
+  // the ciphertext is buffered until end()
+  BOOST_CHECK_EQUAL(os.str().size(), 0);
+
+  decryptor.end();
+  BOOST_CHECK_EQUAL(decryptor.isFinished(), true);
+  checkOutput();
+}
+
+BOOST_AUTO_TEST_CASE(LocatorKeyDuringInput)
+{
+  AesKeyParams params;
+  Buffer aesKey = crypto::Aes::generateKey(params);
+  Name ckName("/drop/CK/epoch=1");
+  Block content = encryptDataContentWithLocator(payload.data(), payload.size(), aesKey, ckName);
+
+  std::vector<Name> requested;
+  ContentDecryptor* decryptorPtr = nullptr;
+  ContentDecryptor decryptor(privateKey, os, [&] (const Name& name) {
+    requested.push_back(name);
+    decryptorPtr->setContentKey(aesKey);
+  });
+  decryptorPtr = &decryptor;
+
+  writeInPieces(decryptor, content, 100);
+  BOOST_REQUIRE_EQUAL(requested.size(), 1);
+  BOOST_CHECK_EQUAL(requested[0], ckName);
+  BOOST_CHECK_GT(os.str().size(), 0);
+
+  decryptor.end();
+  BOOST_CHECK_EQUAL(decryptor.isFinished(), true);
+  checkOutput();
+}
+
+BOOST_AUTO_TEST_CASE(LocatorKeyAfterEnd)
+{
+  AesKeyParams params;
+  Buffer aesKey = crypto::Aes::generateKey(params);
+  Name ckName("/drop/CK/epoch=1");
+  Block content = encryptDataContentWithLocator(payload.data(), payload.size(), aesKey, ckName);
+
+  int nRequests = 0;
+  ContentDecryptor decryptor(privateKey, os, [&] (const Name&) { ++nRequests; });
+  writeInPieces(decryptor, content, 100);
+  decryptor.end();
+  BOOST_CHECK_EQUAL(nRequests, 1);
+  BOOST_CHECK_EQUAL(os.str().size(), 0);
+  BOOST_CHECK_EQUAL(decryptor.isFinished(), false);
+
+  // the flush deferred by end() happens once the key arrives
+  decryptor.setContentKey(aesKey);
+  BOOST_CHECK_EQUAL(decryptor.isFinished(), true);
+  checkOutput();
+
+  BOOST_CHECK_THROW(decryptor.setContentKey(aesKey), crypto::Error);
+}
+
+BOOST_AUTO_TEST_CASE(LocatorWithoutCallback)
+{
+  AesKeyParams params;
+  Buffer aesKey = crypto::Aes::generateKey(params);
+  Block content = encryptDataContentWithLocator(payload.data(), payload.size(),
+                                                aesKey, "/drop/CK/epoch=1");
+
+  ContentDecryptor decryptor(privateKey, os);
+  BOOST_CHECK_THROW(writeInPieces(decryptor, content, 100), crypto::Error);
+}
+
+BOOST_AUTO_TEST_CASE(UnexpectedContentKey)
+{
+  ContentDecryptor decryptor(privateKey, os);
+  BOOST_CHECK_THROW(decryptor.setContentKey(Buffer(16)), crypto::Error);
+}
+
+BOOST_AUTO_TEST_CASE(Malformed)
+{
+  Block content = encryptDataContentWithCK(payload.data(), payload.size(),
+                                           publicKey.data(), publicKey.size(),
+                                           crypto::KEY_WRAP_X25519);
+
+  // truncated
+  {
+    ContentDecryptor decryptor(privateKey, os);
+    decryptor.write(content.wire(), content.size() - 1);
+    BOOST_CHECK_THROW(decryptor.end(), tlv::Error);
+  }
+
+  // trailing data
+  {
+    ContentDecryptor decryptor(privateKey, os);
+    decryptor.write(content.wire(), content.size());
+    BOOST_CHECK_THROW(decryptor.write(content.wire(), 1), tlv::Error);
+  }
+
+  // not a Content element
+  {
+    ContentDecryptor decryptor(privateKey, os);
+    Block data = makeBinaryBlock(tlv::Data, payload.data(), 16);
+    BOOST_CHECK_THROW(decryptor.write(data.wire(), data.size()), tlv::Error);
+  }
+
+  // element overflowing the Content
+  {
+    ContentDecryptor decryptor(privateKey, os);
+    const uint8_t wire[] = {0x15, 0x04, 0xfd, 0x02, 0x76, 0x08};
+    BOOST_CHECK_THROW(decryptor.write(wire, sizeof(wire)), tlv::Error);
+  }
+}
+
+BOOST_AUTO_TEST_CASE(MatchesDecryptDataContent)
+{
+  Block content = encryptDataContentWithCK(payload.data(), payload.size(),
+                                           publicKey.data(), publicKey.size(),
+                                           crypto::KEY_WRAP_X25519);
+  Buffer decrypted = decryptDataContent(content, privateKey.data(), privateKey.size());
+  BOOST_CHECK_EQUAL_COLLECTIONS(decrypted.begin(), decrypted.end(), payload.begin(), payload.end());
+}
+
+BOOST_AUTO_TEST_SUITE_END() // TestContentDecryptor
+BOOST_AUTO_TEST_SUITE_END() // Chunks
+
+} // namespace tests
+} // namespace chunks
+} // namespace ndn
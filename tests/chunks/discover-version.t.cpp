@@ -0,0 +1,218 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016-2019, Regents of the University of California,
+ *                          Colorado State University,
+ *                          University Pierre & Marie Curie, Sorbonne University.
+ *
+ * This file is part of ndn-tools (Named Data Networking Essential Tools).
+ * See AUTHORS.md for complete list of ndn-tools authors and contributors.
+ *
+ * ndn-tools is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-tools is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-tools, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tools/chunks/ndndropretrieve/discover-version.hpp"
+
+#include "tests/test-common.hpp"
+#include "tests/identity-management-fixture.hpp"
+
+#include <ndn-cxx/metadata-object.hpp>
+#include <ndn-cxx/util/dummy-client-face.hpp>
+
+namespace ndn {
+namespace chunks {
+namespace tests {
+
+using namespace ndn::tests;
+
+class DiscoverVersionFixture : public IdentityManagementTimeFixture
+{
+protected:
+  DiscoverVersionFixture()
+    : face(io)
+    , prefix("/drop/file")
+    , versionedName(Name(prefix).appendVersion(1))
+  {
+    opt.interestLifetime = 1_s;
+    opt.maxRetriesOnTimeoutOrNack = 0;
+  }
+
+  void
+  run()
+  {
+    discover = make_unique<DiscoverVersion>(face, prefix, opt);
+    discover->onDiscoverySuccess.connect([this] (const Name& name) {
+      discoveredNames.push_back(name);
+    });
+    discover->onDiscoveryFailure.connect([this] (const std::string& reason) {
+      failures.push_back(reason);
+    });
+    discover->run();
+    advanceClocks(io, 1_ms);
+  }
+
+  /**
+   * @brief The metadata Interest and the speculative Interest for the bare prefix
+   */
+  void
+  checkSentInterests()
+  {
+    BOOST_REQUIRE_EQUAL(face.sentInterests.size(), 2);
+    const Interest& metadataInterest = face.sentInterests[0];
+    BOOST_CHECK_EQUAL(metadataInterest.getName(),
+                      MetadataObject::makeDiscoveryInterest(prefix).getName());
+    const Interest& firstSegmentInterest = face.sentInterests[1];
+    BOOST_CHECK_EQUAL(firstSegmentInterest.getName(), prefix);
+    BOOST_CHECK_EQUAL(firstSegmentInterest.getCanBePrefix(), true);
+    BOOST_CHECK_EQUAL(firstSegmentInterest.getMustBeFresh(), true);
+  }
+
+  void
+  sendMetadata(const Name& name)
+  {
+    MetadataObject mobject;
+    mobject.setVersionedName(name);
+    face.receive(mobject.makeData(face.sentInterests[0].getName(), m_keyChain,
+                                  security::signingWithSha256()));
+    advanceClocks(io, 1_ms);
+  }
+
+  void
+  sendMetadataNack()
+  {
+    face.receive(makeNack(face.sentInterests[0], lp::NackReason::NO_ROUTE));
+    advanceClocks(io, 1_ms);
+  }
+
+  void
+  sendSegment(const Name& name)
+  {
+    auto data = makeData(name);
+    data->setFreshnessPeriod(1_s);
+    face.receive(*data);
+    advanceClocks(io, 1_ms);
+  }
+
+protected:
+  boost::asio::io_service io;
+  util::DummyClientFace face;
+  Options opt;
+  const Name prefix;
+  const Name versionedName;
+  unique_ptr<DiscoverVersion> discover;
+  std::vector<Name> discoveredNames;
+  std::vector<std::string> failures;
+};
+
+BOOST_AUTO_TEST_SUITE(Chunks)
+BOOST_FIXTURE_TEST_SUITE(TestDiscoverVersion, DiscoverVersionFixture)
+
+BOOST_AUTO_TEST_CASE(FirstSegmentFirst)
+{
+  run();
+  checkSentInterests();
+
+  sendSegment(Name(versionedName).appendSegment(0));
+  BOOST_REQUIRE_EQUAL(discoveredNames.size(), 1);
+  BOOST_CHECK_EQUAL(discoveredNames[0], versionedName);
+  BOOST_REQUIRE(discover->getFirstSegment());
+  BOOST_CHECK_EQUAL(discover->getFirstSegment()->getName(), Name(versionedName).appendSegment(0));
+
+  // the metadata Interest is abandoned
+  advanceClocks(io, 10_ms, 300);
+  BOOST_CHECK_EQUAL(face.sentInterests.size(), 2);
+  BOOST_CHECK_EQUAL(discoveredNames.size(), 1);
+  BOOST_CHECK(failures.empty());
+}
+
+BOOST_AUTO_TEST_CASE(MetadataFirst)
+{
+  run();
+  checkSentInterests();
+
+  sendMetadata(versionedName);
+  BOOST_REQUIRE_EQUAL(discoveredNames.size(), 1);
+  BOOST_CHECK_EQUAL(discoveredNames[0], versionedName);
+  BOOST_CHECK(!discover->getFirstSegment());
+
+  // segment 0 arriving later is left to the pipeline
+  sendSegment(Name(versionedName).appendSegment(0));
+  advanceClocks(io, 10_ms, 300);
+  BOOST_CHECK_EQUAL(discoveredNames.size(), 1);
+  BOOST_CHECK(!discover->getFirstSegment());
+  BOOST_CHECK(failures.empty());
+}
+
+BOOST_AUTO_TEST_CASE(NotFirstSegment)
+{
+  run();
+  checkSentInterests();
+
+  // a packet that is not segment 0 of a version leaves the decision to the metadata
+  sendSegment(Name(versionedName).appendSegment(3));
+  BOOST_CHECK(discoveredNames.empty());
+
+  sendMetadata(versionedName);
+  BOOST_REQUIRE_EQUAL(discoveredNames.size(), 1);
+  BOOST_CHECK_EQUAL(discoveredNames[0], versionedName);
+  BOOST_CHECK(!discover->getFirstSegment());
+}
+
+BOOST_AUTO_TEST_CASE(MetadataFailureWhileSpeculating)
+{
+  run();
+  checkSentInterests();
+
+  // the failure is held back while segment 0 may still arrive
+  sendMetadataNack();
+  BOOST_CHECK(failures.empty());
+
+  sendSegment(Name(versionedName).appendSegment(0));
+  BOOST_REQUIRE_EQUAL(discoveredNames.size(), 1);
+  BOOST_CHECK_EQUAL(discoveredNames[0], versionedName);
+  BOOST_CHECK(failures.empty());
+}
+
+BOOST_AUTO_TEST_CASE(MetadataFailureAfterSpeculation)
+{
+  run();
+  checkSentInterests();
+
+  sendMetadataNack();
+  BOOST_CHECK(failures.empty());
+
+  // the speculative Interest times out
+  advanceClocks(io, 10_ms, 150);
+  BOOST_CHECK(discoveredNames.empty());
+  BOOST_CHECK_EQUAL(failures.size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(VersionedPrefix)
+{
+  discover = make_unique<DiscoverVersion>(face, versionedName, opt);
+  discover->onDiscoverySuccess.connect([this] (const Name& name) {
+    discoveredNames.push_back(name);
+  });
+  discover->run();
+  advanceClocks(io, 1_ms);
+
+  BOOST_REQUIRE_EQUAL(discoveredNames.size(), 1);
+  BOOST_CHECK_EQUAL(discoveredNames[0], versionedName);
+  BOOST_CHECK(face.sentInterests.empty());
+  BOOST_CHECK(!discover->getFirstSegment());
+}
+
+BOOST_AUTO_TEST_SUITE_END() // TestDiscoverVersion
+BOOST_AUTO_TEST_SUITE_END() // Chunks
+
+} // namespace tests
+} // namespace chunks
+} // namespace ndn
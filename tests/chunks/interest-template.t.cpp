@@ -0,0 +1,127 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016-2019, Regents of the University of California,
+ *                          Colorado State University,
+ *                          University Pierre & Marie Curie, Sorbonne University.
+ *
+ * This file is part of ndn-tools (Named Data Networking Essential Tools).
+ * See AUTHORS.md for complete list of ndn-tools authors and contributors.
+ *
+ * ndn-tools is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-tools is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-tools, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tools/chunks/ndndropretrieve/interest-template.hpp"
+
+#include "tests/test-common.hpp"
+
+#include <ndn-cxx/delegation-list.hpp>
+
+#include <set>
+
+namespace ndn {
+namespace chunks {
+namespace tests {
+
+using namespace ndn::tests;
+
+class InterestTemplateFixture
+{
+protected:
+  ~InterestTemplateFixture()
+  {
+    name::setConventionEncoding(name::Convention::TYPED);
+  }
+
+  /**
+   * @brief Check that @p tmpl encodes the same Interests as the ndn-cxx encoder
+   */
+  static void
+  checkAgainstEncoder(const InterestTemplate& tmpl, const Name& prefix, bool mustBeFresh,
+                      time::milliseconds lifetime, const Name& forwardingHint = Name())
+  {
+    for (uint64_t segNo : {UINT64_C(0), UINT64_C(1), UINT64_C(255), UINT64_C(256),
+                           UINT64_C(65536), UINT64_C(4294967296), UINT64_C(0xFFFFFFFFFFFFFFFF)}) {
+      Interest interest = tmpl.make(segNo);
+
+      Interest expected(Name(prefix).appendSegment(segNo));
+      expected.setCanBePrefix(false);
+      expected.setMustBeFresh(mustBeFresh);
+      expected.setInterestLifetime(lifetime);
+      if (!forwardingHint.empty()) {
+        expected.setForwardingHint(DelegationList{{0, forwardingHint}});
+      }
+      expected.setNonce(interest.getNonce());
+
+      BOOST_CHECK_EQUAL(interest.getName(), expected.getName());
+      BOOST_CHECK_EQUAL(interest.getName().at(-1).toSegment(), segNo);
+      const Block& wire = interest.wireEncode();
+      const Block& expectedWire = expected.wireEncode();
+      BOOST_CHECK_EQUAL_COLLECTIONS(wire.begin(), wire.end(),
+                                    expectedWire.begin(), expectedWire.end());
+    }
+  }
+};
+
+BOOST_AUTO_TEST_SUITE(Chunks)
+BOOST_FIXTURE_TEST_SUITE(TestInterestTemplate, InterestTemplateFixture)
+
+BOOST_AUTO_TEST_CASE(TypedConvention)
+{
+  name::setConventionEncoding(name::Convention::TYPED);
+  Name prefix("/drop/file/v=1");
+  checkAgainstEncoder(InterestTemplate(prefix, true, 1_s), prefix, true, 1_s);
+  checkAgainstEncoder(InterestTemplate(prefix, false, 10_s), prefix, false, 10_s);
+}
+
+BOOST_AUTO_TEST_CASE(MarkerConvention)
+{
+  name::setConventionEncoding(name::Convention::MARKER);
+  Name prefix("/drop/file");
+  prefix.appendVersion(1);
+  checkAgainstEncoder(InterestTemplate(prefix, true, 1_s), prefix, true, 1_s);
+  checkAgainstEncoder(InterestTemplate(prefix, false, 10_s), prefix, false, 10_s);
+}
+
+BOOST_AUTO_TEST_CASE(ForwardingHint)
+{
+  Name prefix("/drop/file/v=1");
+  Name hint("/isp/router");
+  checkAgainstEncoder(InterestTemplate(prefix, true, 2_s, hint), prefix, true, 2_s, hint);
+}
+
+BOOST_AUTO_TEST_CASE(DefaultLifetime)
+{
+  // the template always encodes the lifetime, which the encoder omits when it is the default
+  Interest interest = InterestTemplate("/drop/file/v=1", true, DEFAULT_INTEREST_LIFETIME).make(3);
+  BOOST_CHECK_EQUAL(interest.getName(), Name("/drop/file/v=1").appendSegment(3));
+  BOOST_CHECK_EQUAL(interest.getCanBePrefix(), false);
+  BOOST_CHECK_EQUAL(interest.getMustBeFresh(), true);
+  BOOST_CHECK_EQUAL(interest.getInterestLifetime(), DEFAULT_INTEREST_LIFETIME);
+}
+
+BOOST_AUTO_TEST_CASE(FreshNonce)
+{
+  InterestTemplate tmpl("/drop/file/v=1", true, 1_s);
+  std::set<Interest::Nonce> nonces;
+  for (int i = 0; i < 10; ++i) {
+    nonces.insert(tmpl.make(0).getNonce());
+  }
+  // the chance of a collision among 10 random 32-bit nonces is negligible
+  BOOST_CHECK_EQUAL(nonces.size(), 10);
+}
+
+BOOST_AUTO_TEST_SUITE_END() // TestInterestTemplate
+BOOST_AUTO_TEST_SUITE_END() // Chunks
+
+} // namespace tests
+} // namespace chunks
+} // namespace ndn
@@ -0,0 +1,199 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016-2019, Regents of the University of California,
+ *                          Colorado State University,
+ *                          University Pierre & Marie Curie, Sorbonne University.
+ *
+ * This file is part of ndn-tools (Named Data Networking Essential Tools).
+ * See AUTHORS.md for complete list of ndn-tools authors and contributors.
+ *
+ * ndn-tools is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-tools is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-tools, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tools/chunks/ndndropretrieve/reorder-buffer.hpp"
+
+#include "tests/test-common.hpp"
+
+namespace ndn {
+namespace chunks {
+namespace tests {
+
+using namespace ndn::tests;
+
+BOOST_AUTO_TEST_SUITE(Chunks)
+BOOST_AUTO_TEST_SUITE(TestReorderBuffer)
+
+static void
+insertSegment(ReorderBuffer& buffer, uint64_t segNo, size_t size)
+{
+  std::vector<uint8_t> content(size, static_cast<uint8_t>(segNo));
+  buffer.insert(segNo, content.data(), content.size());
+}
+
+BOOST_AUTO_TEST_CASE(InOrder)
+{
+  ReorderBuffer buffer(4);
+  BOOST_CHECK_EQUAL(buffer.hasNext(), false);
+
+  insertSegment(buffer, 0, 10);
+  BOOST_REQUIRE_EQUAL(buffer.hasNext(), true);
+  BOOST_CHECK_EQUAL(buffer.front().size(), 10);
+  BOOST_CHECK_EQUAL(buffer.front()[0], 0);
+  BOOST_CHECK_EQUAL(buffer.size(), 1);
+  BOOST_CHECK_EQUAL(buffer.getBufferedBytes(), 10);
+
+  buffer.pop();
+  BOOST_CHECK_EQUAL(buffer.getNextSegment(), 1);
+  BOOST_CHECK_EQUAL(buffer.hasNext(), false);
+  BOOST_CHECK_EQUAL(buffer.size(), 0);
+  BOOST_CHECK_EQUAL(buffer.getBufferedBytes(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(OutOfOrder)
+{
+  ReorderBuffer buffer(4);
+  insertSegment(buffer, 2, 30);
+  insertSegment(buffer, 1, 20);
+  BOOST_CHECK_EQUAL(buffer.hasNext(), false);
+  BOOST_CHECK_EQUAL(buffer.contains(1), true);
+  BOOST_CHECK_EQUAL(buffer.contains(2), true);
+  BOOST_CHECK_EQUAL(buffer.contains(3), false);
+  BOOST_CHECK_EQUAL(buffer.size(), 2);
+  BOOST_CHECK_EQUAL(buffer.getBufferedBytes(), 50);
+
+  insertSegment(buffer, 0, 10);
+  for (uint64_t segNo = 0; segNo < 3; ++segNo) {
+    BOOST_REQUIRE_EQUAL(buffer.hasNext(), true);
+    BOOST_CHECK_EQUAL(buffer.front().size(), (segNo + 1) * 10);
+    BOOST_CHECK_EQUAL(buffer.front()[0], segNo);
+    buffer.pop();
+  }
+  BOOST_CHECK_EQUAL(buffer.getNextSegment(), 3);
+  BOOST_CHECK_EQUAL(buffer.size(), 0);
+  BOOST_CHECK_EQUAL(buffer.getBufferedBytes(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(StaleAndDuplicate)
+{
+  ReorderBuffer buffer(4);
+  insertSegment(buffer, 0, 10);
+  buffer.pop();
+
+  // already written
+  insertSegment(buffer, 0, 10);
+  BOOST_CHECK_EQUAL(buffer.contains(0), false);
+  BOOST_CHECK_EQUAL(buffer.size(), 0);
+
+  // the first copy is kept
+  insertSegment(buffer, 1, 10);
+  insertSegment(buffer, 1, 20);
+  BOOST_CHECK_EQUAL(buffer.size(), 1);
+  BOOST_CHECK_EQUAL(buffer.getBufferedBytes(), 10);
+  BOOST_CHECK_EQUAL(buffer.front().size(), 10);
+}
+
+BOOST_AUTO_TEST_CASE(Wraparound)
+{
+  ReorderBuffer buffer(4);
+  BOOST_CHECK_EQUAL(buffer.getCapacity(), 4);
+
+  // keep up to 4 segments in flight while the ring wraps around many times
+  for (uint64_t segNo = 0; segNo < 100; ++segNo) {
+    insertSegment(buffer, segNo, 8);
+    if (segNo >= 3) {
+      BOOST_REQUIRE_EQUAL(buffer.hasNext(), true);
+      BOOST_CHECK_EQUAL(buffer.front()[0], static_cast<uint8_t>(buffer.getNextSegment()));
+      buffer.pop();
+    }
+  }
+  BOOST_CHECK_EQUAL(buffer.getCapacity(), 4);
+  BOOST_CHECK_EQUAL(buffer.size(), 3);
+  BOOST_CHECK_EQUAL(buffer.getNextSegment(), 97);
+}
+
+BOOST_AUTO_TEST_CASE(Grow)
+{
+  ReorderBuffer buffer(4);
+  insertSegment(buffer, 1, 10);
+  insertSegment(buffer, 3, 10);
+
+  // beyond the span of the ring
+  insertSegment(buffer, 10, 10);
+  BOOST_CHECK_EQUAL(buffer.getCapacity(), 16);
+  BOOST_CHECK_EQUAL(buffer.size(), 3);
+  BOOST_CHECK_EQUAL(buffer.contains(1), true);
+  BOOST_CHECK_EQUAL(buffer.contains(3), true);
+  BOOST_CHECK_EQUAL(buffer.contains(10), true);
+  BOOST_CHECK_EQUAL(buffer.contains(2), false);
+
+  insertSegment(buffer, 0, 10);
+  for (uint64_t segNo : {0, 1}) {
+    BOOST_REQUIRE_EQUAL(buffer.hasNext(), true);
+    BOOST_CHECK_EQUAL(buffer.front()[0], segNo);
+    buffer.pop();
+  }
+  BOOST_CHECK_EQUAL(buffer.hasNext(), false);
+}
+
+BOOST_AUTO_TEST_CASE(RetainedBytes)
+{
+  ReorderBuffer buffer(4);
+  insertSegment(buffer, 0, 100);
+  insertSegment(buffer, 1, 100);
+  BOOST_CHECK_GE(buffer.getRetainedBytes(), 200);
+
+  // without a limit, popped slots keep their memory for reuse
+  buffer.pop();
+  buffer.pop();
+  BOOST_CHECK_EQUAL(buffer.getBufferedBytes(), 0);
+  BOOST_CHECK_GE(buffer.getRetainedBytes(), 200);
+
+  buffer.clear();
+  BOOST_CHECK_EQUAL(buffer.getRetainedBytes(), 0);
+  BOOST_CHECK_EQUAL(buffer.getNextSegment(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(MaxIdleBytes)
+{
+  ReorderBuffer buffer(4);
+  buffer.setMaxIdleBytes(0);
+  insertSegment(buffer, 0, 100);
+  insertSegment(buffer, 1, 100);
+  size_t retained = buffer.getRetainedBytes();
+
+  buffer.pop();
+  BOOST_CHECK_LT(buffer.getRetainedBytes(), retained);
+  buffer.pop();
+  BOOST_CHECK_EQUAL(buffer.getRetainedBytes(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(GrowReleasesIdleMemory)
+{
+  ReorderBuffer buffer(4);
+  insertSegment(buffer, 0, 100);
+  insertSegment(buffer, 1, 100);
+  buffer.pop();
+  size_t retained = buffer.getRetainedBytes();
+  BOOST_CHECK_GE(retained - buffer.getBufferedBytes(), 100);
+
+  // the memory of the slot emptied by pop() is not carried over
+  insertSegment(buffer, 20, 10);
+  BOOST_CHECK_EQUAL(buffer.getCapacity(), 32);
+  BOOST_CHECK_LT(buffer.getRetainedBytes(), retained);
+}
+
+BOOST_AUTO_TEST_SUITE_END() // TestReorderBuffer
+BOOST_AUTO_TEST_SUITE_END() // Chunks
+
+} // namespace tests
+} // namespace chunks
+} // namespace ndn
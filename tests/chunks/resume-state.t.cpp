@@ -0,0 +1,164 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016-2019, Regents of the University of California,
+ *                          Colorado State University,
+ *                          University Pierre & Marie Curie, Sorbonne University.
+ *
+ * This file is part of ndn-tools (Named Data Networking Essential Tools).
+ * See AUTHORS.md for complete list of ndn-tools authors and contributors.
+ *
+ * ndn-tools is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-tools is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-tools, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tools/chunks/ndndropretrieve/resume-state.hpp"
+
+#include "tests/test-common.hpp"
+
+#include <boost/filesystem.hpp>
+#include <fstream>
+
+namespace ndn {
+namespace chunks {
+namespace tests {
+
+using namespace ndn::tests;
+
+class ResumeStateFixture
+{
+protected:
+  ResumeStateFixture()
+    : dir(boost::filesystem::path(TMP_TESTS_PATH) / "resume-state")
+    , path((dir / "file.ndndrop-resume").string())
+  {
+    boost::filesystem::create_directories(dir);
+  }
+
+  ~ResumeStateFixture()
+  {
+    boost::filesystem::remove_all(dir);
+  }
+
+  void
+  writeFile(const std::string& contents)
+  {
+    std::ofstream os(path, std::ios::binary | std::ios::trunc);
+    os << contents;
+  }
+
+  void
+  writeFile(const Buffer& contents)
+  {
+    writeFile(std::string(contents.begin(), contents.end()));
+  }
+
+protected:
+  const boost::filesystem::path dir;
+  const std::string path;
+};
+
+BOOST_AUTO_TEST_SUITE(Chunks)
+BOOST_FIXTURE_TEST_SUITE(TestResumeState, ResumeStateFixture)
+
+BOOST_AUTO_TEST_CASE(AddSegment)
+{
+  ResumeState state("/drop/file/v=1");
+  BOOST_CHECK_EQUAL(state.getNSegments(), 0);
+  BOOST_CHECK_EQUAL(state.hasSegment(0), false);
+
+  state.addSegment(0);
+  state.addSegment(9);
+  state.addSegment(9);
+  BOOST_CHECK_EQUAL(state.getNSegments(), 2);
+  BOOST_CHECK_EQUAL(state.hasSegment(0), true);
+  BOOST_CHECK_EQUAL(state.hasSegment(8), false);
+  BOOST_CHECK_EQUAL(state.hasSegment(9), true);
+  BOOST_CHECK_EQUAL(state.hasSegment(1000), false);
+}
+
+BOOST_AUTO_TEST_CASE(RoundTrip)
+{
+  ResumeState state("/drop/file/v=1");
+  state.segmentSize = 8000;
+  state.lastSegmentNo = 20;
+  state.fileSize = 164321;
+  for (uint64_t segNo : {0, 1, 7, 8, 15, 20}) {
+    state.addSegment(segNo);
+  }
+  writeFile(state.serialize());
+
+  optional<ResumeState> loaded = ResumeState::load(path);
+  BOOST_REQUIRE(loaded);
+  BOOST_CHECK_EQUAL(loaded->versionedName, state.versionedName);
+  BOOST_CHECK_EQUAL(loaded->segmentSize, 8000);
+  BOOST_REQUIRE(loaded->lastSegmentNo);
+  BOOST_CHECK_EQUAL(*loaded->lastSegmentNo, 20);
+  BOOST_REQUIRE(loaded->fileSize);
+  BOOST_CHECK_EQUAL(*loaded->fileSize, 164321);
+  BOOST_CHECK_EQUAL(loaded->getNSegments(), 6);
+  for (uint64_t segNo = 0; segNo <= 20; ++segNo) {
+    BOOST_CHECK_EQUAL(loaded->hasSegment(segNo), state.hasSegment(segNo));
+  }
+
+  Buffer reserialized = loaded->serialize();
+  Buffer serialized = state.serialize();
+  BOOST_CHECK_EQUAL_COLLECTIONS(reserialized.begin(), reserialized.end(),
+                                serialized.begin(), serialized.end());
+}
+
+BOOST_AUTO_TEST_CASE(RoundTripUnknown)
+{
+  ResumeState state("/drop/file/v=1");
+  writeFile(state.serialize());
+
+  optional<ResumeState> loaded = ResumeState::load(path);
+  BOOST_REQUIRE(loaded);
+  BOOST_CHECK_EQUAL(loaded->versionedName, state.versionedName);
+  BOOST_CHECK_EQUAL(loaded->segmentSize, 0);
+  BOOST_CHECK(!loaded->lastSegmentNo);
+  BOOST_CHECK(!loaded->fileSize);
+  BOOST_CHECK_EQUAL(loaded->getNSegments(), 0);
+}
+
+BOOST_AUTO_TEST_CASE(Missing)
+{
+  BOOST_CHECK(!ResumeState::load(path));
+}
+
+BOOST_AUTO_TEST_CASE(Malformed)
+{
+  const std::string valid = "ndndrop-resume 1\n/drop/file/v=1\n8000\n20\n-1\n0381\n";
+  writeFile(valid);
+  BOOST_CHECK(ResumeState::load(path));
+
+  std::vector<std::string> malformed{
+    "",
+    "ndndrop-resume 2\n/drop/file/v=1\n8000\n20\n-1\n0381\n",
+    "ndndrop-resume 1\n/drop/file/v=1\n",
+    "ndndrop-resume 1\n/drop/file/v=1\n8000x\n20\n-1\n0381\n",
+    "ndndrop-resume 1\n/drop/file/v=1\n8000\ntwenty\n-1\n0381\n",
+    "ndndrop-resume 1\n/drop/file/v=1\n8000\n20\n-2\n0381\n",
+    "ndndrop-resume 1\n/drop/file/v=1\n 8000\n20\n-1\n0381\n",
+    "ndndrop-resume 1\n/drop/file/v=1\n8000\n20\n-1\n038\n",
+    "ndndrop-resume 1\n/drop/file/v=1\n8000\n20\n-1\nzz81\n",
+  };
+  for (const auto& contents : malformed) {
+    writeFile(contents);
+    BOOST_CHECK_THROW(ResumeState::load(path), ResumeState::Error);
+  }
+}
+
+BOOST_AUTO_TEST_SUITE_END() // TestResumeState
+BOOST_AUTO_TEST_SUITE_END() // Chunks
+
+} // namespace tests
+} // namespace chunks
+} // namespace ndn
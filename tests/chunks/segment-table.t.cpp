@@ -0,0 +1,214 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016-2019, Regents of the University of California,
+ *                          Colorado State University,
+ *                          University Pierre & Marie Curie, Sorbonne University.
+ *
+ * This file is part of ndn-tools (Named Data Networking Essential Tools).
+ * See AUTHORS.md for complete list of ndn-tools authors and contributors.
+ *
+ * ndn-tools is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-tools is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-tools, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tools/chunks/ndndropretrieve/segment-table.hpp"
+
+#include "tests/test-common.hpp"
+
+namespace ndn {
+namespace chunks {
+namespace tests {
+
+using namespace ndn::tests;
+
+BOOST_AUTO_TEST_SUITE(Chunks)
+BOOST_AUTO_TEST_SUITE(TestSegmentTable)
+
+static std::vector<uint64_t>
+listSegments(const SegmentTable& table)
+{
+  std::vector<uint64_t> segNos;
+  table.forEach([&] (uint64_t segNo, const SegmentInfo&) { segNos.push_back(segNo); });
+  return segNos;
+}
+
+BOOST_AUTO_TEST_CASE(InsertFindErase)
+{
+  SegmentTable table(4);
+  BOOST_CHECK_EQUAL(table.empty(), true);
+  BOOST_CHECK(table.find(0) == nullptr);
+
+  table.insert(5).state = SegmentState::FirstTimeSent;
+  SegmentInfo& info = table.insert(6);
+  info.state = SegmentState::Retransmitted;
+  info.nRetx = 2;
+  BOOST_CHECK_EQUAL(table.size(), 2);
+
+  BOOST_REQUIRE(table.find(6) != nullptr);
+  BOOST_CHECK_EQUAL(table.find(6)->state, SegmentState::Retransmitted);
+  BOOST_CHECK_EQUAL(table.find(6)->nRetx, 2);
+  BOOST_CHECK(table.find(4) == nullptr);
+  BOOST_CHECK(table.find(7) == nullptr);
+
+  // inserting an existing segment returns its entry unchanged
+  BOOST_CHECK_EQUAL(table.insert(6).nRetx, 2);
+  BOOST_CHECK_EQUAL(table.size(), 2);
+
+  table.erase(5);
+  BOOST_CHECK(table.find(5) == nullptr);
+  BOOST_CHECK_EQUAL(table.size(), 1);
+  table.erase(5);
+  BOOST_CHECK_EQUAL(table.size(), 1);
+  table.erase(6);
+  BOOST_CHECK_EQUAL(table.empty(), true);
+
+  // a reused slot starts with no retransmission
+  BOOST_CHECK_EQUAL(table.insert(6).nRetx, 0);
+}
+
+BOOST_AUTO_TEST_CASE(Wraparound)
+{
+  SegmentTable table(4);
+
+  // keep 4 segments in flight while the ring wraps around many times
+  for (uint64_t segNo = 0; segNo < 100; ++segNo) {
+    table.insert(segNo).nDeliveredAtSend = segNo;
+    if (segNo >= 3) {
+      BOOST_REQUIRE(table.find(segNo - 3) != nullptr);
+      BOOST_CHECK_EQUAL(table.find(segNo - 3)->nDeliveredAtSend, segNo - 3);
+      table.erase(segNo - 3);
+    }
+  }
+  BOOST_CHECK_EQUAL(table.getCapacity(), 4);
+  BOOST_CHECK_EQUAL(table.size(), 3);
+  std::vector<uint64_t> segNos = listSegments(table);
+  std::vector<uint64_t> expected{97, 98, 99};
+  BOOST_CHECK_EQUAL_COLLECTIONS(segNos.begin(), segNos.end(), expected.begin(), expected.end());
+}
+
+BOOST_AUTO_TEST_CASE(OutOfOrderErase)
+{
+  SegmentTable table(4);
+  for (uint64_t segNo = 0; segNo < 4; ++segNo) {
+    table.insert(segNo);
+  }
+
+  // the span only shrinks once the lowest entry is gone, so a hole does not make room
+  table.erase(1);
+  table.insert(4);
+  BOOST_CHECK_EQUAL(table.getCapacity(), 8);
+
+  table.erase(0);
+  table.erase(2);
+  table.erase(3);
+  for (uint64_t segNo = 5; segNo < 12; ++segNo) {
+    table.insert(segNo);
+  }
+  BOOST_CHECK_EQUAL(table.getCapacity(), 8);
+  BOOST_CHECK_EQUAL(table.size(), 8);
+}
+
+BOOST_AUTO_TEST_CASE(Grow)
+{
+  SegmentTable table(4);
+  for (uint64_t segNo = 10; segNo < 13; ++segNo) {
+    table.insert(segNo).nRetx = static_cast<int>(segNo);
+  }
+
+  // beyond the span of the ring, above and below
+  table.insert(20);
+  BOOST_CHECK_EQUAL(table.getCapacity(), 16);
+  table.insert(2);
+  BOOST_CHECK_EQUAL(table.getCapacity(), 32);
+
+  BOOST_CHECK_EQUAL(table.size(), 5);
+  for (uint64_t segNo = 10; segNo < 13; ++segNo) {
+    BOOST_REQUIRE(table.find(segNo) != nullptr);
+    BOOST_CHECK_EQUAL(table.find(segNo)->nRetx, static_cast<int>(segNo));
+  }
+  BOOST_CHECK(table.find(2) != nullptr);
+  BOOST_CHECK(table.find(20) != nullptr);
+  BOOST_CHECK(table.find(13) == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(EraseAfter)
+{
+  SegmentTable table(8);
+  for (uint64_t segNo : {3, 4, 6, 7, 9}) {
+    table.insert(segNo);
+  }
+
+  BOOST_CHECK_EQUAL(table.eraseAfter(9), 0);
+  BOOST_CHECK_EQUAL(table.eraseAfter(5), 3);
+  BOOST_CHECK_EQUAL(table.size(), 2);
+  BOOST_CHECK(table.find(4) != nullptr);
+  BOOST_CHECK(table.find(6) == nullptr);
+
+  // the span ends at the highest remaining entry
+  table.insert(10);
+  BOOST_CHECK_EQUAL(table.getCapacity(), 8);
+
+  BOOST_CHECK_EQUAL(table.eraseAfter(0), 3);
+  BOOST_CHECK_EQUAL(table.empty(), true);
+}
+
+BOOST_AUTO_TEST_CASE(Clear)
+{
+  SegmentTable table(4);
+  for (uint64_t segNo = 0; segNo < 10; ++segNo) {
+    table.insert(segNo);
+  }
+  table.clear();
+  BOOST_CHECK_EQUAL(table.empty(), true);
+  BOOST_CHECK(table.find(5) == nullptr);
+  BOOST_CHECK(listSegments(table).empty());
+
+  table.insert(100);
+  BOOST_CHECK_EQUAL(table.size(), 1);
+}
+
+BOOST_AUTO_TEST_CASE(DetectOvertaken)
+{
+  SegmentTable table(8);
+  for (uint64_t segNo = 0; segNo < 6; ++segNo) {
+    table.insert(segNo).state = SegmentState::FirstTimeSent;
+  }
+  table.find(1)->state = SegmentState::Retransmitted;
+  table.erase(2);
+
+  std::vector<uint64_t> lost;
+  auto onLost = [&] (uint64_t segNo, SegmentInfo&) { lost.push_back(segNo); };
+
+  // Data of segment 4 overtook segments 0 to 1 by at least 3
+  uint64_t cursor = 0;
+  table.detectOvertaken(cursor, 4, 3, onLost);
+  BOOST_CHECK_EQUAL(cursor, 2);
+  BOOST_REQUIRE_EQUAL(lost.size(), 1);
+  BOOST_CHECK_EQUAL(lost[0], 0);
+
+  // segments already checked are not reported again
+  table.detectOvertaken(cursor, 6, 3, onLost);
+  BOOST_CHECK_EQUAL(cursor, 4);
+  BOOST_REQUIRE_EQUAL(lost.size(), 2);
+  BOOST_CHECK_EQUAL(lost[1], 3);
+
+  // a zero threshold disables the detection
+  table.detectOvertaken(cursor, 100, 0, onLost);
+  BOOST_CHECK_EQUAL(cursor, 4);
+  BOOST_CHECK_EQUAL(lost.size(), 2);
+}
+
+BOOST_AUTO_TEST_SUITE_END() // TestSegmentTable
+BOOST_AUTO_TEST_SUITE_END() // Chunks
+
+} // namespace tests
+} // namespace chunks
+} // namespace ndn
@@ -0,0 +1,147 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016-2019, Regents of the University of California,
+ *                          Colorado State University,
+ *                          University Pierre & Marie Curie, Sorbonne University.
+ *
+ * This file is part of ndn-tools (Named Data Networking Essential Tools).
+ * See AUTHORS.md for complete list of ndn-tools authors and contributors.
+ *
+ * ndn-tools is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-tools is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-tools, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tools/chunks/ndndropretrieve/spsc-queue.hpp"
+
+#include "tests/test-common.hpp"
+
+#include <thread>
+
+namespace ndn {
+namespace chunks {
+namespace tests {
+
+using namespace ndn::tests;
+
+BOOST_AUTO_TEST_SUITE(Chunks)
+BOOST_AUTO_TEST_SUITE(TestSpscQueue)
+
+BOOST_AUTO_TEST_CASE(PushPeekPop)
+{
+  SpscQueue<std::string> queue(3);
+  BOOST_CHECK_EQUAL(queue.capacity(), 4);
+  BOOST_CHECK_EQUAL(queue.empty(), true);
+  BOOST_CHECK(queue.peek() == nullptr);
+
+  std::string a("a"), b("b");
+  BOOST_CHECK_EQUAL(queue.push(std::move(a)), true);
+  BOOST_CHECK_EQUAL(queue.push(std::move(b)), true);
+  BOOST_CHECK_EQUAL(queue.empty(), false);
+
+  BOOST_REQUIRE(queue.peek(0) != nullptr);
+  BOOST_CHECK_EQUAL(*queue.peek(0), "a");
+  BOOST_REQUIRE(queue.peek(1) != nullptr);
+  BOOST_CHECK_EQUAL(*queue.peek(1), "b");
+  BOOST_CHECK(queue.peek(2) == nullptr);
+
+  queue.pop();
+  BOOST_REQUIRE(queue.peek() != nullptr);
+  BOOST_CHECK_EQUAL(*queue.peek(), "b");
+  queue.pop();
+  BOOST_CHECK_EQUAL(queue.empty(), true);
+}
+
+BOOST_AUTO_TEST_CASE(Full)
+{
+  SpscQueue<std::string> queue(2);
+  for (int i = 0; i < 2; ++i) {
+    std::string value(std::to_string(i));
+    BOOST_CHECK_EQUAL(queue.push(std::move(value)), true);
+  }
+
+  // a rejected value is left untouched
+  std::string value("2");
+  BOOST_CHECK_EQUAL(queue.push(std::move(value)), false);
+  BOOST_CHECK_EQUAL(value, "2");
+
+  queue.pop(2);
+  BOOST_CHECK_EQUAL(queue.empty(), true);
+  BOOST_CHECK_EQUAL(queue.push(std::move(value)), true);
+  BOOST_CHECK_EQUAL(*queue.peek(), "2");
+}
+
+BOOST_AUTO_TEST_CASE(PopReleasesElement)
+{
+  SpscQueue<shared_ptr<int>> queue(2);
+  auto value = make_shared<int>(1);
+  std::weak_ptr<int> weak = value;
+  BOOST_CHECK_EQUAL(queue.push(std::move(value)), true);
+  BOOST_CHECK_EQUAL(weak.expired(), false);
+
+  queue.pop();
+  BOOST_CHECK_EQUAL(weak.expired(), true);
+}
+
+BOOST_AUTO_TEST_CASE(Wraparound)
+{
+  SpscQueue<int> queue(4);
+  for (int i = 0; i < 100; ++i) {
+    int value = i;
+    BOOST_REQUIRE_EQUAL(queue.push(std::move(value)), true);
+    if (i >= 3) {
+      BOOST_REQUIRE(queue.peek() != nullptr);
+      BOOST_CHECK_EQUAL(*queue.peek(), i - 3);
+      queue.pop();
+    }
+  }
+  BOOST_CHECK_EQUAL(*queue.peek(0), 97);
+  BOOST_CHECK_EQUAL(*queue.peek(2), 99);
+  BOOST_CHECK(queue.peek(3) == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(TwoThreads)
+{
+  const int nValues = 100000;
+  SpscQueue<int> queue(16);
+
+  std::thread producer([&] {
+    for (int i = 0; i < nValues; ++i) {
+      int value = i;
+      while (!queue.push(std::move(value))) {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  // every value arrives exactly once and in order
+  int nMismatches = 0;
+  for (int expected = 0; expected < nValues; ++expected) {
+    int* value = nullptr;
+    while ((value = queue.peek()) == nullptr) {
+      std::this_thread::yield();
+    }
+    if (*value != expected) {
+      ++nMismatches;
+    }
+    queue.pop();
+  }
+  producer.join();
+
+  BOOST_CHECK_EQUAL(nMismatches, 0);
+  BOOST_CHECK_EQUAL(queue.empty(), true);
+}
+
+BOOST_AUTO_TEST_SUITE_END() // TestSpscQueue
+BOOST_AUTO_TEST_SUITE_END() // Chunks
+
+} // namespace tests
+} // namespace chunks
+} // namespace ndn
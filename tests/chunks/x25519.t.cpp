@@ -0,0 +1,185 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016-2019, Regents of the University of California,
+ *                          Colorado State University,
+ *                          University Pierre & Marie Curie, Sorbonne University.
+ *
+ * This file is part of ndn-tools (Named Data Networking Essential Tools).
+ * See AUTHORS.md for complete list of ndn-tools authors and contributors.
+ *
+ * ndn-tools is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-tools is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-tools, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tools/chunks/crypto/x25519.hpp"
+#include "tools/chunks/crypto/aes.hpp"
+#include "tools/chunks/crypto/data-enc-dec.hpp"
+#include "tools/chunks/crypto/error.hpp"
+
+#include "tests/test-common.hpp"
+
+#include <ndn-cxx/encoding/block-helpers.hpp>
+
+namespace ndn {
+namespace chunks {
+namespace tests {
+
+using namespace ndn::tests;
+
+using crypto::X25519;
+
+class X25519Fixture
+{
+protected:
+  X25519Fixture()
+    : privateKey(X25519::generateKey())
+    , publicKey(X25519::deriveEncryptKey(privateKey))
+    , contentKey(crypto::Aes::generateKey(AesKeyParams()))
+  {
+  }
+
+  Buffer
+  unwrap(const Buffer& key, const Buffer& ephemeralKey, const Buffer& wrapped) const
+  {
+    return X25519::decrypt(key.data(), key.size(), ephemeralKey.data(), ephemeralKey.size(),
+                           wrapped.data(), wrapped.size());
+  }
+
+protected:
+  const Buffer privateKey;
+  const Buffer publicKey;
+  const Buffer contentKey;
+};
+
+BOOST_AUTO_TEST_SUITE(Chunks)
+BOOST_FIXTURE_TEST_SUITE(TestX25519, X25519Fixture)
+
+BOOST_AUTO_TEST_CASE(Keys)
+{
+  BOOST_CHECK_EQUAL(privateKey.size(), X25519::KEY_SIZE);
+  BOOST_CHECK_EQUAL(publicKey.size(), X25519::KEY_SIZE);
+
+  Buffer publicKey2 = X25519::deriveEncryptKey(privateKey);
+  BOOST_CHECK_EQUAL_COLLECTIONS(publicKey2.begin(), publicKey2.end(),
+                                publicKey.begin(), publicKey.end());
+
+  Buffer otherKey = X25519::generateKey();
+  BOOST_CHECK(otherKey != privateKey);
+}
+
+BOOST_AUTO_TEST_CASE(RoundTrip)
+{
+  Buffer ephemeralKey, wrapped;
+  std::tie(ephemeralKey, wrapped) = X25519::encrypt(publicKey.data(), publicKey.size(),
+                                                    contentKey.data(), contentKey.size());
+  BOOST_CHECK_EQUAL(ephemeralKey.size(), X25519::KEY_SIZE);
+  // RFC 3394 adds one 8-byte block
+  BOOST_CHECK_EQUAL(wrapped.size(), contentKey.size() + 8);
+
+  Buffer unwrapped = unwrap(privateKey, ephemeralKey, wrapped);
+  BOOST_CHECK_EQUAL_COLLECTIONS(unwrapped.begin(), unwrapped.end(),
+                                contentKey.begin(), contentKey.end());
+}
+
+BOOST_AUTO_TEST_CASE(FreshEphemeralKey)
+{
+  Buffer ephemeralKey1, wrapped1, ephemeralKey2, wrapped2;
+  std::tie(ephemeralKey1, wrapped1) = X25519::encrypt(publicKey.data(), publicKey.size(),
+                                                      contentKey.data(), contentKey.size());
+  std::tie(ephemeralKey2, wrapped2) = X25519::encrypt(publicKey.data(), publicKey.size(),
+                                                      contentKey.data(), contentKey.size());
+  BOOST_CHECK(ephemeralKey1 != ephemeralKey2);
+  BOOST_CHECK(wrapped1 != wrapped2);
+}
+
+BOOST_AUTO_TEST_CASE(SeveralRecipients)
+{
+  // alternating recipients replaces the cached private key each time
+  Buffer privateKey2 = X25519::generateKey();
+  Buffer publicKey2 = X25519::deriveEncryptKey(privateKey2);
+
+  Buffer ephemeralKey1, wrapped1, ephemeralKey2, wrapped2;
+  std::tie(ephemeralKey1, wrapped1) = X25519::encrypt(publicKey.data(), publicKey.size(),
+                                                      contentKey.data(), contentKey.size());
+  std::tie(ephemeralKey2, wrapped2) = X25519::encrypt(publicKey2.data(), publicKey2.size(),
+                                                      contentKey.data(), contentKey.size());
+
+  for (int i = 0; i < 2; ++i) {
+    BOOST_CHECK(unwrap(privateKey, ephemeralKey1, wrapped1) == contentKey);
+    BOOST_CHECK(unwrap(privateKey2, ephemeralKey2, wrapped2) == contentKey);
+  }
+
+  BOOST_CHECK_THROW(unwrap(privateKey2, ephemeralKey1, wrapped1), crypto::Error);
+  BOOST_CHECK_THROW(unwrap(privateKey, ephemeralKey2, wrapped2), crypto::Error);
+}
+
+BOOST_AUTO_TEST_CASE(Tampered)
+{
+  Buffer ephemeralKey1, wrapped1, ephemeralKey2, wrapped2;
+  std::tie(ephemeralKey1, wrapped1) = X25519::encrypt(publicKey.data(), publicKey.size(),
+                                                      contentKey.data(), contentKey.size());
+  std::tie(ephemeralKey2, wrapped2) = X25519::encrypt(publicKey.data(), publicKey.size(),
+                                                      contentKey.data(), contentKey.size());
+
+  // a wrapped key is bound to its ephemeral key
+  BOOST_CHECK_THROW(unwrap(privateKey, ephemeralKey2, wrapped1), crypto::Error);
+
+  Buffer corrupted(wrapped1);
+  corrupted[corrupted.size() / 2] ^= 0x01;
+  BOOST_CHECK_THROW(unwrap(privateKey, ephemeralKey1, corrupted), crypto::Error);
+}
+
+BOOST_AUTO_TEST_CASE(InvalidLengths)
+{
+  Buffer shortPayload(12);
+  BOOST_CHECK_THROW(X25519::encrypt(publicKey.data(), publicKey.size(),
+                                    shortPayload.data(), shortPayload.size()), crypto::Error);
+  Buffer unalignedPayload(20);
+  BOOST_CHECK_THROW(X25519::encrypt(publicKey.data(), publicKey.size(),
+                                    unalignedPayload.data(), unalignedPayload.size()),
+                    crypto::Error);
+  BOOST_CHECK_THROW(X25519::encrypt(publicKey.data(), publicKey.size() - 1,
+                                    contentKey.data(), contentKey.size()), crypto::Error);
+
+  Buffer ephemeralKey, wrapped;
+  std::tie(ephemeralKey, wrapped) = X25519::encrypt(publicKey.data(), publicKey.size(),
+                                                    contentKey.data(), contentKey.size());
+  BOOST_CHECK_THROW(X25519::decrypt(privateKey.data(), privateKey.size() - 1,
+                                    ephemeralKey.data(), ephemeralKey.size(),
+                                    wrapped.data(), wrapped.size()), crypto::Error);
+  BOOST_CHECK_THROW(X25519::decrypt(privateKey.data(), privateKey.size(),
+                                    ephemeralKey.data(), ephemeralKey.size() - 1,
+                                    wrapped.data(), wrapped.size()), crypto::Error);
+}
+
+BOOST_AUTO_TEST_CASE(WrapContentKey)
+{
+  Block block = makeEmptyBlock(tlv::Content);
+  wrapContentKey(block, contentKey, publicKey.data(), publicKey.size(), crypto::KEY_WRAP_X25519);
+  block.encode();
+
+  Block decoded(block.wire(), block.size());
+  decoded.parse();
+  BOOST_CHECK(decoded.find(EPHEMERAL_PUBLIC_KEY) != decoded.elements_end());
+  BOOST_CHECK(decoded.find(X25519_WRAPPED_AES_KEY) != decoded.elements_end());
+  BOOST_CHECK(decoded.find(ENCRYPTED_AES_KEY) == decoded.elements_end());
+
+  Buffer unwrapped = unwrapContentKey(decoded, privateKey.data(), privateKey.size());
+  BOOST_CHECK_EQUAL_COLLECTIONS(unwrapped.begin(), unwrapped.end(),
+                                contentKey.begin(), contentKey.end());
+}
+
+BOOST_AUTO_TEST_SUITE_END() // TestX25519
+BOOST_AUTO_TEST_SUITE_END() // Chunks
+
+} // namespace tests
+} // namespace chunks
+} // namespace ndn
@@ -0,0 +1,483 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2018,  Regents of the University of California
+ *
+ * This file is part of NAC (Name-based Access Control for NDN).
+ * See AUTHORS.md for complete list of NAC authors and contributors.
+ *
+ * NAC is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * NAC is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * NAC, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "core/common.hpp"
+#include "core/version.hpp"
+#include "../aes.hpp"
+#include "../data-enc-dec.hpp"
+#include "../rsa.hpp"
+#include "../x25519.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <sstream>
+
+#include <openssl/crypto.h>
+
+namespace {
+
+std::atomic<uint64_t> g_nAllocs{0};
+std::atomic<uint64_t> g_nAllocBytes{0};
+
+void*
+countedMalloc(size_t size)
+{
+  g_nAllocs.fetch_add(1, std::memory_order_relaxed);
+  g_nAllocBytes.fetch_add(size, std::memory_order_relaxed);
+  return std::malloc(size);
+}
+
+void*
+opensslMalloc(size_t size, const char*, int)
+{
+  return countedMalloc(size);
+}
+
+void*
+opensslRealloc(void* ptr, size_t size, const char*, int)
+{
+  g_nAllocs.fetch_add(1, std::memory_order_relaxed);
+  g_nAllocBytes.fetch_add(size, std::memory_order_relaxed);
+  return std::realloc(ptr, size);
+}
+
+void
+opensslFree(void* ptr, const char*, int)
+{
+  std::free(ptr);
+}
+
+} // namespace
+
+// count every C++ heap allocation made by the benchmarked code
+void*
+operator new(size_t size)
+{
+  void* ptr = countedMalloc(size == 0 ? 1 : size);
+  if (ptr == nullptr)
+    throw std::bad_alloc();
+  return ptr;
+}
+
+void*
+operator new[](size_t size)
+{
+  return ::operator new(size);
+}
+
+void
+operator delete(void* ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void
+operator delete[](void* ptr) noexcept
+{
+  std::free(ptr);
+}
+
+void
+operator delete(void* ptr, size_t) noexcept
+{
+  std::free(ptr);
+}
+
+void
+operator delete[](void* ptr, size_t) noexcept
+{
+  std::free(ptr);
+}
+
+namespace ndn {
+namespace chunks {
+namespace crypto {
+
+namespace po = boost::program_options;
+
+struct BenchmarkOptions
+{
+  size_t minPayloadSize = 64;
+  size_t maxPayloadSize = 1 << 30;
+  size_t sizeFactor = 4;
+  time::milliseconds minDuration{500};
+  uint64_t maxIterations = 1000000;
+  std::vector<uint32_t> aesKeySizes;
+  std::vector<uint32_t> rsaKeySizes;
+  std::vector<std::string> operations;
+};
+
+/**
+ * @brief Result of running one benchmark case
+ */
+struct BenchmarkResult
+{
+  uint64_t nIterations = 0;
+  double seconds = 0.0;
+  uint64_t nAllocs = 0;
+  uint64_t nAllocBytes = 0;
+};
+
+/**
+ * @brief Repeatedly run @p op until both the minimum duration and at least one
+ *        iteration have elapsed, or until the iteration cap is reached
+ */
+template<typename Op>
+static BenchmarkResult
+runCase(const BenchmarkOptions& opts, Op&& op)
+{
+  // warm up caches and lazily initialized OpenSSL state outside of the measured region
+  op();
+
+  BenchmarkResult result;
+  uint64_t allocsBefore = g_nAllocs.load();
+  uint64_t allocBytesBefore = g_nAllocBytes.load();
+  auto start = time::steady_clock::now();
+  time::nanoseconds elapsed;
+  do {
+    op();
+    ++result.nIterations;
+    elapsed = time::steady_clock::now() - start;
+  } while (elapsed < opts.minDuration && result.nIterations < opts.maxIterations);
+
+  result.seconds = elapsed.count() / 1e9;
+  result.nAllocs = g_nAllocs.load() - allocsBefore;
+  result.nAllocBytes = g_nAllocBytes.load() - allocBytesBefore;
+  return result;
+}
+
+static void
+printHeader(std::ostream& os)
+{
+  os << "operation,mode,key_bits,payload_bytes,iterations,seconds,"
+        "ops_per_sec,mb_per_sec,allocs_per_op,alloc_bytes_per_op\n";
+}
+
+static void
+printResult(std::ostream& os, const std::string& operation, const std::string& mode,
+            uint32_t keyBits, size_t payloadSize, const BenchmarkResult& result)
+{
+  double opsPerSec = result.nIterations / result.seconds;
+  os << operation << ',' << mode << ',' << keyBits << ',' << payloadSize << ','
+     << result.nIterations << ',' << result.seconds << ','
+     << opsPerSec << ','
+     << opsPerSec * payloadSize / 1e6 << ','
+     << static_cast<double>(result.nAllocs) / result.nIterations << ','
+     << static_cast<double>(result.nAllocBytes) / result.nIterations << std::endl;
+}
+
+static std::vector<size_t>
+makePayloadSizes(const BenchmarkOptions& opts)
+{
+  std::vector<size_t> sizes;
+  for (size_t size = opts.minPayloadSize; size <= opts.maxPayloadSize; size *= opts.sizeFactor) {
+    sizes.push_back(size);
+    if (size > opts.maxPayloadSize / opts.sizeFactor)
+      break;
+  }
+  return sizes;
+}
+
+static Buffer
+makePayload(size_t size)
+{
+  Buffer payload(size);
+  for (size_t i = 0; i < size; ++i) {
+    payload[i] = static_cast<uint8_t>(i * 31 + 7);
+  }
+  return payload;
+}
+
+static void
+benchmarkAes(const BenchmarkOptions& opts, const std::vector<size_t>& sizes, std::ostream& os)
+{
+  for (uint32_t keyBits : opts.aesKeySizes) {
+    auto key = Aes::generateKey(AesKeyParams(keyBits));
+    auto iv = Aes::generateIV();
+
+    for (size_t size : sizes) {
+      auto payload = makePayload(size);
+      auto encrypted = Aes::encrypt(key.data(), key.size(), payload.data(), payload.size(), iv);
+
+      auto encResult = runCase(opts, [&] {
+        Aes::encrypt(key.data(), key.size(), payload.data(), payload.size(), iv);
+      });
+      printResult(os, "aes-encrypt", "cbc", keyBits, size, encResult);
+
+      auto decResult = runCase(opts, [&] {
+        Aes::decrypt(key.data(), key.size(), encrypted.data(), encrypted.size(), iv);
+      });
+      printResult(os, "aes-decrypt", "cbc", keyBits, size, decResult);
+    }
+  }
+}
+
+static void
+benchmarkRsa(const BenchmarkOptions& opts, std::ostream& os)
+{
+  // RSA only ever wraps content keys, so the payload is a single AES-128 key
+  auto contentKey = Aes::generateKey(AesKeyParams());
+
+  for (uint32_t keyBits : opts.rsaKeySizes) {
+    RsaKeyParams params(keyBits);
+    auto priKey = Rsa::generateKey(params);
+    auto pubKey = Rsa::deriveEncryptKey(priKey);
+    auto wrapped = Rsa::encrypt(pubKey.data(), pubKey.size(), contentKey.data(), contentKey.size());
+
+    auto encResult = runCase(opts, [&] {
+      Rsa::encrypt(pubKey.data(), pubKey.size(), contentKey.data(), contentKey.size());
+    });
+    printResult(os, "rsa-encrypt", "oaep", keyBits, contentKey.size(), encResult);
+
+    auto decResult = runCase(opts, [&] {
+      Rsa::decrypt(priKey.data(), priKey.size(), wrapped.data(), wrapped.size());
+    });
+    printResult(os, "rsa-decrypt", "oaep", keyBits, contentKey.size(), decResult);
+  }
+}
+
+static void
+benchmarkX25519(const BenchmarkOptions& opts, std::ostream& os)
+{
+  auto contentKey = Aes::generateKey(AesKeyParams());
+  auto priKey = X25519::generateKey();
+  auto pubKey = X25519::deriveEncryptKey(priKey);
+  Buffer ephemeralKey, wrapped;
+  std::tie(ephemeralKey, wrapped) = X25519::encrypt(pubKey.data(), pubKey.size(),
+                                                    contentKey.data(), contentKey.size());
+
+  auto encResult = runCase(opts, [&] {
+    X25519::encrypt(pubKey.data(), pubKey.size(), contentKey.data(), contentKey.size());
+  });
+  printResult(os, "x25519-encrypt", "hkdf-aes-kw", 256, contentKey.size(), encResult);
+
+  auto decResult = runCase(opts, [&] {
+    X25519::decrypt(priKey.data(), priKey.size(), ephemeralKey.data(), ephemeralKey.size(),
+                    wrapped.data(), wrapped.size());
+  });
+  printResult(os, "x25519-decrypt", "hkdf-aes-kw", 256, contentKey.size(), decResult);
+}
+
+static void
+benchmarkContent(const BenchmarkOptions& opts, const std::vector<size_t>& sizes, std::ostream& os)
+{
+  for (uint32_t keyBits : opts.rsaKeySizes) {
+    RsaKeyParams params(keyBits);
+    auto priKey = Rsa::generateKey(params);
+    auto pubKey = Rsa::deriveEncryptKey(priKey);
+
+    for (size_t size : sizes) {
+      auto payload = makePayload(size);
+      auto content = encryptDataContentWithCK(payload.data(), payload.size(),
+                                              pubKey.data(), pubKey.size());
+
+      auto encResult = runCase(opts, [&] {
+        encryptDataContentWithCK(payload.data(), payload.size(), pubKey.data(), pubKey.size());
+      });
+      printResult(os, "encrypt-content-with-ck", "rsa", keyBits, size, encResult);
+
+      auto decResult = runCase(opts, [&] {
+        decryptDataContent(content, priKey.data(), priKey.size());
+      });
+      printResult(os, "decrypt-content", "rsa", keyBits, size, decResult);
+    }
+  }
+
+  auto priKey = X25519::generateKey();
+  auto pubKey = X25519::deriveEncryptKey(priKey);
+  for (size_t size : sizes) {
+    auto payload = makePayload(size);
+    auto content = encryptDataContentWithCK(payload.data(), payload.size(),
+                                            pubKey.data(), pubKey.size(), KEY_WRAP_X25519);
+
+    auto encResult = runCase(opts, [&] {
+      encryptDataContentWithCK(payload.data(), payload.size(), pubKey.data(), pubKey.size(),
+                               KEY_WRAP_X25519);
+    });
+    printResult(os, "encrypt-content-with-ck", "x25519", 256, size, encResult);
+
+    auto decResult = runCase(opts, [&] {
+      decryptDataContent(content, priKey.data(), priKey.size());
+    });
+    printResult(os, "decrypt-content", "x25519", 256, size, decResult);
+  }
+
+  // content sharing an epoch key only pays for the AES encryption
+  auto aesKey = Aes::generateKey(AesKeyParams());
+  Name ckName("/benchmark/CK");
+  for (size_t size : sizes) {
+    auto payload = makePayload(size);
+    auto encResult = runCase(opts, [&] {
+      encryptDataContentWithLocator(payload.data(), payload.size(), aesKey, ckName);
+    });
+    printResult(os, "encrypt-content-with-locator", "shared-ck", aesKey.size() * 8, size, encResult);
+  }
+}
+
+template<typename T>
+static std::vector<T>
+parseList(const std::string& str)
+{
+  std::vector<T> values;
+  std::istringstream is(str);
+  std::string item;
+  while (std::getline(is, item, ',')) {
+    if (!item.empty())
+      values.push_back(boost::lexical_cast<T>(item));
+  }
+  return values;
+}
+
+static int
+main(int argc, char* argv[])
+{
+  // must happen before OpenSSL allocates anything, otherwise only C++ allocations are counted
+  bool isCountingOpenssl = CRYPTO_set_mem_functions(&opensslMalloc, &opensslRealloc, &opensslFree) == 1;
+
+  std::string programName(argv[0]);
+  BenchmarkOptions opts;
+  std::string outputPath, operations("aes,rsa,x25519,content"), aesKeySizes("128,192,256"),
+              rsaKeySizes("1024,2048");
+  time::milliseconds::rep minDuration(opts.minDuration.count());
+
+  po::options_description visibleDesc("Options");
+  visibleDesc.add_options()
+    ("help,h",        "print this help message and exit")
+    ("operations,O",  po::value<std::string>(&operations)->default_value(operations),
+                      "comma-separated list of benchmarks to run; valid values are: 'aes', 'rsa', 'x25519', 'content'")
+    ("min-size",      po::value<size_t>(&opts.minPayloadSize)->default_value(opts.minPayloadSize),
+                      "smallest payload size, in bytes")
+    ("max-size",      po::value<size_t>(&opts.maxPayloadSize)->default_value(opts.maxPayloadSize),
+                      "largest payload size, in bytes")
+    ("size-factor",   po::value<size_t>(&opts.sizeFactor)->default_value(opts.sizeFactor),
+                      "multiplier between consecutive payload sizes")
+    ("aes-key-sizes", po::value<std::string>(&aesKeySizes)->default_value(aesKeySizes),
+                      "comma-separated list of AES key sizes, in bits")
+    ("rsa-key-sizes", po::value<std::string>(&rsaKeySizes)->default_value(rsaKeySizes),
+                      "comma-separated list of RSA key sizes, in bits")
+    ("min-time,t",    po::value<time::milliseconds::rep>(&minDuration)->default_value(minDuration),
+                      "minimum measuring time per case, in milliseconds")
+    ("max-iterations", po::value<uint64_t>(&opts.maxIterations)->default_value(opts.maxIterations),
+                       "maximum number of iterations per case")
+    ("output,o",      po::value<std::string>(&outputPath), "write the CSV report to this file instead of stdout")
+    ("version,V",     "print program version and exit")
+    ;
+
+  po::variables_map vm;
+  try {
+    po::store(po::parse_command_line(argc, argv, visibleDesc), vm);
+    po::notify(vm);
+    opts.operations = parseList<std::string>(operations);
+    opts.aesKeySizes = parseList<uint32_t>(aesKeySizes);
+    opts.rsaKeySizes = parseList<uint32_t>(rsaKeySizes);
+  }
+  catch (const po::error& e) {
+    std::cerr << "ERROR: " << e.what() << std::endl;
+    return 2;
+  }
+  catch (const boost::bad_lexical_cast& e) {
+    std::cerr << "ERROR: " << e.what() << std::endl;
+    return 2;
+  }
+
+  if (vm.count("help") > 0) {
+    std::cout << "Usage: " << programName << " [options]\n"
+              << "\n"
+              << "Measure the cost of the content encryption primitives and print a CSV report.\n"
+              << "\n"
+              << visibleDesc;
+    return 0;
+  }
+
+  if (vm.count("version") > 0) {
+    std::cout << "crypto-benchmark " << tools::VERSION << std::endl;
+    return 0;
+  }
+
+  if (opts.minPayloadSize < 1 || opts.minPayloadSize > opts.maxPayloadSize) {
+    std::cerr << "ERROR: payload sizes must satisfy 1 <= min-size <= max-size" << std::endl;
+    return 2;
+  }
+
+  if (opts.sizeFactor < 2) {
+    std::cerr << "ERROR: size factor must be at least 2" << std::endl;
+    return 2;
+  }
+
+  opts.minDuration = time::milliseconds(minDuration);
+  if (opts.minDuration < 0_ms || opts.maxIterations < 1) {
+    std::cerr << "ERROR: min-time cannot be negative and max-iterations must be positive" << std::endl;
+    return 2;
+  }
+
+  if (!isCountingOpenssl) {
+    std::cerr << "WARNING: cannot hook OpenSSL allocator, only C++ allocations will be counted" << std::endl;
+  }
+
+  std::ofstream outputFile;
+  if (!outputPath.empty()) {
+    outputFile.open(outputPath);
+    if (outputFile.fail()) {
+      std::cerr << "ERROR: failed to open " << outputPath << std::endl;
+      return 4;
+    }
+  }
+  std::ostream& os = outputPath.empty() ? std::cout : outputFile;
+
+  auto sizes = makePayloadSizes(opts);
+  try {
+    printHeader(os);
+    for (const auto& operation : opts.operations) {
+      if (operation == "aes") {
+        benchmarkAes(opts, sizes, os);
+      }
+      else if (operation == "rsa") {
+        benchmarkRsa(opts, os);
+      }
+      else if (operation == "x25519") {
+        benchmarkX25519(opts, os);
+      }
+      else if (operation == "content") {
+        benchmarkContent(opts, sizes, os);
+      }
+      else {
+        std::cerr << "ERROR: unknown benchmark '" << operation << "'" << std::endl;
+        return 2;
+      }
+    }
+  }
+  catch (const std::exception& e) {
+    std::cerr << "ERROR: " << e.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
+
+} // namespace crypto
+} // namespace chunks
+} // namespace ndn
+
+int
+main(int argc, char* argv[])
+{
+  return ndn::chunks::crypto::main(argc, argv);
+}
@@ -59,12 +59,15 @@ const ndn::name::Component NAME_COMPONENT_BY("ENC-BY");
 const ndn::name::Component NAME_COMPONENT_E_KEY("KEK");
 const ndn::name::Component NAME_COMPONENT_D_KEY("KDK");
 const ndn::name::Component NAME_COMPONENT_NAC("NAC");
+const ndn::name::Component NAME_COMPONENT_CK("CK");
 
 enum {
   ENCRYPTED_PAYLOAD = 630,
   ENCRYPTED_AES_KEY = 631,
   INITIAL_VECTOR = 632,
-  CK_LOCATOR = 633
+  CK_LOCATOR = 633,
+  EPHEMERAL_PUBLIC_KEY = 634,
+  X25519_WRAPPED_AES_KEY = 635
 };
 
 
@@ -0,0 +1,238 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2018,  Regents of the University of California
+ *
+ * This file is part of NAC (Name-based Access Control for NDN).
+ * See AUTHORS.md for complete list of NAC authors and contributors.
+ *
+ * NAC is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * NAC is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * NAC, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "content-decryptor.hpp"
+#include "data-enc-dec.hpp"
+#include "error.hpp"
+
+#include <ndn-cxx/encoding/block-helpers.hpp>
+#include <ndn-cxx/security/transform/block-cipher.hpp>
+#include <ndn-cxx/security/transform/stream-sink.hpp>
+
+namespace ndn {
+namespace chunks {
+
+ContentDecryptor::ContentDecryptor(Buffer key, std::ostream& os, ContentKeyRequest requestKey)
+  : m_key(std::move(key))
+  , m_os(os)
+  , m_requestKey(std::move(requestKey))
+  , m_keyBlock(makeEmptyBlock(tlv::Content))
+{
+}
+
+void
+ContentDecryptor::write(const uint8_t* buf, size_t size)
+{
+  while (size > 0) {
+    switch (m_state) {
+      case State::OuterHeader: {
+        size_t n = readHeader(buf, size);
+        buf += n;
+        size -= n;
+        if (m_isHeaderComplete) {
+          if (m_type != tlv::Content) {
+            BOOST_THROW_EXCEPTION(tlv::Error("Expecting Content element, got TLV-TYPE " +
+                                             std::to_string(m_type)));
+          }
+          m_outerRemaining = m_length;
+          m_state = m_outerRemaining > 0 ? State::ElementHeader : State::Done;
+        }
+        break;
+      }
+      case State::ElementHeader: {
+        size_t n = readHeader(buf, std::min<uint64_t>(size, m_outerRemaining));
+        buf += n;
+        size -= n;
+        m_outerRemaining -= n;
+        if (m_isHeaderComplete) {
+          if (m_length > m_outerRemaining) {
+            BOOST_THROW_EXCEPTION(tlv::Error("TLV-LENGTH of element exceeds the enclosing Content"));
+          }
+          m_valueRemaining = m_length;
+          m_value.clear();
+          m_state = State::ElementValue;
+          if (m_valueRemaining == 0) {
+            onElementComplete();
+          }
+        }
+        else if (m_outerRemaining == 0) {
+          BOOST_THROW_EXCEPTION(tlv::Error("Incomplete TLV header at the end of Content"));
+        }
+        break;
+      }
+      case State::ElementValue: {
+        size_t n = static_cast<size_t>(std::min<uint64_t>(size, m_valueRemaining));
+        if (m_type == ENCRYPTED_PAYLOAD) {
+          writePayload(buf, n);
+        }
+        else {
+          m_value.insert(m_value.end(), buf, buf + n);
+        }
+        buf += n;
+        size -= n;
+        m_valueRemaining -= n;
+        m_outerRemaining -= n;
+        if (m_valueRemaining == 0) {
+          onElementComplete();
+        }
+        break;
+      }
+      case State::Done:
+        BOOST_THROW_EXCEPTION(tlv::Error("Unexpected data after the end of Content"));
+    }
+  }
+}
+
+void
+ContentDecryptor::end()
+{
+  if (m_state != State::Done) {
+    BOOST_THROW_EXCEPTION(tlv::Error("Encrypted content is truncated"));
+  }
+
+  if (m_cipher == nullptr) {
+    if (m_isKeyRequested) {
+      m_isEndPending = true;
+      return;
+    }
+    // payload preceded the wrapped key, or there is no key at all
+    startCipher();
+  }
+  finish();
+}
+
+void
+ContentDecryptor::setContentKey(Buffer aesKey)
+{
+  if (!m_isKeyRequested || m_cipher != nullptr || !m_aesKey.empty()) {
+    BOOST_THROW_EXCEPTION(crypto::Error("Unexpected content key"));
+  }
+
+  m_aesKey = std::move(aesKey);
+  // otherwise the IV is still on its way and onElementComplete() starts the cipher
+  if (hasContentKey()) {
+    startCipher();
+    if (m_isEndPending) {
+      finish();
+    }
+  }
+}
+
+void
+ContentDecryptor::finish()
+{
+  m_cipher->end();
+  m_os.flush();
+  m_isFinished = true;
+}
+
+size_t
+ContentDecryptor::readHeader(const uint8_t* buf, size_t size)
+{
+  size_t nConsumed = 0;
+  m_isHeaderComplete = false;
+
+  while (nConsumed < size && m_headerSize < sizeof(m_header)) {
+    m_header[m_headerSize++] = buf[nConsumed++];
+
+    const uint8_t* pos = m_header;
+    const uint8_t* end = m_header + m_headerSize;
+    uint64_t type = 0;
+    uint64_t length = 0;
+    if (tlv::readVarNumber(pos, end, type) && tlv::readVarNumber(pos, end, length) && pos == end) {
+      if (type == 0 || type > std::numeric_limits<uint32_t>::max()) {
+        BOOST_THROW_EXCEPTION(tlv::Error("Illegal TLV-TYPE " + std::to_string(type)));
+      }
+      m_type = static_cast<uint32_t>(type);
+      m_length = length;
+      m_headerSize = 0;
+      m_isHeaderComplete = true;
+      break;
+    }
+  }
+  return nConsumed;
+}
+
+void
+ContentDecryptor::onElementComplete()
+{
+  if (m_type == CK_LOCATOR) {
+    Block locator(m_value.data(), m_value.size());
+    m_value.clear();
+    if (m_requestKey == nullptr) {
+      BOOST_THROW_EXCEPTION(crypto::Error("Content key is published separately as " +
+                                          Name(locator).toUri()));
+    }
+    m_isKeyRequested = true;
+    m_requestKey(Name(locator));
+  }
+  else if (m_type != ENCRYPTED_PAYLOAD) {
+    m_keyBlock.push_back(makeBinaryBlock(m_type, m_value.data(), m_value.size()));
+    m_value.clear();
+    if (m_cipher == nullptr && hasContentKey()) {
+      startCipher();
+    }
+  }
+
+  m_state = m_outerRemaining > 0 ? State::ElementHeader : State::Done;
+}
+
+bool
+ContentDecryptor::hasContentKey() const
+{
+  m_keyBlock.parse();
+  bool hasWrappedKey = !m_aesKey.empty() ||
+                       m_keyBlock.find(ENCRYPTED_AES_KEY) != m_keyBlock.elements_end() ||
+                       (m_keyBlock.find(X25519_WRAPPED_AES_KEY) != m_keyBlock.elements_end() &&
+                        m_keyBlock.find(EPHEMERAL_PUBLIC_KEY) != m_keyBlock.elements_end());
+  return hasWrappedKey && m_keyBlock.find(INITIAL_VECTOR) != m_keyBlock.elements_end();
+}
+
+void
+ContentDecryptor::startCipher()
+{
+  m_keyBlock.parse();
+  auto aesKey = m_aesKey.empty() ? unwrapContentKey(m_keyBlock, m_key.data(), m_key.size()) : m_aesKey;
+  const Block& iv = m_keyBlock.get(INITIAL_VECTOR);
+
+  namespace tr = security::transform;
+  m_cipher = make_unique<tr::StepSource>();
+  *m_cipher >> tr::blockCipher(BlockCipherAlgorithm::AES_CBC, CipherOperator::DECRYPT,
+                               aesKey.data(), aesKey.size(), iv.value(), iv.value_size())
+            >> tr::streamSink(m_os);
+
+  if (!m_pendingPayload.empty()) {
+    m_cipher->write(m_pendingPayload.data(), m_pendingPayload.size());
+    m_pendingPayload = Buffer();
+  }
+}
+
+void
+ContentDecryptor::writePayload(const uint8_t* buf, size_t size)
+{
+  if (m_cipher != nullptr) {
+    m_cipher->write(buf, size);
+  }
+  else {
+    m_pendingPayload.insert(m_pendingPayload.end(), buf, buf + size);
+  }
+}
+
+} // namespace chunks
+} // namespace ndn
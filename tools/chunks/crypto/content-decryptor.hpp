@@ -0,0 +1,147 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2018,  Regents of the University of California
+ *
+ * This file is part of NAC (Name-based Access Control for NDN).
+ * See AUTHORS.md for complete list of NAC authors and contributors.
+ *
+ * NAC is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * NAC is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * NAC, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NAC_CONTENT_DECRYPTOR_HPP
+#define NAC_CONTENT_DECRYPTOR_HPP
+
+#include "common.hpp"
+#include <ndn-cxx/security/transform/step-source.hpp>
+
+namespace ndn {
+namespace chunks {
+
+/**
+ * @brief Incremental counterpart of decryptDataContent
+ *
+ * Accepts the encoding of a content block produced by encryptDataContentWithCK in arbitrary
+ * pieces and writes the plaintext to an output stream as soon as it can be decrypted. The
+ * wrapped key and the IV must precede ENCRYPTED_PAYLOAD for decryption to overlap with the
+ * input; otherwise the ciphertext is buffered and decrypted by end().
+ *
+ * Content produced by encryptDataContentWithLocator names its key through CK_LOCATOR. The
+ * decryptor then asks for the unwrapped key through the ContentKeyRequest callback and buffers
+ * the ciphertext until setContentKey() is called, which lets the caller unwrap each shared key
+ * once for all the content that refers to it.
+ */
+class ContentDecryptor : noncopyable
+{
+public:
+  using ContentKeyRequest = std::function<void(const Name& ckName)>;
+
+  /**
+   * @param key recipient private key, matching the key wrapping mode of the content
+   * @param os stream that receives the plaintext
+   * @param requestKey invoked when the content refers to a separately published key
+   */
+  ContentDecryptor(Buffer key, std::ostream& os, ContentKeyRequest requestKey = nullptr);
+
+  /**
+   * @brief Feed the next @p size bytes of the encrypted content block
+   * @throw tlv::Error the input is not a well-formed content block
+   * @throw crypto::Error the content key cannot be unwrapped
+   */
+  void
+  write(const uint8_t* buf, size_t size);
+
+  /**
+   * @brief Signal the end of the input and flush the last plaintext block
+   *
+   * If the content key requested through ContentKeyRequest has not arrived yet, the flush is
+   * deferred until setContentKey().
+   * @throw tlv::Error the content block is truncated
+   */
+  void
+  end();
+
+  /**
+   * @brief Supply the AES key carried by the key packet named by CK_LOCATOR
+   *
+   * May be called from within the ContentKeyRequest callback.
+   */
+  void
+  setContentKey(Buffer aesKey);
+
+  /**
+   * @brief Whether all the plaintext has been written to the output stream
+   */
+  bool
+  isFinished() const
+  {
+    return m_isFinished;
+  }
+
+private:
+  /**
+   * @brief Accumulate a TLV header from @p buf
+   * @return number of bytes consumed; m_isHeaderComplete is set once type and length are known
+   */
+  size_t
+  readHeader(const uint8_t* buf, size_t size);
+
+  void
+  onElementComplete();
+
+  bool
+  hasContentKey() const;
+
+  void
+  startCipher();
+
+  void
+  writePayload(const uint8_t* buf, size_t size);
+
+  void
+  finish();
+
+private:
+  enum class State {
+    OuterHeader,
+    ElementHeader,
+    ElementValue,
+    Done,
+  };
+
+  const Buffer m_key;
+  std::ostream& m_os;
+  const ContentKeyRequest m_requestKey;
+
+  State m_state = State::OuterHeader;
+  uint8_t m_header[2 * 9]; ///< largest encoding of a TLV type and length
+  size_t m_headerSize = 0;
+  bool m_isHeaderComplete = false;
+  uint32_t m_type = 0;
+  uint64_t m_length = 0;
+
+  uint64_t m_outerRemaining = 0; ///< bytes of the outer content block not yet consumed
+  uint64_t m_valueRemaining = 0; ///< bytes of the current element not yet consumed
+  Buffer m_value;                ///< value of the current (small) element
+  Block m_keyBlock;              ///< wrapped key and IV elements seen so far
+  Buffer m_aesKey;               ///< key supplied by setContentKey()
+
+  unique_ptr<security::transform::StepSource> m_cipher;
+  Buffer m_pendingPayload;       ///< ciphertext received before the content key
+  bool m_isKeyRequested = false;
+  bool m_isEndPending = false;   ///< end() was called while waiting for the content key
+  bool m_isFinished = false;
+};
+
+} // namespace chunks
+} // namespace ndn
+
+#endif // NAC_CONTENT_DECRYPTOR_HPP
@@ -0,0 +1,82 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2018,  Regents of the University of California
+ *
+ * This file is part of NAC (Name-based Access Control for NDN).
+ * See AUTHORS.md for complete list of NAC authors and contributors.
+ *
+ * NAC is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * NAC is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * NAC, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "content-key-manager.hpp"
+#include "aes.hpp"
+#include "data-enc-dec.hpp"
+
+#include <ndn-cxx/encoding/block-helpers.hpp>
+
+namespace ndn {
+namespace chunks {
+
+ContentKeyManager::ContentKeyManager(const Name& prefix, Buffer recipientKey, const Options& opts)
+  : m_prefix(Name(prefix).append(NAME_COMPONENT_CK))
+  , m_recipientKey(std::move(recipientKey))
+  , m_options(opts)
+{
+}
+
+shared_ptr<const ContentKey>
+ContentKeyManager::getKey()
+{
+  bool isExpired = m_currentKey == nullptr ||
+                   (m_options.maxFilesPerKey > 0 && m_nFiles >= m_options.maxFilesPerKey);
+  if (isExpired) {
+    startEpoch();
+  }
+
+  ++m_nFiles;
+  return m_currentKey;
+}
+
+shared_ptr<const ContentKey>
+ContentKeyManager::findKey(const Name& name) const
+{
+  auto it = m_keys.find(name);
+  return it == m_keys.end() ? nullptr : it->second;
+}
+
+void
+ContentKeyManager::startEpoch()
+{
+  // versions are timestamps, so that keys from different runs of the producer do not collide,
+  // but must also be unique when several epochs start within the same millisecond
+  auto now = time::toUnixTimestamp(time::system_clock::now()).count();
+  m_lastVersion = std::max<uint64_t>(m_lastVersion + 1, now);
+
+  auto key = make_shared<ContentKey>();
+  key->name = Name(m_prefix).appendVersion(m_lastVersion);
+
+  AesKeyParams param;
+  key->aesKey = crypto::Aes::generateKey(param);
+
+  key->content = makeEmptyBlock(tlv::Content);
+  wrapContentKey(key->content, key->aesKey, m_recipientKey.data(), m_recipientKey.size(),
+                 m_options.keyWrapMode);
+  key->content.encode();
+
+  m_keys[key->name] = key;
+  m_currentKey = std::move(key);
+  m_nFiles = 0;
+}
+
+} // namespace chunks
+} // namespace ndn
@@ -0,0 +1,110 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2018,  Regents of the University of California
+ *
+ * This file is part of NAC (Name-based Access Control for NDN).
+ * See AUTHORS.md for complete list of NAC authors and contributors.
+ *
+ * NAC is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * NAC is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * NAC, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef NAC_CONTENT_KEY_MANAGER_HPP
+#define NAC_CONTENT_KEY_MANAGER_HPP
+
+#include "crypto-common.hpp"
+
+namespace ndn {
+namespace chunks {
+
+/**
+ * @brief A content key shared by all the files encrypted during one key epoch
+ */
+struct ContentKey
+{
+  Name name;     ///< name of the Data packet carrying the wrapped key, referenced by CK_LOCATOR
+  Buffer aesKey; ///< plaintext AES key
+  Block content; ///< Content of the key Data packet, i.e. the wrapped form of aesKey
+};
+
+/**
+ * @brief Issues content keys to a producer, starting a new key after a number of files
+ *
+ * Wrapping a content key costs a public key operation, which dominates the cost of publishing
+ * small files. The manager wraps one key per epoch and hands the same key to every file
+ * published during that epoch; the files reference it by name through CK_LOCATOR. Keys are
+ * published under /<prefix>/CK/<version>.
+ *
+ * The manager is not thread-safe.
+ */
+class ContentKeyManager : noncopyable
+{
+public:
+  struct Options
+  {
+    size_t maxFilesPerKey = 0; ///< files per epoch, zero is unlimited
+    crypto::KEY_WRAP_MODE keyWrapMode = crypto::KEY_WRAP_RSA;
+  };
+
+  /**
+   * @param prefix prefix under which the content keys are named
+   * @param recipientKey public key the content keys are wrapped for
+   */
+  ContentKeyManager(const Name& prefix, Buffer recipientKey, const Options& opts);
+
+  /**
+   * @brief Return the content key for the next file, starting a new epoch if the current one
+   *        has expired
+   */
+  shared_ptr<const ContentKey>
+  getKey();
+
+  /**
+   * @brief Return the content key named @p name, or nullptr if it was never issued
+   */
+  shared_ptr<const ContentKey>
+  findKey(const Name& name) const;
+
+  /**
+   * @brief Return the prefix shared by the names of all content keys
+   */
+  const Name&
+  getPrefix() const
+  {
+    return m_prefix;
+  }
+
+  size_t
+  getNEpochs() const
+  {
+    return m_keys.size();
+  }
+
+private:
+  void
+  startEpoch();
+
+private:
+  const Name m_prefix;
+  const Buffer m_recipientKey;
+  const Options m_options;
+
+  std::map<Name, shared_ptr<const ContentKey>> m_keys;
+  shared_ptr<const ContentKey> m_currentKey;
+  uint64_t m_lastVersion = 0;
+  size_t m_nFiles = 0; ///< files encrypted with m_currentKey
+};
+
+} // namespace chunks
+} // namespace ndn
+
+#endif // NAC_CONTENT_KEY_MANAGER_HPP
@@ -32,6 +32,14 @@ enum AES_BLOCK_CIPHER_MODE {
   AES_CBC
 };
 
+/**
+ * @brief Algorithm used to wrap the AES content key for the recipient
+ */
+enum KEY_WRAP_MODE {
+  KEY_WRAP_RSA,   ///< RSA-OAEP, key is a PKCS#1 private / PKCS#8 public key
+  KEY_WRAP_X25519 ///< X25519 ECDH + HKDF + AES key wrap, key is a raw 32-byte key
+};
+
 } // namespace crypto
 } // namespace nac
 } // namespace ndn
@@ -22,13 +22,60 @@
 #include "data-enc-dec.hpp"
 #include "aes.hpp"
 #include "rsa.hpp"
+#include "x25519.hpp"
+#include "error.hpp"
+
+#include <boost/throw_exception.hpp>
 
 namespace ndn {
 namespace chunks {
 
+void
+wrapContentKey(Block& block, const Buffer& aesKey,
+               const uint8_t* key, size_t keyLen, crypto::KEY_WRAP_MODE wrapMode)
+{
+  if (wrapMode == crypto::KEY_WRAP_X25519) {
+    Buffer ephemeralKey, wrappedAesKey;
+    std::tie(ephemeralKey, wrappedAesKey) = crypto::X25519::encrypt(key, keyLen,
+                                                                    aesKey.data(), aesKey.size());
+    block.push_back(makeBinaryBlock(EPHEMERAL_PUBLIC_KEY,
+                                    ephemeralKey.data(), ephemeralKey.size()));
+    block.push_back(makeBinaryBlock(X25519_WRAPPED_AES_KEY,
+                                    wrappedAesKey.data(), wrappedAesKey.size()));
+  }
+  else {
+    auto encryptedAesKey = crypto::Rsa::encrypt(key, keyLen, aesKey.data(), aesKey.size());
+    block.push_back(makeBinaryBlock(ENCRYPTED_AES_KEY,
+                                    encryptedAesKey.data(), encryptedAesKey.size()));
+  }
+}
+
+Buffer
+unwrapContentKey(const Block& block, const uint8_t* key, size_t keyLen)
+{
+  if (block.find(X25519_WRAPPED_AES_KEY) != block.elements_end()) {
+    const Block& ephemeralKey = block.get(EPHEMERAL_PUBLIC_KEY);
+    const Block& wrappedAesKey = block.get(X25519_WRAPPED_AES_KEY);
+    return crypto::X25519::decrypt(key, keyLen,
+                                   ephemeralKey.value(), ephemeralKey.value_size(),
+                                   wrappedAesKey.value(), wrappedAesKey.value_size());
+  }
+
+  auto locator = block.find(CK_LOCATOR);
+  if (locator != block.elements_end() && block.find(ENCRYPTED_AES_KEY) == block.elements_end()) {
+    locator->parse();
+    BOOST_THROW_EXCEPTION(crypto::Error("Content key is published separately as " +
+                                        Name(locator->get(tlv::Name)).toUri()));
+  }
+
+  const Block& encryptedAesKey = block.get(ENCRYPTED_AES_KEY);
+  return crypto::Rsa::decrypt(key, keyLen, encryptedAesKey.value(), encryptedAesKey.value_size());
+}
+
 Block
 encryptDataContentWithCK(const uint8_t* payload, size_t payloadLen,
-                         const uint8_t* key, size_t keyLen)
+                         const uint8_t* key, size_t keyLen,
+                         crypto::KEY_WRAP_MODE wrapMode)
 {
   // first create AES key and encrypt the payload
   AesKeyParams param;
@@ -37,26 +84,47 @@ encryptDataContentWithCK(const uint8_t* payload, size_t payloadLen,
   auto encryptedPayload = crypto::Aes::encrypt(aesKey.data(), aesKey.size(),
                                                payload, payloadLen, iv);
 
-  // second use RSA key to encrypt the AES key
-  auto encryptedAesKey = crypto::Rsa::encrypt(key, keyLen, aesKey.data(), aesKey.size());
-
-  // create the content block
+  // create the content block; the wrapped key and the IV go first so that
+  // ContentDecryptor can start decrypting before the whole payload has arrived
   auto content = makeEmptyBlock(tlv::Content);
+
+  // second use the recipient key to wrap the AES key
+  wrapContentKey(content, aesKey, key, keyLen, wrapMode);
+
+  content.push_back(makeBinaryBlock(INITIAL_VECTOR,
+                                    iv.data(), iv.size()));
   content.push_back(makeBinaryBlock(ENCRYPTED_PAYLOAD,
                                     encryptedPayload.data(), encryptedPayload.size()));
+  content.encode();
+  return content;
+}
 
-  content.push_back(makeBinaryBlock(ENCRYPTED_AES_KEY,
-                                    encryptedAesKey.data(), encryptedAesKey.size()));
+Block
+encryptDataContentWithLocator(const uint8_t* payload, size_t payloadLen,
+                              const Buffer& aesKey, const Name& ckName)
+{
+  // a fresh IV per content, as the key is shared with other content
+  auto iv = crypto::Aes::generateIV();
+  auto encryptedPayload = crypto::Aes::encrypt(aesKey.data(), aesKey.size(),
+                                               payload, payloadLen, iv);
 
+  auto content = makeEmptyBlock(tlv::Content);
+  auto locator = makeEmptyBlock(CK_LOCATOR);
+  locator.push_back(ckName.wireEncode());
+  locator.encode();
+  content.push_back(locator);
   content.push_back(makeBinaryBlock(INITIAL_VECTOR,
                                     iv.data(), iv.size()));
+  content.push_back(makeBinaryBlock(ENCRYPTED_PAYLOAD,
+                                    encryptedPayload.data(), encryptedPayload.size()));
   content.encode();
   return content;
 }
 
 std::tuple<Block, Block>
 encryptDataContent(const uint8_t* payload, size_t payloadLen,
-                   const uint8_t* key, size_t keyLen)
+                   const uint8_t* key, size_t keyLen,
+                   crypto::KEY_WRAP_MODE wrapMode)
 {
   // first create AES key and encrypt the payload
   AesKeyParams param;
@@ -65,18 +133,14 @@ encryptDataContent(const uint8_t* payload, size_t payloadLen,
   auto encryptedPayload = crypto::Aes::encrypt(aesKey.data(), aesKey.size(),
                                                payload, payloadLen, iv);
 
-  // second use RSA key to encrypt the AES key
-  auto encryptedAesKey = crypto::Rsa::encrypt(key, keyLen, aesKey.data(), aesKey.size());
-
   // create encrypted content block
   auto encryptedBlock = makeBinaryBlock(ENCRYPTED_PAYLOAD,
                                         encryptedPayload.data(), encryptedPayload.size());
   encryptedBlock.encode();
 
-  // create ck block
+  // create ck block, wrapping the AES key with the recipient key
   auto CKBlock = makeEmptyBlock(tlv::Content);
-  CKBlock.push_back(makeBinaryBlock(ENCRYPTED_AES_KEY,
-                                    encryptedAesKey.data(), encryptedAesKey.size()));
+  wrapContentKey(CKBlock, aesKey, key, keyLen, wrapMode);
   CKBlock.push_back(makeBinaryBlock(INITIAL_VECTOR,
                                     iv.data(), iv.size()));
   CKBlock.encode();
@@ -91,11 +155,9 @@ decryptDataContent(const Block& dataBlock,
   dataBlock.parse();
   Buffer iv(dataBlock.get(INITIAL_VECTOR).value(),
             dataBlock.get(INITIAL_VECTOR).value_size());
-  Buffer encryptedAesKey(dataBlock.get(ENCRYPTED_AES_KEY).value(),
-                         dataBlock.get(ENCRYPTED_AES_KEY).value_size());
   Buffer encryptedPayload(dataBlock.get(ENCRYPTED_PAYLOAD).value(),
                           dataBlock.get(ENCRYPTED_PAYLOAD).value_size());
-  auto aesKey = crypto::Rsa::decrypt(key, keyLen, encryptedAesKey.data(), encryptedAesKey.size());
+  auto aesKey = unwrapContentKey(dataBlock, key, keyLen);
   auto payload = crypto::Aes::decrypt(aesKey.data(), aesKey.size(),
                                       encryptedPayload.data(), encryptedPayload.size(), iv);
   return payload;
@@ -107,14 +169,13 @@ decryptDataContent(const Block& dataBlock, const Block& ckBlock,
 {
   dataBlock.parse();
   ckBlock.parse();
-  Buffer iv(ckBlock.get(INITIAL_VECTOR).value(),
-            ckBlock.get(INITIAL_VECTOR).value_size());
-  Buffer encryptedAesKey(ckBlock.get(ENCRYPTED_AES_KEY).value(),
-                         ckBlock.get(ENCRYPTED_AES_KEY).value_size());
+  const Block& ivBlock = dataBlock.find(INITIAL_VECTOR) != dataBlock.elements_end() ?
+                         dataBlock.get(INITIAL_VECTOR) : ckBlock.get(INITIAL_VECTOR);
+  Buffer iv(ivBlock.value(), ivBlock.value_size());
   Buffer encryptedPayload(dataBlock.get(ENCRYPTED_PAYLOAD).value(),
                           dataBlock.get(ENCRYPTED_PAYLOAD).value_size());
 
-  auto aesKey = crypto::Rsa::decrypt(key, keyLen, encryptedAesKey.data(), encryptedAesKey.size());
+  auto aesKey = unwrapContentKey(ckBlock, key, keyLen);
   auto payload = crypto::Aes::decrypt(aesKey.data(), aesKey.size(),
                                       encryptedPayload.data(), encryptedPayload.size(), iv);
   return payload;
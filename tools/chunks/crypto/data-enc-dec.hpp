@@ -22,29 +22,68 @@
 #ifndef NAC_DATA_ENC_DEC_HPP
 #define NAC_DATA_ENC_DEC_HPP
 
-#include "common.hpp"
+#include "crypto-common.hpp"
 #include <tuple>
 
 namespace ndn {
 namespace chunks {
 
+/**
+ * @param key recipient public key, whose format depends on @p wrapMode
+ */
 Block
 encryptDataContentWithCK(const uint8_t* payload, size_t payloadLen,
-                         const uint8_t* key, size_t keyLen);
+                         const uint8_t* key, size_t keyLen,
+                         crypto::KEY_WRAP_MODE wrapMode = crypto::KEY_WRAP_RSA);
+
+/**
+ * @brief Encrypt @p payload with a content key that is published separately
+ *
+ * The content carries a CK_LOCATOR with @p ckName instead of the wrapped key, so that the
+ * public key operation is shared by all the content encrypted with the same key.
+ */
+Block
+encryptDataContentWithLocator(const uint8_t* payload, size_t payloadLen,
+                              const Buffer& aesKey, const Name& ckName);
 
 std::tuple<Block, Block>
 encryptDataContent(const uint8_t* payload, size_t payloadLen,
-                   const uint8_t* key, size_t keyLen);
-
+                   const uint8_t* key, size_t keyLen,
+                   crypto::KEY_WRAP_MODE wrapMode = crypto::KEY_WRAP_RSA);
 
+/**
+ * @brief Decrypt content produced by encryptDataContentWithCK
+ *
+ * The key wrap mode is detected from the TLV elements of @p dataBlock.
+ * @param key recipient private key matching that mode
+ */
 Buffer
 decryptDataContent(const Block& dataBlock,
                    const uint8_t* key, size_t keyLen);
 
+/**
+ * @brief Decrypt content whose wrapped key is carried by @p ckBlock
+ *
+ * The IV is taken from @p dataBlock if present, otherwise from @p ckBlock.
+ */
 Buffer
 decryptDataContent(const Block& dataBlock, const Block& ckBlock,
                    const uint8_t* key, size_t keyLen);
 
+/**
+ * @brief Append the wrapped form of @p aesKey to @p block
+ */
+void
+wrapContentKey(Block& block, const Buffer& aesKey,
+               const uint8_t* key, size_t keyLen, crypto::KEY_WRAP_MODE wrapMode);
+
+/**
+ * @brief Recover the AES content key from a parsed block created by wrapContentKey
+ * @throw crypto::Error @p block only refers to the key through CK_LOCATOR
+ */
+Buffer
+unwrapContentKey(const Block& block, const uint8_t* key, size_t keyLen);
+
 
 } // namespace nac
 } // namespace ndn
@@ -2,7 +2,11 @@
 #include <iostream>
 #include <boost/filesystem.hpp>
 #include <boost/thread.hpp>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
 #include <fstream>
+#include <iterator>
 #include <sstream>
 #include <ndn-cxx/security/transform/private-key.hpp>
 #include <ndn-cxx/security/transform/public-key.hpp>
@@ -10,8 +14,11 @@
 #include <ndn-cxx/security/transform/buffer-source.hpp>
 #include <ndn-cxx/security/transform/base64-decode.hpp>
 #include <ndn-cxx/security/transform/stream-sink.hpp>
+#include <openssl/crypto.h>
+#include <unistd.h>
 #include "../crypto/data-enc-dec.hpp"
 #include "../crypto/rsa.hpp"
+#include "../crypto/x25519.hpp"
 
 namespace ndn {
 namespace chunks {
@@ -19,9 +26,38 @@ namespace chunks {
 static int
 main(int argc, char* argv[])
 {
+  if (argc < 2) {
+    std::cerr << "Usage: " << argv[0] << " <file to decrypt> [private key file] [content key packet file]\n"
+              << "       " << argv[0] << " --generate-x25519-key <private key file>" << std::endl;
+    return 2;
+  }
+
+  if (std::string(argv[1]) == "--generate-x25519-key") {
+    if (argc < 3) {
+      std::cerr << "ERROR: missing private key file name" << std::endl;
+      return 2;
+    }
+    // readable by the owner only, and never replacing an existing key
+    int fd = ::open(argv[2], O_WRONLY | O_CREAT | O_EXCL, 0600);
+    if (fd < 0) {
+      std::cerr << "ERROR: cannot create " << argv[2] << ": " << std::strerror(errno) << std::endl;
+      return 1;
+    }
+    auto priKey = crypto::X25519::generateKey();
+    bool isWritten = ::write(fd, priKey.data(), priKey.size()) == static_cast<ssize_t>(priKey.size());
+    OPENSSL_cleanse(priKey.data(), priKey.size());
+    isWritten = ::close(fd) == 0 && isWritten;
+    if (!isWritten) {
+      std::cerr << "ERROR: cannot write " << argv[2] << std::endl;
+      ::unlink(argv[2]);
+      return 1;
+    }
+    return 0;
+  }
+
      std::vector<u_int8_t> beg2;
-  //find a way to make this more dynamic
-  std::ifstream k ("../ndn-drop/key.ndn");
+  // the wrapping algorithm is detected from the content, the key must match it
+  std::ifstream k (argc > 2 ? argv[2] : "../ndn-drop/key.ndn");
     k >> std::noskipws;
     uint8_t c;
     while (k >> c){
@@ -40,7 +76,24 @@ main(int argc, char* argv[])
 
     Block data(payload.data(), payload.size());
 
-    auto decryptedData = decryptDataContent(data, beg2.data(), beg2.size());
+    Buffer decryptedData;
+    try {
+      if (argc > 3) {
+        // the file refers to a shared content key, whose packet was saved separately,
+        // e.g. with ndnpeek <name of the key> > <content key packet file>
+        std::ifstream ckFile(argv[3], std::ifstream::binary);
+        Buffer ckWire(std::istreambuf_iterator<char>(ckFile), std::istreambuf_iterator<char>{});
+        Data ckData(Block(ckWire.data(), ckWire.size()));
+        decryptedData = decryptDataContent(data, ckData.getContent(), beg2.data(), beg2.size());
+      }
+      else {
+        decryptedData = decryptDataContent(data, beg2.data(), beg2.size());
+      }
+    }
+    catch (const std::exception& e) {
+      std::cerr << "ERROR: " << e.what() << std::endl;
+      return 1;
+    }
     std::ofstream outFile;
     outFile.open(argv[1]);
     const char* beg = (char *) (decryptedData.data());
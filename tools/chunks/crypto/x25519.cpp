@@ -0,0 +1,306 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2018,  Regents of the University of California
+ *
+ * This file is part of NAC (Name-based Access Control for NDN).
+ * See AUTHORS.md for complete list of NAC authors and contributors.
+ *
+ * NAC is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * NAC is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * NAC, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "x25519.hpp"
+#include "error.hpp"
+
+#include <algorithm>
+#include <boost/throw_exception.hpp>
+#include <memory>
+#include <openssl/crypto.h>
+#include <openssl/evp.h>
+#include <openssl/kdf.h>
+
+namespace ndn {
+namespace chunks {
+namespace crypto {
+
+const size_t X25519::KEY_SIZE = 32;
+
+static const uint8_t HKDF_INFO[] = "NDN-DROP X25519 content key wrap";
+static const size_t KEK_SIZE = 32;
+static const size_t KEY_WRAP_OVERHEAD = 8;
+
+namespace {
+
+struct EvpPkeyDeleter
+{
+  void
+  operator()(EVP_PKEY* key) const
+  {
+    EVP_PKEY_free(key);
+  }
+};
+
+struct EvpPkeyCtxDeleter
+{
+  void
+  operator()(EVP_PKEY_CTX* ctx) const
+  {
+    EVP_PKEY_CTX_free(ctx);
+  }
+};
+
+struct EvpCipherCtxDeleter
+{
+  void
+  operator()(EVP_CIPHER_CTX* ctx) const
+  {
+    EVP_CIPHER_CTX_free(ctx);
+  }
+};
+
+using EvpPkeyPtr = std::unique_ptr<EVP_PKEY, EvpPkeyDeleter>;
+using EvpPkeyCtxPtr = std::unique_ptr<EVP_PKEY_CTX, EvpPkeyCtxDeleter>;
+using EvpCipherCtxPtr = std::unique_ptr<EVP_CIPHER_CTX, EvpCipherCtxDeleter>;
+
+/**
+ * @brief Zeroes a buffer of key material when leaving the scope, including by an exception
+ */
+class CleanseOnExit
+{
+public:
+  explicit
+  CleanseOnExit(Buffer& buf)
+    : m_buf(buf)
+  {
+  }
+
+  CleanseOnExit(const CleanseOnExit&) = delete;
+
+  CleanseOnExit&
+  operator=(const CleanseOnExit&) = delete;
+
+  ~CleanseOnExit()
+  {
+    OPENSSL_cleanse(m_buf.data(), m_buf.size());
+  }
+
+private:
+  Buffer& m_buf;
+};
+
+} // namespace
+
+static void
+checkKeyLength(size_t keyLen)
+{
+  if (keyLen != X25519::KEY_SIZE) {
+    BOOST_THROW_EXCEPTION(Error("X25519 keys must be " + std::to_string(X25519::KEY_SIZE) + " bytes long"));
+  }
+}
+
+static EvpPkeyPtr
+loadPrivateKey(const uint8_t* key, size_t keyLen)
+{
+  checkKeyLength(keyLen);
+  EvpPkeyPtr pkey(EVP_PKEY_new_raw_private_key(EVP_PKEY_X25519, nullptr, key, keyLen));
+  if (pkey == nullptr) {
+    BOOST_THROW_EXCEPTION(Error("Cannot load X25519 private key"));
+  }
+  return pkey;
+}
+
+static EvpPkeyPtr
+loadPublicKey(const uint8_t* key, size_t keyLen)
+{
+  checkKeyLength(keyLen);
+  EvpPkeyPtr pkey(EVP_PKEY_new_raw_public_key(EVP_PKEY_X25519, nullptr, key, keyLen));
+  if (pkey == nullptr) {
+    BOOST_THROW_EXCEPTION(Error("Cannot load X25519 public key"));
+  }
+  return pkey;
+}
+
+static EvpPkeyPtr
+generatePrivateKey()
+{
+  EvpPkeyCtxPtr ctx(EVP_PKEY_CTX_new_id(EVP_PKEY_X25519, nullptr));
+  EVP_PKEY* rawKey = nullptr;
+  if (ctx == nullptr ||
+      EVP_PKEY_keygen_init(ctx.get()) != 1 ||
+      EVP_PKEY_keygen(ctx.get(), &rawKey) != 1) {
+    BOOST_THROW_EXCEPTION(Error("Cannot generate X25519 key"));
+  }
+  return EvpPkeyPtr(rawKey);
+}
+
+static Buffer
+getRawPublicKey(EVP_PKEY* pkey)
+{
+  Buffer pubKey(X25519::KEY_SIZE);
+  size_t pubKeyLen = pubKey.size();
+  if (EVP_PKEY_get_raw_public_key(pkey, pubKey.data(), &pubKeyLen) != 1 ||
+      pubKeyLen != X25519::KEY_SIZE) {
+    BOOST_THROW_EXCEPTION(Error("Cannot derive X25519 public key"));
+  }
+  return pubKey;
+}
+
+/**
+ * @brief Derive the key-encryption key from an ECDH exchange
+ *
+ * The HKDF salt binds the KEK to both public keys, so a wrapped key cannot be replayed
+ * under a different ephemeral key or for a different recipient.
+ */
+static Buffer
+deriveKek(EVP_PKEY* priKey, EVP_PKEY* peerKey,
+          const Buffer& ephemeralPubKey, const Buffer& recipientPubKey)
+{
+  EvpPkeyCtxPtr dhCtx(EVP_PKEY_CTX_new(priKey, nullptr));
+  Buffer secret(X25519::KEY_SIZE);
+  CleanseOnExit cleanseSecret(secret);
+  size_t secretLen = secret.size();
+  if (dhCtx == nullptr ||
+      EVP_PKEY_derive_init(dhCtx.get()) != 1 ||
+      EVP_PKEY_derive_set_peer(dhCtx.get(), peerKey) != 1 ||
+      EVP_PKEY_derive(dhCtx.get(), secret.data(), &secretLen) != 1) {
+    BOOST_THROW_EXCEPTION(Error("X25519 key agreement failed"));
+  }
+
+  Buffer salt(ephemeralPubKey);
+  salt.insert(salt.end(), recipientPubKey.begin(), recipientPubKey.end());
+
+  EvpPkeyCtxPtr kdfCtx(EVP_PKEY_CTX_new_id(EVP_PKEY_HKDF, nullptr));
+  Buffer kek(KEK_SIZE);
+  size_t kekLen = kek.size();
+  if (kdfCtx == nullptr ||
+      EVP_PKEY_derive_init(kdfCtx.get()) != 1 ||
+      EVP_PKEY_CTX_set_hkdf_md(kdfCtx.get(), EVP_sha256()) != 1 ||
+      EVP_PKEY_CTX_set1_hkdf_salt(kdfCtx.get(), salt.data(), static_cast<int>(salt.size())) != 1 ||
+      EVP_PKEY_CTX_set1_hkdf_key(kdfCtx.get(), secret.data(), static_cast<int>(secretLen)) != 1 ||
+      EVP_PKEY_CTX_add1_hkdf_info(kdfCtx.get(), HKDF_INFO, sizeof(HKDF_INFO) - 1) != 1 ||
+      EVP_PKEY_derive(kdfCtx.get(), kek.data(), &kekLen) != 1) {
+    OPENSSL_cleanse(kek.data(), kek.size());
+    BOOST_THROW_EXCEPTION(Error("HKDF key derivation failed"));
+  }
+  return kek;
+}
+
+static Buffer
+aesKeyWrap(const Buffer& kek, const uint8_t* payload, size_t payloadLen, bool isWrap)
+{
+  EvpCipherCtxPtr ctx(EVP_CIPHER_CTX_new());
+  if (ctx == nullptr) {
+    BOOST_THROW_EXCEPTION(Error("Cannot allocate cipher context"));
+  }
+  EVP_CIPHER_CTX_set_flags(ctx.get(), EVP_CIPHER_CTX_FLAG_WRAP_ALLOW);
+
+  Buffer output(payloadLen + KEY_WRAP_OVERHEAD);
+  int outLen = 0;
+  int finalLen = 0;
+  if (EVP_CipherInit_ex(ctx.get(), EVP_aes_256_wrap(), nullptr, kek.data(), nullptr, isWrap ? 1 : 0) != 1 ||
+      EVP_CipherUpdate(ctx.get(), output.data(), &outLen, payload, static_cast<int>(payloadLen)) != 1 ||
+      EVP_CipherFinal_ex(ctx.get(), output.data() + outLen, &finalLen) != 1) {
+    BOOST_THROW_EXCEPTION(Error(isWrap ? "AES key wrap failed" : "AES key unwrap failed"));
+  }
+  output.resize(outLen + finalLen);
+  return output;
+}
+
+/**
+ * @brief Loaded recipient key, kept across calls because importing a raw X25519 private key
+ *        costs as much as the key agreement itself
+ *
+ * The key is identified by the digest of its raw bits, so that no copy of them outlives the
+ * call that loaded it.
+ */
+struct CachedPrivateKey
+{
+  uint8_t keyDigest[EVP_MAX_MD_SIZE];
+  EvpPkeyPtr key;
+  Buffer pubKey;
+};
+
+static const CachedPrivateKey&
+getCachedPrivateKey(const uint8_t* key, size_t keyLen)
+{
+  uint8_t keyDigest[EVP_MAX_MD_SIZE];
+  unsigned int digestLen = 0;
+  if (EVP_Digest(key, keyLen, keyDigest, &digestLen, EVP_sha256(), nullptr) != 1) {
+    BOOST_THROW_EXCEPTION(Error("Cannot hash X25519 private key"));
+  }
+
+  static thread_local CachedPrivateKey cache;
+  if (cache.key == nullptr || CRYPTO_memcmp(cache.keyDigest, keyDigest, digestLen) != 0) {
+    cache.key = loadPrivateKey(key, keyLen);
+    cache.pubKey = getRawPublicKey(cache.key.get());
+    std::copy_n(keyDigest, digestLen, cache.keyDigest);
+  }
+  return cache;
+}
+
+Buffer
+X25519::generateKey()
+{
+  auto pkey = generatePrivateKey();
+
+  Buffer priKey(KEY_SIZE);
+  size_t priKeyLen = priKey.size();
+  if (EVP_PKEY_get_raw_private_key(pkey.get(), priKey.data(), &priKeyLen) != 1) {
+    BOOST_THROW_EXCEPTION(Error("Cannot export X25519 private key"));
+  }
+  return priKey;
+}
+
+Buffer
+X25519::deriveEncryptKey(const Buffer& keyBits)
+{
+  auto priKey = loadPrivateKey(keyBits.data(), keyBits.size());
+  return getRawPublicKey(priKey.get());
+}
+
+Buffer
+X25519::decrypt(const uint8_t* key, size_t keyLen,
+                const uint8_t* ephemeralKey, size_t ephemeralKeyLen,
+                const uint8_t* payload, size_t payloadLen)
+{
+  const auto& priKey = getCachedPrivateKey(key, keyLen);
+  auto peerKey = loadPublicKey(ephemeralKey, ephemeralKeyLen);
+
+  auto kek = deriveKek(priKey.key.get(), peerKey.get(),
+                       Buffer(ephemeralKey, ephemeralKeyLen), priKey.pubKey);
+  CleanseOnExit cleanseKek(kek);
+  return aesKeyWrap(kek, payload, payloadLen, false);
+}
+
+std::tuple<Buffer, Buffer>
+X25519::encrypt(const uint8_t* key, size_t keyLen,
+                const uint8_t* payload, size_t payloadLen)
+{
+  if (payloadLen < 16 || payloadLen % 8 != 0) {
+    BOOST_THROW_EXCEPTION(Error("Wrapped key must be a multiple of 8 bytes and at least 16 bytes long"));
+  }
+
+  auto peerKey = loadPublicKey(key, keyLen);
+  // the ephemeral key never leaves OpenSSL, exporting and re-importing it would cost as much
+  // as the key agreement
+  auto ephemeralPriKey = generatePrivateKey();
+  auto ephemeralPubKey = getRawPublicKey(ephemeralPriKey.get());
+
+  auto kek = deriveKek(ephemeralPriKey.get(), peerKey.get(),
+                       ephemeralPubKey, Buffer(key, keyLen));
+  CleanseOnExit cleanseKek(kek);
+  auto wrapped = aesKeyWrap(kek, payload, payloadLen, true);
+  return std::make_tuple(std::move(ephemeralPubKey), std::move(wrapped));
+}
+
+} // namespace crypto
+} // namespace chunks
+} // namespace ndn
@@ -0,0 +1,75 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/**
+ * Copyright (c) 2018,  Regents of the University of California
+ *
+ * This file is part of NAC (Name-based Access Control for NDN).
+ * See AUTHORS.md for complete list of NAC authors and contributors.
+ *
+ * NAC is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * NAC is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * NAC, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NAC_CRYPTO_X25519_HPP
+#define NAC_CRYPTO_X25519_HPP
+
+#include <ndn-cxx/encoding/buffer.hpp>
+#include <tuple>
+
+namespace ndn {
+namespace chunks {
+namespace crypto {
+
+/**
+ * @brief Content key wrapping with X25519 ECDH and HKDF
+ *
+ * A fresh ephemeral X25519 key pair is generated for every wrap. The shared secret between
+ * the ephemeral private key and the recipient public key is expanded with HKDF-SHA256 into
+ * a key-encryption key, which wraps the content key using AES-256 key wrap (RFC 3394).
+ * Keys are raw 32-byte X25519 keys.
+ */
+class X25519
+{
+public:
+  static const size_t KEY_SIZE;
+
+  static Buffer
+  generateKey();
+
+  static Buffer
+  deriveEncryptKey(const Buffer& keyBits);
+
+  /**
+   * @brief Unwrap a content key
+   * @param key recipient private key
+   * @param ephemeralKey ephemeral public key produced by encrypt()
+   * @param payload wrapped content key
+   */
+  static Buffer
+  decrypt(const uint8_t* key, size_t keyLen,
+          const uint8_t* ephemeralKey, size_t ephemeralKeyLen,
+          const uint8_t* payload, size_t payloadLen);
+
+  /**
+   * @brief Wrap a content key
+   * @param key recipient public key
+   * @param payload content key, a multiple of 8 bytes and at least 16 bytes long
+   * @return the ephemeral public key and the wrapped content key
+   */
+  static std::tuple<Buffer, Buffer>
+  encrypt(const uint8_t* key, size_t keyLen,
+          const uint8_t* payload, size_t payloadLen);
+};
+
+} // namespace crypto
+} // namespace chunks
+} // namespace ndn
+
+#endif // NAC_CRYPTO_X25519_HPP
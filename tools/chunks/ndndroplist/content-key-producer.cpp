@@ -0,0 +1,85 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016-2019, Regents of the University of California,
+ *                          Colorado State University,
+ *                          University Pierre & Marie Curie, Sorbonne University.
+ *
+ * This file is part of ndn-tools (Named Data Networking Essential Tools).
+ * See AUTHORS.md for complete list of ndn-tools authors and contributors.
+ *
+ * ndn-tools is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-tools is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-tools, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "content-key-producer.hpp"
+
+namespace ndn {
+namespace chunks {
+
+ContentKeyProducer::ContentKeyProducer(const ContentKeyManager& keyManager, Face& face,
+                                       KeyChain& keyChain, const Producer::Options& opts)
+  : m_keyManager(keyManager)
+  , m_face(face)
+  , m_keyChain(keyChain)
+  , m_options(opts)
+{
+  m_face.setInterestFilter(m_keyManager.getPrefix(),
+                           bind(&ContentKeyProducer::processKeyInterest, this, _2),
+                           bind(&ContentKeyProducer::onRegisterFailed, this, _1, _2));
+
+  if (!m_options.isQuiet)
+    std::cerr << "Content keys published under: " << m_keyManager.getPrefix() << std::endl;
+}
+
+void
+ContentKeyProducer::run()
+{
+  m_face.processEvents();
+}
+
+void
+ContentKeyProducer::processKeyInterest(const Interest& interest)
+{
+  if (m_options.isVerbose)
+    std::cerr << "Content key Interest: " << interest << std::endl;
+
+  const Name& name = interest.getName();
+  auto it = m_store.find(name);
+  if (it == m_store.end()) {
+    auto key = m_keyManager.findKey(name);
+    if (key == nullptr) {
+      if (m_options.isVerbose)
+        std::cerr << "Unknown content key, sending Nack" << std::endl;
+      m_face.put(lp::Nack(interest));
+      return;
+    }
+
+    // signed lazily, only keys that are actually requested pay for a signature
+    auto data = make_shared<Data>(key->name);
+    data->setFreshnessPeriod(m_options.freshnessPeriod);
+    data->setContent(key->content);
+    m_keyChain.sign(*data, m_options.signingInfo);
+    it = m_store.emplace(name, std::move(data)).first;
+  }
+
+  m_face.put(*it->second);
+}
+
+void
+ContentKeyProducer::onRegisterFailed(const Name& prefix, const std::string& reason)
+{
+  std::cerr << "ERROR: Failed to register prefix '"
+            << prefix << "' (" << reason << ")" << std::endl;
+  m_face.shutdown();
+}
+
+} // namespace chunks
+} // namespace ndn
@@ -0,0 +1,64 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016-2019, Regents of the University of California,
+ *                          Colorado State University,
+ *                          University Pierre & Marie Curie, Sorbonne University.
+ *
+ * This file is part of ndn-tools (Named Data Networking Essential Tools).
+ * See AUTHORS.md for complete list of ndn-tools authors and contributors.
+ *
+ * ndn-tools is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-tools is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-tools, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NDN_TOOLS_CHUNKS_NDNDROPLIST_CONTENT_KEY_PRODUCER_HPP
+#define NDN_TOOLS_CHUNKS_NDNDROPLIST_CONTENT_KEY_PRODUCER_HPP
+
+#include "producer.hpp"
+#include "../crypto/content-key-manager.hpp"
+
+namespace ndn {
+namespace chunks {
+
+/**
+ * @brief Publishes the content keys issued by a ContentKeyManager
+ *
+ * Every key is published as a single Data packet named after the key, which is what the
+ * CK_LOCATOR of the encrypted content refers to. All keys must have been issued before run().
+ */
+class ContentKeyProducer : noncopyable
+{
+public:
+  ContentKeyProducer(const ContentKeyManager& keyManager, Face& face, KeyChain& keyChain,
+                     const Producer::Options& opts);
+
+  void
+  run();
+
+private:
+  void
+  processKeyInterest(const Interest& interest);
+
+  void
+  onRegisterFailed(const Name& prefix, const std::string& reason);
+
+private:
+  const ContentKeyManager& m_keyManager;
+  Face& m_face;
+  KeyChain& m_keyChain;
+  const Producer::Options m_options;
+  std::map<Name, shared_ptr<Data>> m_store;
+};
+
+} // namespace chunks
+} // namespace ndn
+
+#endif // NDN_TOOLS_CHUNKS_NDNDROPLIST_CONTENT_KEY_PRODUCER_HPP
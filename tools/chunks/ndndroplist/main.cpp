@@ -28,6 +28,7 @@
  */
 
 #include "core/version.hpp"
+#include "content-key-producer.hpp"
 #include "producer.hpp"
 #include <iostream>
 #include <boost/filesystem.hpp>
@@ -43,6 +44,7 @@
 #include <ndn-cxx/security/transform/stream-sink.hpp>
 #include "../crypto/data-enc-dec.hpp"
 #include "../crypto/rsa.hpp"
+#include "../crypto/x25519.hpp"
 namespace po = boost::program_options;
 
 namespace ndn {
@@ -67,6 +69,10 @@ main(int argc, char* argv[])
   std::string signingStr;
   Producer::Options opts;
   std::string ndnDropLink;
+  std::string keyWrap("rsa");
+  std::string keyFile("key.ndn");
+  ContentKeyManager::Options ckOpts;
+  bool wantEmbeddedCk = false;
 
   po::options_description visibleDesc("Options");
   visibleDesc.add_options()
@@ -78,6 +84,14 @@ main(int argc, char* argv[])
     ("size,s",          po::value<size_t>(&opts.maxSegmentSize)->default_value(opts.maxSegmentSize),
                         "maximum chunk size, in bytes")
     ("signing-info,S",  po::value<std::string>(&signingStr), "see 'man ndnputchunks' for usage")
+    ("key-file,k",      po::value<std::string>(&keyFile)->default_value(keyFile),
+                        "private key of the recipient the content keys are wrapped for")
+    ("key-wrap,w",      po::value<std::string>(&keyWrap)->default_value(keyWrap),
+                        "content key wrapping algorithm; valid values are: 'rsa', 'x25519'")
+    ("ck-max-files",    po::value<size_t>(&ckOpts.maxFilesPerKey)->default_value(ckOpts.maxFilesPerKey),
+                        "start a new content key epoch after this many files; 0 means unlimited")
+    ("embed-ck",        po::bool_switch(&wantEmbeddedCk),
+                        "wrap a separate content key into every file instead of sharing epoch keys")
     ("quiet,q",         po::bool_switch(&opts.isQuiet), "turn off all non-error output")
     ("verbose,v",       po::bool_switch(&opts.isVerbose), "turn on verbose output (per Interest information)")
     ("version,V",       "print program version and exit")
@@ -144,10 +158,46 @@ main(int argc, char* argv[])
     return 2;
   }
 
+  if (keyWrap == "rsa") {
+    opts.keyWrapMode = crypto::KEY_WRAP_RSA;
+  }
+  else if (keyWrap == "x25519") {
+    opts.keyWrapMode = crypto::KEY_WRAP_X25519;
+  }
+  else {
+    std::cerr << "ERROR: key wrapping algorithm not valid" << std::endl;
+    return 2;
+  }
+
+  ckOpts.keyWrapMode = opts.keyWrapMode;
+
   if (opts.isQuiet && opts.isVerbose) {
     std::cerr << "ERROR: Cannot be quiet and verbose at the same time" << std::endl;
     return 2;
   }
+
+  // the recipient key is loaded once and shared by all producers
+  std::ifstream keyStream(keyFile, std::ifstream::binary);
+  if (keyStream.fail()) {
+    std::cerr << "ERROR: failed to open " << keyFile << std::endl;
+    return 4;
+  }
+  Buffer encryptKey;
+  try {
+    Buffer keyBits(std::istreambuf_iterator<char>(keyStream), std::istreambuf_iterator<char>{});
+    encryptKey = opts.keyWrapMode == crypto::KEY_WRAP_X25519 ?
+                 crypto::X25519::deriveEncryptKey(keyBits) :
+                 crypto::Rsa::deriveEncryptKey(keyBits);
+  }
+  catch (const std::exception& e) {
+    std::cerr << "ERROR: " << e.what() << std::endl;
+    return 1;
+  }
+
+  unique_ptr<ContentKeyManager> ckManager;
+  if (!wantEmbeddedCk) {
+    ckManager = make_unique<ContentKeyManager>(Name(prefix), encryptKey, ckOpts);
+  }
   std::cout << "path:  " << ndnDropLink << std::endl;
     boost::filesystem::path pa (ndnDropLink);
 
@@ -160,24 +210,6 @@ main(int argc, char* argv[])
   std::vector<Face*> faces;
   std::vector<KeyChain*> keyChains;
   std::vector<std::ifstream*> inFiles;
-  const std::string cipherTextBase64 = 
-  "MIICXAIBAAKBgQC7qlkrJvhJo+nwRpJEevpc4BFxTNXZlgUo4Jb9ewEQbm9qQCEZ\n"
-"drZXoCNuwtDamCvypyGaKKHp+zu8IOYu4TtVyb26tB1DOieBwhQ2QEYjhOquWFvT\n"
-"GJ0udph0KKB8d1tb0SZxBUg8EhrwQSw5cdoZTI4jYo2pNNEtGgGPlkRUxwIDAQAB\n"
-"AoGBAKUhMNMSuFj7/YZqYpwVZiXBGDgM9wM9yY59iP7EdFxEAI+KnFVuquYRx/vX\n"
-"OrWOPuWGgL/ITyi244oXnNPVZkIDkVOG6JICMrfxQYsFtS7NeG1jcKwS5L9NhMTQ\n"
-"QczO/m+6cgcqKnIhxHz+jOesHCJMKwNPO2d3K8H0L89HqYoRAkEA8+VUB8eoquJj\n"
-"yXuiS/toCu8nIz4k3tOg8Q0Nc25ylTdZ2ivw/HaqTUP7N7AFvb6Sw5bSoknNIR44\n"
-"Ks3O5eqOrwJBAMT6nl4K9SYNJoMqfvEpTD9Wr1o8p9Sl4eAtM9+cLVT5kcMw4g/R\n"
-"EQLU28OZF4FSsM8XjkmJrFNThmamo6LY4WkCQFHcnljCJhW9SPr+mVnhd2l8HenR\n"
-"WPTFmZZu6B3fa2w0GN+Gsis69Sxb7f0iArtONNqbS/WWydgc2YNcct5u3RcCQErI\n"
-"XzGS9Wlh2ro3ewQxypnNXjtjBdCsvalvX99IGsnFCjrRpzGcDNpHV7vVtl/JtgiZ\n"
-"h9KRaxQjhMYaA8wCjOkCQA5dhqhtq3WsgwCiQQ/UxPk8oJxUuBs33+zNSX+I34ac\n"
-"szAH0qxEJHJvDCtCLUbc3FVdbRkZ7mBCzL374RlfDss=\n";
-
-  size_t keyLen = 1024;
-  Buffer data = Buffer(reinterpret_cast<const uint8_t*>(cipherTextBase64.data()), keyLen);
-
   int j = 0;
     for (boost::filesystem::directory_iterator itr(pa); itr != end_itr; ++itr)
     {
@@ -195,6 +227,13 @@ main(int argc, char* argv[])
             }
             try {
               outputFileNames[j].insert(0, prefix);
+              // the content keys are published under <prefix>/CK, a file of that name would hide them
+              if (ckManager != nullptr && ckManager->getPrefix().isPrefixOf(Name(outputFileNames[j]))) {
+                std::cerr << "ERROR: " << current_file << " is not published, its name "
+                          << outputFileNames[j] << " is reserved for content keys" << std::endl;
+                outputFileNames.pop_back();
+                continue;
+              }
               std::ifstream *inFile = new std::ifstream;
               inFiles.push_back(inFile);
               inFiles[j]->open(current_file);
@@ -202,7 +241,8 @@ main(int argc, char* argv[])
               faces.push_back(face);
               KeyChain *keyChain = new KeyChain();
               keyChains.push_back(keyChain);
-              producers.push_back(new Producer(outputFileNames[j], *faces[j], *keyChains[j], *inFiles[j], opts, data));
+              producers.push_back(new Producer(outputFileNames[j], *faces[j], *keyChains[j], *inFiles[j], opts,
+                                               encryptKey, ckManager ? ckManager->getKey() : nullptr));
               j++;
             }
             catch (const std::exception& e) {
@@ -214,6 +254,20 @@ main(int argc, char* argv[])
     for (auto p : producers){
       boost::thread *t = group.create_thread(boost::bind(&Producer::run, p));
     }
+
+    // all content keys have been issued by now, so they can be served from another thread
+    unique_ptr<Face> ckFace;
+    unique_ptr<KeyChain> ckKeyChain;
+    unique_ptr<ContentKeyProducer> ckProducer;
+    if (ckManager != nullptr) {
+      if (!opts.isQuiet)
+        std::cerr << "Encrypted " << j << " files with " << ckManager->getNEpochs()
+                  << " content key(s)" << std::endl;
+      ckFace = make_unique<Face>();
+      ckKeyChain = make_unique<KeyChain>();
+      ckProducer = make_unique<ContentKeyProducer>(*ckManager, *ckFace, *ckKeyChain, opts);
+      group.create_thread(boost::bind(&ContentKeyProducer::run, ckProducer.get()));
+    }
     group.join_all();
   return 0;
 }
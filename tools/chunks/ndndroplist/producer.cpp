@@ -30,7 +30,6 @@
 
 #include "producer.hpp"
 #include "../crypto/data-enc-dec.hpp"
-#include "../crypto/rsa.hpp"
 #include <ndn-cxx/encoding/block-helpers.hpp>
 #include <ndn-cxx/security/signing-helpers.hpp>
 #include <ndn-cxx/metadata-object.hpp>
@@ -42,7 +41,8 @@ namespace ndn {
 namespace chunks {
 
 Producer::Producer(const Name& prefix, Face& face, KeyChain& keyChain, std::istream& is,
-                   const Options& opts, Buffer rawKey)
+                   const Options& opts, const Buffer& encryptKey,
+                   shared_ptr<const ContentKey> contentKey)
   : m_face(face)
   , m_keyChain(keyChain)
   , m_options(opts)
@@ -55,21 +55,6 @@ Producer::Producer(const Name& prefix, Face& face, KeyChain& keyChain, std::istr
     m_prefix = prefix;
     m_versionedPrefix = Name(m_prefix).appendVersion();
   }
-    RsaKeyParams params;
-  //reads key
-  std::vector<u_int8_t> beg2;
-  //Find a way to make this more dynamic
-  std::ifstream k ("key.ndn");
-    k >> std::noskipws;
-    uint8_t c;
-    while (k >> c){
-      beg2.push_back(c);
-    }
-    security::transform::PrivateKey priKey;
-    priKey.loadPkcs1(beg2.data(), beg2.size());
-    Buffer tmp2  = Buffer(beg2.data(),beg2.size());
-    auto pubKey = crypto::Rsa::deriveEncryptKey(tmp2);
-
   // get length of file:
   is.seekg (0, is.end);
   int length = is.tellg();
@@ -92,8 +77,10 @@ const char* end = tmp + length;
   else
     std::cout << "error: only " << is.gcount() << " could be read";
 
-  auto encryptedData = encryptDataContentWithCK(buffer, length, pubKey.data(), pubKey.size());
-    auto decryptedData = decryptDataContent(encryptedData, beg2.data(), beg2.size());
+  auto encryptedData = contentKey != nullptr ?
+                       encryptDataContentWithLocator(buffer, length, contentKey->aesKey, contentKey->name) :
+                       encryptDataContentWithCK(buffer, length, encryptKey.data(), encryptKey.size(),
+                                                m_options.keyWrapMode);
 
   std::string tmpEncrypted;
   for(auto j = encryptedData.begin(); j != encryptedData.end(); j++){
@@ -31,6 +31,7 @@
 #define NDN_TOOLS_CHUNKS_PUTCHUNKS_PRODUCER_HPP
 
 #include "core/common.hpp"
+#include "../crypto/content-key-manager.hpp"
 
 namespace ndn {
 namespace chunks {
@@ -53,6 +54,7 @@ public:
     bool isQuiet = false;
     bool isVerbose = false;
     bool wantShowVersion = false;
+    crypto::KEY_WRAP_MODE keyWrapMode = crypto::KEY_WRAP_RSA;
   };
 
 public:
@@ -61,9 +63,13 @@ public:
    *
    * @param prefix prefix used to publish data; if the last component is not a valid
    *               version number, the current system time is used as version number.
+   * @param encryptKey recipient public key, used when @p contentKey is nullptr to wrap a
+   *                   content key generated for this data alone
+   * @param contentKey shared content key the data refers to through CK_LOCATOR
    */
   Producer(const Name& prefix, Face& face, KeyChain& keyChain, std::istream& is,
-           const Options& opts,Buffer rawKey);
+           const Options& opts, const Buffer& encryptKey,
+           shared_ptr<const ContentKey> contentKey = nullptr);
 
   /**
    * @brief Run the Producer
@@ -0,0 +1,487 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016-2019, Regents of the University of California,
+ *                          Colorado State University,
+ *                          University Pierre & Marie Curie, Sorbonne University.
+ *
+ * This file is part of ndn-tools (Named Data Networking Essential Tools).
+ * See AUTHORS.md for complete list of ndn-tools authors and contributors.
+ *
+ * ndn-tools is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-tools is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-tools, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "async-writer.hpp"
+
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+#ifdef HAVE_LIBURING
+#include <liburing.h>
+#endif // HAVE_LIBURING
+
+namespace ndn {
+namespace chunks {
+
+static const size_t APPEND_BATCH_SIZE = 64 * 1024;
+static const size_t MAX_WRITE_BATCH = 64; ///< well below IOV_MAX
+
+#ifdef HAVE_LIBURING
+static const size_t URING_DEPTH = 64;
+
+struct AsyncWriter::Uring
+{
+  ~Uring()
+  {
+    if (isInitialized) {
+      io_uring_queue_exit(&ring);
+    }
+  }
+
+  io_uring ring;
+  bool isInitialized = false;
+};
+#endif // HAVE_LIBURING
+
+AsyncWriter::AsyncWriter(const std::string& path, bool shouldTruncate, size_t queueCapacity)
+  : m_file(path, shouldTruncate)
+  , m_queue(queueCapacity)
+  , m_streamBuf(*this)
+  , m_stream(&m_streamBuf)
+{
+  startWriter();
+}
+
+AsyncWriter::AsyncWriter(int fd, size_t queueCapacity)
+  : m_file(fd)
+  , m_queue(queueCapacity)
+  , m_streamBuf(*this)
+  , m_stream(&m_streamBuf)
+{
+  startWriter();
+}
+
+void
+AsyncWriter::startWriter()
+{
+  // let write errors reach the caller of the stream instead of only setting badbit
+  m_stream.exceptions(std::ios::badbit);
+
+#ifdef HAVE_LIBURING
+  // writes submitted together may complete in any order, which a pipe would not tolerate
+  if (!m_file.isSequential()) {
+    m_uring = make_unique<Uring>();
+    m_uring->isInitialized = io_uring_queue_init(URING_DEPTH, &m_uring->ring, 0) == 0;
+    if (!m_uring->isInitialized) {
+      // e.g. kernel without io_uring support, fall back to pwrite
+      m_uring.reset();
+    }
+  }
+#endif // HAVE_LIBURING
+
+  m_thread = std::thread(&AsyncWriter::run, this);
+}
+
+AsyncWriter::~AsyncWriter()
+{
+  stop();
+}
+
+void
+AsyncWriter::preallocate(uint64_t size)
+{
+  Request request;
+  request.type = Request::PREALLOCATE;
+  request.offset = size;
+  submit(std::move(request));
+}
+
+void
+AsyncWriter::append(const uint8_t* buf, size_t size)
+{
+  if (size >= APPEND_BATCH_SIZE) {
+    // large enough on its own
+    write(m_appendOffset, buf, size);
+    m_appendOffset += size;
+    return;
+  }
+
+  if (m_appendBuffer.empty()) {
+    m_appendBuffer.reserve(APPEND_BATCH_SIZE);
+  }
+  m_appendBuffer.insert(m_appendBuffer.end(), buf, buf + size);
+  m_appendOffset += size;
+  m_fileSize = std::max(m_fileSize, m_appendOffset);
+  if (m_appendBuffer.size() >= APPEND_BATCH_SIZE) {
+    flushAppendBuffer();
+  }
+}
+
+void
+AsyncWriter::write(uint64_t offset, const uint8_t* buf, size_t size)
+{
+  Request request;
+  request.type = Request::WRITE;
+  request.offset = offset;
+  request.data.assign(buf, buf + size);
+  m_fileSize = std::max(m_fileSize, offset + size);
+  submit(std::move(request));
+}
+
+void
+AsyncWriter::checkpoint(const std::string& path, Buffer data)
+{
+  Request request;
+  request.type = Request::CHECKPOINT;
+  request.data = std::move(data);
+  request.path = path;
+  submit(std::move(request));
+}
+
+void
+AsyncWriter::close()
+{
+  flushAppendBuffer();
+  while (!flushOverflow()) {
+    rethrowWriterError();
+    wakeUpWriter();
+    std::this_thread::yield();
+  }
+  stop();
+  rethrowWriterError();
+  m_file.close(m_size.value_or(m_fileSize));
+}
+
+void
+AsyncWriter::submit(Request&& request)
+{
+  rethrowWriterError();
+  // appended data goes first, requests are carried out in order
+  flushAppendBuffer();
+
+  if (request.type == Request::WRITE) {
+    m_pendingBytes.fetch_add(request.data.size(), std::memory_order_relaxed);
+  }
+  // requests must not overtake those waiting in the overflow list
+  if (!flushOverflow() || !m_queue.push(std::move(request))) {
+    m_overflow.push_back(std::move(request));
+  }
+  wakeUpWriter();
+}
+
+void
+AsyncWriter::flushAppendBuffer()
+{
+  if (m_appendBuffer.empty()) {
+    return;
+  }
+
+  Request request;
+  request.type = Request::WRITE;
+  request.offset = m_appendOffset - m_appendBuffer.size();
+  request.data = std::move(m_appendBuffer);
+  m_appendBuffer.clear();
+  submit(std::move(request));
+}
+
+void
+AsyncWriter::setDrainCallback(boost::asio::io_service& io, std::function<void()> onDrained)
+{
+  m_drainIo = &io;
+  m_onDrained = std::move(onDrained);
+}
+
+void
+AsyncWriter::watchDrain()
+{
+  BOOST_ASSERT(m_drainIo != nullptr);
+
+  // pairs with notifyDrain(): the store and the caller's next load of m_pendingBytes are
+  // sequentially consistent with the writer's decrement and exchange
+  m_isDrainWatched.store(true);
+  flushOverflow();
+  wakeUpWriter();
+}
+
+void
+AsyncWriter::notifyDrain()
+{
+  if (m_isDrainWatched.exchange(false)) {
+    m_drainIo->post(m_onDrained);
+  }
+}
+
+bool
+AsyncWriter::flushOverflow()
+{
+  while (!m_overflow.empty()) {
+    if (!m_queue.push(std::move(m_overflow.front()))) {
+      return false;
+    }
+    m_overflow.pop_front();
+  }
+  return true;
+}
+
+void
+AsyncWriter::wakeUpWriter()
+{
+  // pairs with the fence in run(): either the writer sees the new request before going to
+  // sleep, or this thread sees that it is sleeping
+  std::atomic_thread_fence(std::memory_order_seq_cst);
+  if (m_isWriterSleeping.load(std::memory_order_relaxed)) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_cv.notify_one();
+  }
+}
+
+void
+AsyncWriter::rethrowWriterError()
+{
+  if (m_hasError.load(std::memory_order_acquire)) {
+    std::rethrow_exception(m_error);
+  }
+}
+
+void
+AsyncWriter::stop()
+{
+  if (!m_thread.joinable()) {
+    return;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_isStopping = true;
+    m_cv.notify_one();
+  }
+  m_thread.join();
+}
+
+void
+AsyncWriter::run()
+{
+  try {
+    while (true) {
+      // read before looking at the queue, everything submitted before stop() is visible then
+      bool isStopping = m_isStopping.load();
+      if (process() > 0) {
+        continue;
+      }
+      if (isStopping) {
+        break;
+      }
+
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_isWriterSleeping.store(true, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      m_cv.wait(lock, [this] { return !m_queue.empty() || m_isStopping; });
+      m_isWriterSleeping.store(false, std::memory_order_relaxed);
+    }
+  }
+  catch (...) {
+    m_error = std::current_exception();
+    m_hasError.store(true, std::memory_order_release);
+  }
+}
+
+size_t
+AsyncWriter::process()
+{
+#ifdef HAVE_LIBURING
+  if (m_uring != nullptr) {
+    return processWithUring();
+  }
+#endif // HAVE_LIBURING
+
+  Request* request = m_queue.peek();
+  if (request == nullptr) {
+    return 0;
+  }
+
+  switch (request->type) {
+    case Request::PREALLOCATE:
+      m_file.preallocate(request->offset);
+      break;
+    case Request::WRITE:
+      return processWrites();
+    case Request::CHECKPOINT:
+      processCheckpoint(*request);
+      break;
+    case Request::NONE:
+      break;
+  }
+  m_queue.pop();
+  return 1;
+}
+
+size_t
+AsyncWriter::processWrites()
+{
+  iovec iov[MAX_WRITE_BATCH];
+  uint64_t offset = m_queue.peek()->offset;
+  uint64_t end = offset;
+  size_t nRequests = 0;
+  for (; nRequests < MAX_WRITE_BATCH; ++nRequests) {
+    Request* request = m_queue.peek(nRequests);
+    if (request == nullptr || request->type != Request::WRITE || request->offset != end) {
+      break;
+    }
+    iov[nRequests].iov_base = request->data.data();
+    iov[nRequests].iov_len = request->data.size();
+    end += request->data.size();
+  }
+
+  m_file.write(offset, iov, nRequests);
+  m_pendingBytes.fetch_sub(static_cast<size_t>(end - offset));
+  m_queue.pop(nRequests);
+  notifyDrain();
+  return nRequests;
+}
+
+size_t
+AsyncWriter::processWithUring()
+{
+#ifdef HAVE_LIBURING
+  Request* request = m_queue.peek();
+  if (request == nullptr) {
+    return 0;
+  }
+  if (request->type == Request::PREALLOCATE) {
+    m_file.preallocate(request->offset);
+    m_queue.pop();
+    return 1;
+  }
+  if (request->type == Request::CHECKPOINT) {
+    // writes before it have all completed, see below
+    processCheckpoint(*request);
+    m_queue.pop();
+    return 1;
+  }
+
+  // the requests stay in the queue, and their buffers alive, until the kernel is done with them
+  io_uring* ring = &m_uring->ring;
+  size_t nSubmitted = 0;
+  for (; nSubmitted < URING_DEPTH; ++nSubmitted) {
+    request = m_queue.peek(nSubmitted);
+    if (request == nullptr || request->type != Request::WRITE) {
+      break;
+    }
+    io_uring_sqe* sqe = io_uring_get_sqe(ring);
+    if (sqe == nullptr) {
+      break;
+    }
+    io_uring_prep_write(sqe, m_file.getFd(), request->data.data(),
+                        static_cast<unsigned>(request->data.size()), request->offset);
+    io_uring_sqe_set_data(sqe, request);
+  }
+
+  int ret = io_uring_submit_and_wait(ring, static_cast<unsigned>(nSubmitted));
+  if (ret < 0) {
+    NDN_THROW(PositionalWriter::Error(std::string("io_uring submission failed: ") + std::strerror(-ret)));
+  }
+
+  // reap every completion before reporting an error, the kernel may still use the buffers
+  std::string error;
+  for (size_t i = 0; i < nSubmitted; ++i) {
+    io_uring_cqe* cqe = nullptr;
+    ret = io_uring_wait_cqe(ring, &cqe);
+    if (ret < 0) {
+      NDN_THROW(PositionalWriter::Error(std::string("io_uring completion failed: ") + std::strerror(-ret)));
+    }
+    auto completed = static_cast<Request*>(io_uring_cqe_get_data(cqe));
+    int res = cqe->res;
+    io_uring_cqe_seen(ring, cqe);
+
+    if (res < 0 && res != -EINTR && res != -EAGAIN) {
+      error = std::string("io_uring write failed: ") + std::strerror(-res);
+      continue;
+    }
+    size_t nWritten = res < 0 ? 0 : static_cast<size_t>(res);
+    if (nWritten < completed->data.size() && error.empty()) {
+      // short or interrupted write, finish it synchronously
+      m_file.write(completed->offset + nWritten, completed->data.data() + nWritten,
+                   completed->data.size() - nWritten);
+    }
+    m_pendingBytes.fetch_sub(completed->data.size());
+  }
+  if (!error.empty()) {
+    NDN_THROW(PositionalWriter::Error(error));
+  }
+
+  m_queue.pop(nSubmitted);
+  notifyDrain();
+  return nSubmitted;
+#else
+  return 0;
+#endif // HAVE_LIBURING
+}
+
+void
+AsyncWriter::processCheckpoint(const Request& request)
+{
+  m_file.sync();
+
+  // write to a temporary file first, so that a crash leaves either the old or the new version
+  std::string tmpPath = request.path + ".tmp";
+  int fd = ::open(tmpPath.data(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    NDN_THROW(PositionalWriter::Error("Cannot open " + tmpPath + ": " + std::strerror(errno)));
+  }
+  const uint8_t* buf = request.data.data();
+  size_t size = request.data.size();
+  while (size > 0) {
+    ssize_t n = ::write(fd, buf, size);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n < 0) {
+      int error = errno;
+      ::close(fd);
+      NDN_THROW(PositionalWriter::Error("Cannot write to " + tmpPath + ": " + std::strerror(error)));
+    }
+    buf += n;
+    size -= static_cast<size_t>(n);
+  }
+  int error = ::fsync(fd) == 0 ? 0 : errno;
+  if (::close(fd) != 0 && error == 0) {
+    error = errno;
+  }
+  if (error != 0) {
+    NDN_THROW(PositionalWriter::Error("Cannot sync " + tmpPath + ": " + std::strerror(error)));
+  }
+  if (std::rename(tmpPath.data(), request.path.data()) != 0) {
+    NDN_THROW(PositionalWriter::Error("Cannot rename " + tmpPath + ": " + std::strerror(errno)));
+  }
+}
+
+std::streamsize
+AsyncWriter::StreamBuf::xsputn(const char* s, std::streamsize n)
+{
+  m_writer.append(reinterpret_cast<const uint8_t*>(s), static_cast<size_t>(n));
+  return n;
+}
+
+AsyncWriter::StreamBuf::int_type
+AsyncWriter::StreamBuf::overflow(int_type ch)
+{
+  if (!traits_type::eq_int_type(ch, traits_type::eof())) {
+    char c = traits_type::to_char_type(ch);
+    m_writer.append(reinterpret_cast<const uint8_t*>(&c), 1);
+  }
+  return traits_type::not_eof(ch);
+}
+
+} // namespace chunks
+} // namespace ndn
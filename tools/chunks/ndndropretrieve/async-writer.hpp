@@ -0,0 +1,286 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016-2019, Regents of the University of California,
+ *                          Colorado State University,
+ *                          University Pierre & Marie Curie, Sorbonne University.
+ *
+ * This file is part of ndn-tools (Named Data Networking Essential Tools).
+ * See AUTHORS.md for complete list of ndn-tools authors and contributors.
+ *
+ * ndn-tools is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-tools is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-tools, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NDN_TOOLS_CHUNKS_CATCHUNKS_ASYNC_WRITER_HPP
+#define NDN_TOOLS_CHUNKS_CATCHUNKS_ASYNC_WRITER_HPP
+
+#include "positional-writer.hpp"
+#include "spsc-queue.hpp"
+
+#include <boost/asio/io_service.hpp>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <ostream>
+#include <streambuf>
+#include <thread>
+
+namespace ndn {
+namespace chunks {
+
+/**
+ * @brief Writes the output file from a dedicated thread
+ *
+ * Write requests are handed to the writer thread through a lock-free SPSC queue, so the thread
+ * running the face never waits for storage. When the queue is full, requests are held in an
+ * overflow list and handed over by later calls. If ndn-tools was configured with liburing,
+ * batches of writes are submitted through io_uring, with pwrite as the fallback.
+ *
+ * Appended data is gathered into requests of a few tens of kilobytes, and the writer thread
+ * hands each run of contiguous writes to the kernel in one vectored write, so that small
+ * segments do not cost a system call each.
+ *
+ * All member functions must be called from the same thread. Errors on the writer thread are
+ * rethrown by the next call.
+ */
+class AsyncWriter : noncopyable
+{
+public:
+  /**
+   * @brief Open @p path, see PositionalWriter, and start the writer thread
+   * @param queueCapacity number of requests that can be handed over without allocating
+   */
+  explicit
+  AsyncWriter(const std::string& path, bool shouldTruncate = true, size_t queueCapacity = 1024);
+
+  /**
+   * @brief Write sequentially to the already open @p fd, e.g. the standard output, see
+   *        PositionalWriter(int)
+   */
+  explicit
+  AsyncWriter(int fd, size_t queueCapacity = 1024);
+
+  /**
+   * @brief Stop the writer thread once it has carried out the requests already handed to it
+   */
+  ~AsyncWriter();
+
+  /**
+   * @brief Reserve @p size bytes of storage for the file, see PositionalWriter::preallocate
+   */
+  void
+  preallocate(uint64_t size);
+
+  /**
+   * @brief Write a copy of @p buf after the data passed to the previous append()
+   */
+  void
+  append(const uint8_t* buf, size_t size);
+
+  /**
+   * @brief Write a copy of @p buf at @p offset
+   */
+  void
+  write(uint64_t offset, const uint8_t* buf, size_t size);
+
+  /**
+   * @brief Once the writes submitted so far are on storage, atomically replace @p path with
+   *        @p data
+   *
+   * Lets the caller record progress that survives a crash, e.g. which parts of the file are
+   * complete.
+   */
+  void
+  checkpoint(const std::string& path, Buffer data);
+
+  /**
+   * @brief Set the size that close() trims the file to
+   *
+   * Defaults to the end of the furthest write, which is wrong only if some parts of the file
+   * were written by an earlier process.
+   */
+  void
+  setSize(uint64_t size)
+  {
+    m_size = size;
+  }
+
+  /**
+   * @brief Wait for all writes, trim the file to its size and close it
+   * @throw PositionalWriter::Error a write failed
+   */
+  void
+  close();
+
+  /**
+   * @brief Stream whose output goes to append()
+   */
+  std::ostream&
+  getStream()
+  {
+    return m_stream;
+  }
+
+  /**
+   * @brief Number of file bytes handed to the writer and not yet written
+   */
+  size_t
+  getPendingBytes() const
+  {
+    return m_pendingBytes.load() + m_appendBuffer.size();
+  }
+
+  /**
+   * @brief Set the callback that watchDrain() arms
+   *
+   * @p onDrained is posted to @p io from the writer thread, so the caller can wait for storage
+   * without blocking the thread that runs @p io.
+   */
+  void
+  setDrainCallback(boost::asio::io_service& io, std::function<void()> onDrained);
+
+  /**
+   * @brief Post the drain callback once the writer thread completes its next writes
+   *
+   * Also hands over the requests held in the overflow list, which only the calling thread can
+   * do. A caller that checks getPendingBytes() again after this call is either told that the
+   * writes it waits for have completed, or receives the callback.
+   */
+  void
+  watchDrain();
+
+private:
+  struct Request
+  {
+    enum Type {
+      NONE,
+      PREALLOCATE,
+      WRITE,
+      CHECKPOINT,
+    };
+
+    Type type = NONE;
+    uint64_t offset = 0; ///< offset of WRITE, size of PREALLOCATE
+    Buffer data;
+    std::string path;    ///< file replaced by CHECKPOINT
+  };
+
+  void
+  startWriter();
+
+  void
+  submit(Request&& request);
+
+  /**
+   * @brief Submit the data gathered by append()
+   */
+  void
+  flushAppendBuffer();
+
+  bool
+  flushOverflow();
+
+  /**
+   * @brief Post the drain callback if watchDrain() was called since the last one
+   */
+  void
+  notifyDrain();
+
+  void
+  wakeUpWriter();
+
+  void
+  rethrowWriterError();
+
+  /**
+   * @brief Body of the writer thread
+   */
+  void
+  run();
+
+  /**
+   * @brief Carry out and pop the requests at the front of the queue
+   * @return number of requests carried out
+   */
+  size_t
+  process();
+
+  /**
+   * @brief Write the run of contiguous WRITE requests at the front of the queue
+   */
+  size_t
+  processWrites();
+
+  size_t
+  processWithUring();
+
+  void
+  processCheckpoint(const Request& request);
+
+  void
+  stop();
+
+private:
+  class StreamBuf : public std::streambuf
+  {
+  public:
+    explicit
+    StreamBuf(AsyncWriter& writer)
+      : m_writer(writer)
+    {
+    }
+
+  protected:
+    std::streamsize
+    xsputn(const char* s, std::streamsize n) final;
+
+    int_type
+    overflow(int_type ch) final;
+
+  private:
+    AsyncWriter& m_writer;
+  };
+
+  PositionalWriter m_file;
+  SpscQueue<Request> m_queue;
+  std::deque<Request> m_overflow; ///< owned by the calling thread
+  uint64_t m_appendOffset = 0;     ///< where the next append() starts
+  Buffer m_appendBuffer;           ///< appended data not submitted yet, ends at m_appendOffset
+  uint64_t m_fileSize = 0;
+  optional<uint64_t> m_size;
+  std::atomic<size_t> m_pendingBytes{0};
+  boost::asio::io_service* m_drainIo = nullptr;
+  std::function<void()> m_onDrained;
+  std::atomic<bool> m_isDrainWatched{false};
+
+  StreamBuf m_streamBuf;
+  std::ostream m_stream;
+
+  std::mutex m_mutex;
+  std::condition_variable m_cv;
+  std::atomic<bool> m_isWriterSleeping{false};
+  std::atomic<bool> m_isStopping{false};
+  std::atomic<bool> m_hasError{false};
+  std::exception_ptr m_error; ///< written by the writer thread before m_hasError
+
+#ifdef HAVE_LIBURING
+  struct Uring;
+  unique_ptr<Uring> m_uring;
+#endif // HAVE_LIBURING
+
+  std::thread m_thread;
+};
+
+} // namespace chunks
+} // namespace ndn
+
+#endif // NDN_TOOLS_CHUNKS_CATCHUNKS_ASYNC_WRITER_HPP
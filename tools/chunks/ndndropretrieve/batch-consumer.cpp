@@ -0,0 +1,200 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016-2019, Regents of the University of California,
+ *                          Colorado State University,
+ *                          University Pierre & Marie Curie, Sorbonne University.
+ *
+ * This file is part of ndn-tools (Named Data Networking Essential Tools).
+ * See AUTHORS.md for complete list of ndn-tools authors and contributors.
+ *
+ * ndn-tools is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-tools is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-tools, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "batch-consumer.hpp"
+
+#include <cstdio>
+#include <iterator>
+
+namespace ndn {
+namespace chunks {
+
+BatchConsumer::BatchConsumer(Face& face, security::v2::Validator& validator, const Options& options,
+                             size_t maxConcurrent, PipelineFactory makePipeline,
+                             shared_ptr<const RttEstimatorWithStats::Options> rttOptions)
+  : m_face(face)
+  , m_validator(validator)
+  , m_options(options)
+  , m_maxConcurrent(maxConcurrent)
+  , m_makePipeline(std::move(makePipeline))
+  , m_rttOptions(std::move(rttOptions))
+{
+  BOOST_ASSERT(m_maxConcurrent > 0);
+}
+
+BatchConsumer::~BatchConsumer() = default;
+
+void
+BatchConsumer::setDecryptionKey(Buffer key)
+{
+  m_contentKeys = make_unique<ContentKeyCache>(m_face, m_validator, std::move(key), m_options);
+}
+
+void
+BatchConsumer::enablePositionalWrites()
+{
+  m_wantPositionalWrites = true;
+}
+
+void
+BatchConsumer::setValidationPool(ValidationPool& pool)
+{
+  m_validationPool = &pool;
+}
+
+void
+BatchConsumer::setMemoryLimit(size_t maxBufferedBytes)
+{
+  m_maxBufferedBytes = maxBufferedBytes;
+}
+
+void
+BatchConsumer::run(std::vector<Item> items)
+{
+  m_nItems += items.size();
+  std::move(items.begin(), items.end(), std::back_inserter(m_queue));
+  m_startTime = time::steady_clock::now();
+  startNext();
+}
+
+void
+BatchConsumer::startNext()
+{
+  while (m_transfers.size() < m_maxConcurrent && !m_queue.empty()) {
+    Item item = std::move(m_queue.front());
+    m_queue.pop_front();
+    start(std::move(item));
+  }
+}
+
+void
+BatchConsumer::start(Item item)
+{
+  if (m_options.isVerbose)
+    std::cerr << "Retrieving " << item.name << " into " << item.outputPath << std::endl;
+
+  m_transfers.emplace_back();
+  auto it = std::prev(m_transfers.end());
+  Transfer& transfer = *it;
+  transfer.item = std::move(item);
+  transfer.startTime = time::steady_clock::now();
+
+  try {
+    transfer.rttEstimator = make_unique<RttEstimatorWithStats>(m_rttOptions);
+    transfer.writer = make_unique<AsyncWriter>(transfer.item.outputPath);
+    transfer.consumer = make_unique<Consumer>(m_validator, *transfer.writer);
+    if (m_wantPositionalWrites) {
+      transfer.consumer->enablePositionalWrites();
+    }
+    if (m_contentKeys != nullptr) {
+      transfer.consumer->setDecryptionKey(*m_contentKeys);
+    }
+    if (m_validationPool != nullptr) {
+      transfer.consumer->setValidationPool(*m_validationPool);
+    }
+    transfer.consumer->setMemoryLimit(m_maxBufferedBytes, m_face.getIoService());
+    transfer.consumer->setCompletionCallbacks([this, it] { onComplete(it); },
+                                              [this, it] (std::exception_ptr error) { onError(it, error); });
+    transfer.consumer->run(make_unique<DiscoverVersion>(m_face, transfer.item.name, m_options),
+                           m_makePipeline(*transfer.rttEstimator));
+  }
+  catch (const std::exception&) {
+    onError(it, std::current_exception());
+  }
+}
+
+void
+BatchConsumer::onComplete(std::list<Transfer>::iterator it)
+{
+  try {
+    it->writer->close();
+  }
+  catch (const std::exception&) {
+    return onError(it, std::current_exception());
+  }
+
+  m_nCompleted++;
+  uint64_t size = it->consumer->getReceivedSize();
+  m_receivedSize += size;
+
+  if (!m_options.isQuiet) {
+    time::duration<double, time::seconds::period> elapsed = time::steady_clock::now() - it->startTime;
+    std::cerr << formatProgress() << " " << it->item.name << ": " << size / 1e3 << " kB in "
+              << elapsed.count() << " s" << std::endl;
+  }
+
+  finish(it, false);
+}
+
+void
+BatchConsumer::onError(std::list<Transfer>::iterator it, std::exception_ptr error)
+{
+  m_nFailed++;
+
+  std::string reason;
+  try {
+    std::rethrow_exception(error);
+  }
+  catch (const std::exception& e) {
+    reason = e.what();
+  }
+  catch (...) {
+    reason = "unknown error";
+  }
+  std::cerr << formatProgress() << " ERROR: " << it->item.name << ": " << reason << std::endl;
+
+  finish(it, true);
+}
+
+void
+BatchConsumer::finish(std::list<Transfer>::iterator it, bool isFailed)
+{
+  // the consumer may still be on the stack
+  m_face.getIoService().post([this, it, isFailed] {
+    std::string outputPath = it->item.outputPath;
+    m_transfers.erase(it);
+    if (isFailed) {
+      std::remove(outputPath.data());
+    }
+    startNext();
+  });
+}
+
+std::string
+BatchConsumer::formatProgress() const
+{
+  return "[" + to_string(m_nCompleted + m_nFailed) + "/" + to_string(m_nItems) + "]";
+}
+
+void
+BatchConsumer::printSummary() const
+{
+  time::duration<double, time::seconds::period> elapsed = time::steady_clock::now() - m_startTime;
+  std::cerr << "Retrieved " << m_nCompleted << " of " << m_nItems << " files";
+  if (m_nFailed > 0) {
+    std::cerr << " (" << m_nFailed << " failed)";
+  }
+  std::cerr << ", " << m_receivedSize / 1e3 << " kB in " << elapsed.count() << " s, goodput "
+            << PipelineInterests::formatThroughput(8 * m_receivedSize / elapsed.count()) << std::endl;
+}
+
+} // namespace chunks
+} // namespace ndn
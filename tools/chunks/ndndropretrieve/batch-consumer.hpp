@@ -0,0 +1,179 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016-2019, Regents of the University of California,
+ *                          Colorado State University,
+ *                          University Pierre & Marie Curie, Sorbonne University.
+ *
+ * This file is part of ndn-tools (Named Data Networking Essential Tools).
+ * See AUTHORS.md for complete list of ndn-tools authors and contributors.
+ *
+ * ndn-tools is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-tools is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-tools, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NDN_TOOLS_CHUNKS_CATCHUNKS_BATCH_CONSUMER_HPP
+#define NDN_TOOLS_CHUNKS_CATCHUNKS_BATCH_CONSUMER_HPP
+
+#include "consumer.hpp"
+#include "content-key-cache.hpp"
+
+#include <ndn-cxx/util/rtt-estimator.hpp>
+
+#include <deque>
+#include <list>
+
+namespace ndn {
+namespace chunks {
+
+using util::RttEstimatorWithStats;
+
+/**
+ * @brief Retrieves many files concurrently over one Face
+ *
+ * Every file gets its own version discovery, pipeline, RTT estimator, Consumer and output file,
+ * and at most a configured number of them are retrieved at the same time. A failed retrieval
+ * is reported and its partial output file removed, without affecting the others.
+ */
+class BatchConsumer : noncopyable
+{
+public:
+  struct Item
+  {
+    Name name;              ///< name of the file, version discovery is done as for a single file
+    std::string outputPath; ///< where the file is written
+  };
+
+  using PipelineFactory = std::function<unique_ptr<PipelineInterests>(RttEstimatorWithStats& rttEstimator)>;
+
+  /**
+   * @param maxConcurrent maximum number of files retrieved at the same time
+   * @param makePipeline creates the pipeline of each file
+   * @param rttOptions options of the RTT estimator of each file
+   */
+  BatchConsumer(Face& face, security::v2::Validator& validator, const Options& options,
+                size_t maxConcurrent, PipelineFactory makePipeline,
+                shared_ptr<const RttEstimatorWithStats::Options> rttOptions);
+
+  ~BatchConsumer();
+
+  /**
+   * @brief Decrypt every file with @p key, see Consumer::setDecryptionKey
+   *
+   * Files that share a content key fetch and unwrap it once for the whole batch.
+   */
+  void
+  setDecryptionKey(Buffer key);
+
+  /**
+   * @brief Write the segments of every file at their offsets, see Consumer::enablePositionalWrites
+   */
+  void
+  enablePositionalWrites();
+
+  /**
+   * @brief Validate the segments of every file on @p pool, see Consumer::setValidationPool
+   */
+  void
+  setValidationPool(ValidationPool& pool);
+
+  /**
+   * @brief Limit the content held in memory for every file, see Consumer::setMemoryLimit
+   *
+   * The limit applies to each running transfer, so the batch may hold up to maxConcurrent times
+   * @p maxBufferedBytes.
+   */
+  void
+  setMemoryLimit(size_t maxBufferedBytes);
+
+  /**
+   * @brief Start retrieving @p items
+   *
+   * The retrievals progress while the face processes events, which returns once all of them
+   * have completed or failed.
+   */
+  void
+  run(std::vector<Item> items);
+
+  size_t
+  getNCompleted() const
+  {
+    return m_nCompleted;
+  }
+
+  size_t
+  getNFailed() const
+  {
+    return m_nFailed;
+  }
+
+  /**
+   * @brief Print the number of retrieved files, their total size and the combined goodput
+   */
+  void
+  printSummary() const;
+
+private:
+  struct Transfer
+  {
+    Item item;
+    unique_ptr<RttEstimatorWithStats> rttEstimator;
+    unique_ptr<AsyncWriter> writer;
+    unique_ptr<Consumer> consumer;
+    time::steady_clock::TimePoint startTime;
+  };
+
+  void
+  startNext();
+
+  void
+  start(Item item);
+
+  void
+  onComplete(std::list<Transfer>::iterator it);
+
+  void
+  onError(std::list<Transfer>::iterator it, std::exception_ptr error);
+
+  /**
+   * @brief Remove a finished transfer and start the next item, outside of its callbacks
+   */
+  void
+  finish(std::list<Transfer>::iterator it, bool isFailed);
+
+  std::string
+  formatProgress() const;
+
+private:
+  Face& m_face;
+  security::v2::Validator& m_validator;
+  const Options& m_options;
+  const size_t m_maxConcurrent;
+  PipelineFactory m_makePipeline;
+  shared_ptr<const RttEstimatorWithStats::Options> m_rttOptions;
+
+  unique_ptr<ContentKeyCache> m_contentKeys; ///< outlives the consumers in m_transfers
+  bool m_wantPositionalWrites = false;
+  ValidationPool* m_validationPool = nullptr;
+  size_t m_maxBufferedBytes = 0;
+
+  std::deque<Item> m_queue;
+  std::list<Transfer> m_transfers; ///< running transfers, with stable iterators for callbacks
+  size_t m_nItems = 0;
+  size_t m_nCompleted = 0;
+  size_t m_nFailed = 0;
+  uint64_t m_receivedSize = 0;     ///< content size of the completed files
+  time::steady_clock::TimePoint m_startTime;
+};
+
+} // namespace chunks
+} // namespace ndn
+
+#endif // NDN_TOOLS_CHUNKS_CATCHUNKS_BATCH_CONSUMER_HPP
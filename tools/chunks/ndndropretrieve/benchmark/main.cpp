@@ -0,0 +1,557 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016-2019, Regents of the University of California,
+ *                          Colorado State University,
+ *                          University Pierre & Marie Curie, Sorbonne University.
+ *
+ * This file is part of ndn-tools (Named Data Networking Essential Tools).
+ * See AUTHORS.md for complete list of ndn-tools authors and contributors.
+ *
+ * ndn-tools is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-tools is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-tools, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "core/common.hpp"
+#include "core/version.hpp"
+#include "../options.hpp"
+#include "../pipeline-interests-aimd.hpp"
+#include "../pipeline-interests-bbr.hpp"
+#include "../pipeline-interests-cubic.hpp"
+#include "../pipeline-interests-fixed.hpp"
+#include "../pipeline-interests-ledbat.hpp"
+
+#include <deque>
+#include <fstream>
+#include <random>
+#include <sstream>
+
+#include <ndn-cxx/lp/tags.hpp>
+#include <ndn-cxx/security/signature-sha256-with-rsa.hpp>
+#include <ndn-cxx/util/dummy-client-face.hpp>
+#include <ndn-cxx/util/time-unit-test-clock.hpp>
+
+namespace ndn {
+namespace chunks {
+
+namespace po = boost::program_options;
+
+struct LinkOptions
+{
+  double bandwidthMbps = 100.0;  ///< bottleneck rate for Data
+  time::milliseconds delay{20};  ///< one-way propagation delay, in each direction
+  size_t queueSize = 100;        ///< Data packets the bottleneck can hold, including the one being sent
+  double lossRate = 0.0;         ///< probability that a Data packet is dropped at random
+  size_t markThreshold = 0;      ///< queue length from which Data is marked, 0 never marks
+};
+
+struct BenchmarkOptions
+{
+  std::vector<std::string> pipelineTypes;
+  uint64_t nSegments = 10000;
+  size_t segmentSize = 4400;     ///< ndndroppublish's default
+  time::microseconds tick{100};  ///< granularity of the emulated clock
+  time::seconds maxDuration{600};
+  uint32_t seed = 1;
+};
+
+/**
+ * @brief Producer behind a bottleneck link, attached to a DummyClientFace
+ *
+ * Interests reach the producer after the one-way delay. Its Data waits in a FIFO at the
+ * bottleneck, which sends it at the link bandwidth, drops it when the queue is full or at random,
+ * and marks it when the queue is at least the marking threshold long on arrival. Sent Data
+ * reaches the consumer after the one-way delay.
+ */
+class EmulatedLink : noncopyable
+{
+public:
+  EmulatedLink(util::DummyClientFace& face, const Name& prefix, const BenchmarkOptions& opts,
+               const LinkOptions& linkOpts)
+    : m_face(face)
+    , m_prefix(prefix)
+    , m_opts(opts)
+    , m_linkOpts(linkOpts)
+    , m_scheduler(face.getIoService())
+    , m_content(make_shared<Buffer>(opts.segmentSize))
+    , m_isRequested(opts.nSegments, false)
+    , m_random(opts.seed)
+  {
+    m_dataSize = makeData(0, false).wireEncode().size();
+    m_face.onSendInterest.connect([this] (const Interest& interest) {
+      m_scheduler.schedule(m_linkOpts.delay, [this, interest] { receiveInterest(interest); });
+    });
+  }
+
+  uint64_t
+  getNInterests() const
+  {
+    return m_nInterests;
+  }
+
+  /**
+   * @return # of Interests for segments that had been requested before
+   */
+  uint64_t
+  getNRetransmissions() const
+  {
+    return m_nRetransmissions;
+  }
+
+  uint64_t
+  getNDrops() const
+  {
+    return m_nDrops;
+  }
+
+  uint64_t
+  getNMarks() const
+  {
+    return m_nMarks;
+  }
+
+private:
+  Data
+  makeData(uint64_t segNo, bool isMarked) const
+  {
+    Data data(Name(m_prefix).appendSegment(segNo));
+    data.setContent(m_content);
+    data.setFinalBlock(name::Component::fromSegment(m_opts.nSegments - 1));
+
+    // the consumer does not validate anything, an empty signature is enough
+    SignatureSha256WithRsa fakeSignature;
+    fakeSignature.setValue(encoding::makeEmptyBlock(tlv::SignatureValue));
+    data.setSignature(fakeSignature);
+    if (isMarked) {
+      data.setTag(make_shared<lp::CongestionMarkTag>(1));
+    }
+    return data;
+  }
+
+  void
+  receiveInterest(const Interest& interest)
+  {
+    m_nInterests++;
+    uint64_t segNo = interest.getName().at(-1).toSegment();
+    if (segNo >= m_opts.nSegments) {
+      return; // beyond the end of the content, like a real producer
+    }
+    if (m_isRequested[segNo]) {
+      m_nRetransmissions++;
+    }
+    m_isRequested[segNo] = true;
+
+    if (m_queue.size() >= m_linkOpts.queueSize ||
+        std::bernoulli_distribution(m_linkOpts.lossRate)(m_random)) {
+      m_nDrops++;
+      return;
+    }
+
+    bool isMarked = m_linkOpts.markThreshold > 0 && m_queue.size() >= m_linkOpts.markThreshold;
+    if (isMarked) {
+      m_nMarks++;
+    }
+    m_queue.push_back({segNo, isMarked});
+    if (m_queue.size() == 1) {
+      transmitHead();
+    }
+  }
+
+  void
+  transmitHead()
+  {
+    auto transmitTime = time::nanoseconds(static_cast<time::nanoseconds::rep>(
+                          m_dataSize * 8 * 1e3 / m_linkOpts.bandwidthMbps));
+    m_scheduler.schedule(transmitTime, [this] {
+      QueuedData head = m_queue.front();
+      m_queue.pop_front();
+      m_scheduler.schedule(m_linkOpts.delay, [this, head] {
+        m_face.receive(makeData(head.segNo, head.isMarked));
+      });
+
+      if (!m_queue.empty()) {
+        transmitHead();
+      }
+    });
+  }
+
+private:
+  struct QueuedData
+  {
+    uint64_t segNo;
+    bool isMarked;
+  };
+
+  util::DummyClientFace& m_face;
+  const Name m_prefix;
+  const BenchmarkOptions& m_opts;
+  const LinkOptions& m_linkOpts;
+  Scheduler m_scheduler;
+  ConstBufferPtr m_content;
+  size_t m_dataSize;
+
+  std::deque<QueuedData> m_queue; ///< the front is being transmitted
+  std::vector<bool> m_isRequested;
+  std::mt19937 m_random;
+
+  uint64_t m_nInterests = 0;
+  uint64_t m_nRetransmissions = 0;
+  uint64_t m_nDrops = 0;
+  uint64_t m_nMarks = 0;
+};
+
+struct RunResult
+{
+  bool isComplete = false;
+  time::nanoseconds duration;
+  uint64_t nReceivedBytes = 0;
+  uint64_t nInterests = 0;
+  uint64_t nRetransmissions = 0;
+  uint64_t nDrops = 0;
+  uint64_t nMarks = 0;
+};
+
+/**
+ * @brief Retrieve the emulated content with one pipeline, on an emulated clock
+ *
+ * Does what tests::UnitTestTimeFixture does, so that a run takes as long as the simulation needs
+ * rather than as long as the transfer would.
+ */
+static RunResult
+runPipeline(const std::string& pipelineType, const BenchmarkOptions& opts, const LinkOptions& linkOpts,
+            const Options& pipelineOpts, std::ostream* osCwnd, std::ostream* osRtt)
+{
+  auto steadyClock = make_shared<time::UnitTestSteadyClock>();
+  auto systemClock = make_shared<time::UnitTestSystemClock>();
+  time::setCustomClocks(steadyClock, systemClock);
+
+  RunResult result;
+  {
+    boost::asio::io_service io;
+    util::DummyClientFace face(io, {false, false});
+    Name prefix = Name("/benchmark/content").appendVersion(1);
+    EmulatedLink link(face, prefix, opts, linkOpts);
+
+    auto rttOpts = make_shared<RttEstimatorWithStats::Options>();
+    rttOpts->initialRto = 1_s;
+    rttOpts->minRto = 200_ms;
+    rttOpts->maxRto = 60_s;
+    rttOpts->rtoBackoffMultiplier = 2;
+    RttEstimatorWithStats rttEstimator(std::move(rttOpts));
+
+    unique_ptr<PipelineInterests> pipeline;
+    unique_ptr<PipelineInterestsAdaptive> adaptivePipeline;
+    if (pipelineType == "fixed") {
+      pipeline = make_unique<PipelineInterestsFixed>(face, pipelineOpts);
+    }
+    else {
+      if (pipelineType == "aimd") {
+        adaptivePipeline = make_unique<PipelineInterestsAimd>(face, rttEstimator, pipelineOpts);
+      }
+      else if (pipelineType == "bbr") {
+        adaptivePipeline = make_unique<PipelineInterestsBbr>(face, rttEstimator, pipelineOpts);
+      }
+      else if (pipelineType == "ledbat") {
+        adaptivePipeline = make_unique<PipelineInterestsLedbat>(face, rttEstimator, pipelineOpts);
+      }
+      else {
+        adaptivePipeline = make_unique<PipelineInterestsCubic>(face, rttEstimator, pipelineOpts);
+      }
+
+      if (osCwnd != nullptr) {
+        adaptivePipeline->afterCwndChange.connect([=] (time::nanoseconds age, double cwnd) {
+          *osCwnd << pipelineType << ',' << age.count() / 1e9 << ',' << cwnd << '\n';
+        });
+      }
+      if (osRtt != nullptr) {
+        adaptivePipeline->afterRttMeasurement.connect([=] (const auto& sample) {
+          *osRtt << pipelineType << ',' << sample.segNum << ','
+                 << sample.rtt.count() / 1e6 << ',' << sample.rttVar.count() / 1e6 << ','
+                 << sample.sRtt.count() / 1e6 << ',' << sample.rto.count() / 1e6 << '\n';
+        });
+      }
+      pipeline = std::move(adaptivePipeline);
+    }
+
+    uint64_t nReceived = 0;
+    bool isDone = false;
+    auto start = time::steady_clock::now();
+    pipeline->run(prefix,
+      [&] (const Data& data) {
+        result.nReceivedBytes += data.getContent().value_size();
+        if (++nReceived == opts.nSegments) {
+          result.isComplete = isDone = true;
+          result.duration = time::steady_clock::now() - start;
+        }
+      },
+      [&] (const std::string& reason) {
+        std::cerr << "ERROR: " << pipelineType << " pipeline failed: " << reason << std::endl;
+        isDone = true;
+      });
+
+    while (!isDone && time::steady_clock::now() - start < opts.maxDuration) {
+      steadyClock->advance(opts.tick);
+      systemClock->advance(opts.tick);
+      if (io.stopped())
+        io.reset();
+      io.poll();
+    }
+    if (!result.isComplete) {
+      result.duration = time::steady_clock::now() - start;
+    }
+
+    pipeline->cancel();
+
+    result.nInterests = link.getNInterests();
+    result.nRetransmissions = link.getNRetransmissions();
+    result.nDrops = link.getNDrops();
+    result.nMarks = link.getNMarks();
+  }
+
+  time::setCustomClocks(nullptr, nullptr);
+  return result;
+}
+
+static void
+printHeader(std::ostream& os)
+{
+  os << "pipeline,bandwidth_mbps,delay_ms,queue_size,loss_rate,mark_threshold,segments,"
+        "segment_bytes,completed,seconds,goodput_mbps,interests,retransmissions,drops,marks\n";
+}
+
+static void
+printResult(std::ostream& os, const std::string& pipelineType, const BenchmarkOptions& opts,
+            const LinkOptions& linkOpts, const RunResult& result)
+{
+  double seconds = result.duration.count() / 1e9;
+  os << pipelineType << ',' << linkOpts.bandwidthMbps << ',' << linkOpts.delay.count() << ','
+     << linkOpts.queueSize << ',' << linkOpts.lossRate << ',' << linkOpts.markThreshold << ','
+     << opts.nSegments << ',' << opts.segmentSize << ','
+     << (result.isComplete ? "yes" : "no") << ',' << seconds << ','
+     << (seconds > 0 ? result.nReceivedBytes * 8 / seconds / 1e6 : 0.0) << ','
+     << result.nInterests << ',' << result.nRetransmissions << ','
+     << result.nDrops << ',' << result.nMarks << std::endl;
+}
+
+static std::vector<std::string>
+parseList(const std::string& str)
+{
+  std::vector<std::string> values;
+  std::istringstream is(str);
+  std::string item;
+  while (std::getline(is, item, ',')) {
+    if (!item.empty())
+      values.push_back(item);
+  }
+  return values;
+}
+
+/**
+ * @brief Open @p path for a CSV trace with @p header, unless it is empty
+ * @return false if the file cannot be opened
+ */
+static bool
+openTrace(std::ofstream& os, const std::string& path, const char* header)
+{
+  if (path.empty())
+    return true;
+
+  os.open(path);
+  if (os.fail()) {
+    std::cerr << "ERROR: failed to open " << path << std::endl;
+    return false;
+  }
+  os << header;
+  return true;
+}
+
+static int
+main(int argc, char* argv[])
+{
+  std::string programName(argv[0]);
+  BenchmarkOptions opts;
+  LinkOptions linkOpts;
+  Options pipelineOpts;
+  pipelineOpts.isQuiet = true;
+  std::string pipelineTypes("fixed,aimd,cubic"), outputPath, cwndPath, rttPath;
+  time::milliseconds::rep delay(linkOpts.delay.count());
+  time::microseconds::rep tick(opts.tick.count());
+  time::seconds::rep maxDuration(opts.maxDuration.count());
+  time::milliseconds::rep lifetime(pipelineOpts.interestLifetime.count());
+
+  po::options_description linkDesc("Emulated link options");
+  linkDesc.add_options()
+    ("bandwidth,b",    po::value<double>(&linkOpts.bandwidthMbps)->default_value(linkOpts.bandwidthMbps),
+                       "bottleneck bandwidth for Data, in Mbit/s")
+    ("delay,d",        po::value<time::milliseconds::rep>(&delay)->default_value(delay),
+                       "one-way propagation delay, in milliseconds")
+    ("queue-size,q",   po::value<size_t>(&linkOpts.queueSize)->default_value(linkOpts.queueSize),
+                       "bottleneck queue size, in Data packets")
+    ("loss-rate,l",    po::value<double>(&linkOpts.lossRate)->default_value(linkOpts.lossRate),
+                       "probability that a Data packet is lost at random")
+    ("mark-threshold", po::value<size_t>(&linkOpts.markThreshold)->default_value(linkOpts.markThreshold),
+                       "queue length from which Data is congestion-marked (0 never marks)")
+    ;
+
+  po::options_description runDesc("Transfer options");
+  runDesc.add_options()
+    ("pipeline-types,p", po::value<std::string>(&pipelineTypes)->default_value(pipelineTypes),
+                         "comma-separated list of pipelines to run; valid values are: "
+                         "'fixed', 'aimd', 'cubic', 'bbr', 'ledbat'")
+    ("segments,n",     po::value<uint64_t>(&opts.nSegments)->default_value(opts.nSegments),
+                       "number of segments to retrieve")
+    ("segment-size",   po::value<size_t>(&opts.segmentSize)->default_value(opts.segmentSize),
+                       "Data content size, in bytes")
+    ("lifetime",       po::value<time::milliseconds::rep>(&lifetime)->default_value(lifetime),
+                       "Interest lifetime, in milliseconds")
+    ("seed",           po::value<uint32_t>(&opts.seed)->default_value(opts.seed),
+                       "seed of the random losses, the same for every pipeline")
+    ("tick",           po::value<time::microseconds::rep>(&tick)->default_value(tick),
+                       "emulated clock granularity, in microseconds")
+    ("max-time",       po::value<time::seconds::rep>(&maxDuration)->default_value(maxDuration),
+                       "give up a transfer after this much emulated time, in seconds")
+    ;
+
+  po::options_description pipeDesc("Pipeline options");
+  pipeDesc.add_options()
+    ("pipeline-size,s", po::value<size_t>(&pipelineOpts.maxPipelineSize)->default_value(64),
+                        "size of the fixed pipeline")
+    ("init-cwnd",     po::value<double>(&pipelineOpts.initCwnd)->default_value(pipelineOpts.initCwnd),
+                      "initial congestion window in segments")
+    ("aimd-step",     po::value<double>(&pipelineOpts.aiStep)->default_value(pipelineOpts.aiStep),
+                      "additive-increase step")
+    ("aimd-beta",     po::value<double>(&pipelineOpts.mdCoef)->default_value(pipelineOpts.mdCoef),
+                      "multiplicative decrease factor (AIMD)")
+    ("cubic-beta",    po::value<double>(&pipelineOpts.cubicBeta)->default_value(pipelineOpts.cubicBeta),
+                      "window decrease factor (CUBIC)")
+    ("reorder-threshold", po::value<uint64_t>(&pipelineOpts.reorderThreshold)
+                            ->default_value(pipelineOpts.reorderThreshold),
+                          "gap that triggers a retransmission before the RTO (0 to disable)")
+    ("ignore-marks",  po::bool_switch(&pipelineOpts.ignoreCongMarks),
+                      "do not reduce the window after receiving a congestion mark")
+    ("proportional-marks", po::bool_switch(&pipelineOpts.proportionalMarks),
+                           "reduce the window in proportion to the fraction of marked Data (DCTCP)")
+    ("pacing",        po::bool_switch(&pipelineOpts.enablePacing),
+                      "pace the Interests of the adaptive pipelines over the smoothed RTT")
+    ;
+
+  po::options_description outputDesc("Output options");
+  outputDesc.add_options()
+    ("help,h",        "print this help message and exit")
+    ("output,o",      po::value<std::string>(&outputPath),
+                      "write the CSV report to this file instead of stdout")
+    ("log-cwnd",      po::value<std::string>(&cwndPath), "write a CSV trace of the congestion windows to this file")
+    ("log-rtt",       po::value<std::string>(&rttPath), "write a CSV trace of the RTT samples to this file")
+    ("version,V",     "print program version and exit")
+    ;
+
+  po::options_description visibleDesc;
+  visibleDesc.add(linkDesc).add(runDesc).add(pipeDesc).add(outputDesc);
+
+  po::variables_map vm;
+  try {
+    po::store(po::parse_command_line(argc, argv, visibleDesc), vm);
+    po::notify(vm);
+    opts.pipelineTypes = parseList(pipelineTypes);
+  }
+  catch (const po::error& e) {
+    std::cerr << "ERROR: " << e.what() << std::endl;
+    return 2;
+  }
+
+  if (vm.count("help") > 0) {
+    std::cout << "Usage: " << programName << " [options]\n"
+              << "\n"
+              << "Retrieve content over an emulated bottleneck link with each Interest pipeline and\n"
+              << "print a CSV report of goodput, retransmissions, drops and marks.\n"
+              << visibleDesc;
+    return 0;
+  }
+
+  if (vm.count("version") > 0) {
+    std::cout << "pipeline-benchmark " << tools::VERSION << std::endl;
+    return 0;
+  }
+
+  for (const auto& type : opts.pipelineTypes) {
+    if (type != "fixed" && type != "aimd" && type != "cubic" && type != "bbr" && type != "ledbat") {
+      std::cerr << "ERROR: unknown pipeline type '" << type << "'" << std::endl;
+      return 2;
+    }
+  }
+
+  if (linkOpts.bandwidthMbps <= 0 || delay < 0 || linkOpts.queueSize < 1 ||
+      linkOpts.lossRate < 0 || linkOpts.lossRate >= 1) {
+    std::cerr << "ERROR: bandwidth and queue size must be positive, delay cannot be negative, "
+                 "and loss rate must be in [0, 1)" << std::endl;
+    return 2;
+  }
+  linkOpts.delay = time::milliseconds(delay);
+
+  if (opts.nSegments < 1 || opts.segmentSize < 1 || opts.segmentSize > MAX_NDN_PACKET_SIZE >> 1) {
+    std::cerr << "ERROR: segments must be positive and segment size must be between 1 and "
+              << (MAX_NDN_PACKET_SIZE >> 1) << std::endl;
+    return 2;
+  }
+
+  if (tick < 1 || maxDuration < 1 || lifetime < 1) {
+    std::cerr << "ERROR: tick, max-time and lifetime must be positive" << std::endl;
+    return 2;
+  }
+  opts.tick = time::microseconds(tick);
+  opts.maxDuration = time::seconds(maxDuration);
+  pipelineOpts.interestLifetime = time::milliseconds(lifetime);
+
+  if (pipelineOpts.maxPipelineSize < 1 || pipelineOpts.maxPipelineSize > 65536) {
+    std::cerr << "ERROR: pipeline size must be between 1 and 65536" << std::endl;
+    return 2;
+  }
+
+  std::ofstream outputFile;
+  if (!outputPath.empty()) {
+    outputFile.open(outputPath);
+    if (outputFile.fail()) {
+      std::cerr << "ERROR: failed to open " << outputPath << std::endl;
+      return 4;
+    }
+  }
+  std::ostream& os = outputPath.empty() ? std::cout : outputFile;
+
+  std::ofstream cwndFile, rttFile;
+  if (!openTrace(cwndFile, cwndPath, "pipeline,time,cwnd\n") ||
+      !openTrace(rttFile, rttPath, "pipeline,segment,rtt,rttvar,srtt,rto\n")) {
+    return 4;
+  }
+
+  try {
+    printHeader(os);
+    for (const auto& type : opts.pipelineTypes) {
+      auto result = runPipeline(type, opts, linkOpts, pipelineOpts,
+                                cwndPath.empty() ? nullptr : &cwndFile,
+                                rttPath.empty() ? nullptr : &rttFile);
+      printResult(os, type, opts, linkOpts, result);
+    }
+  }
+  catch (const std::exception& e) {
+    std::cerr << "ERROR: " << e.what() << std::endl;
+    return 1;
+  }
+
+  return 0;
+}
+
+} // namespace chunks
+} // namespace ndn
+
+int
+main(int argc, char* argv[])
+{
+  return ndn::chunks::main(argc, argv);
+}
@@ -26,16 +26,96 @@
  */
 
 #include "consumer.hpp"
-#include "../crypto/data-enc-dec.hpp"
-#include "../crypto/rsa.hpp"
+#include "content-key-cache.hpp"
+
 namespace ndn {
 namespace chunks {
 
-Consumer::Consumer(security::v2::Validator& validator, std::ofstream& os)
+constexpr time::milliseconds Consumer::RESUME_CHECKPOINT_INTERVAL;
+
+Consumer::Consumer(security::v2::Validator& validator, AsyncWriter& writer)
   : m_validator(validator)
-  , m_outputStream(os)
-  , m_nextToPrint(0)
+  , m_writer(writer)
+{
+}
+
+Consumer::~Consumer() = default;
+
+void
+Consumer::setCompletionCallbacks(CompletionCallback onComplete, ErrorCallback onError)
+{
+  m_onComplete = std::move(onComplete);
+  m_onError = std::move(onError);
+}
+
+template<typename Function>
+void
+Consumer::reportErrors(const Function& f)
+{
+  try {
+    f();
+  }
+  catch (...) {
+    fail(std::current_exception());
+  }
+}
+
+void
+Consumer::setDecryptionKey(ContentKeyCache& contentKeys)
+{
+  // the key may arrive after this consumer is gone, if other consumers wait for it too
+  std::weak_ptr<bool> isAlive = m_isAlive;
+  m_decryptor = make_unique<ContentDecryptor>(contentKeys.getRecipientKey(), m_writer.getStream(),
+    [this, &contentKeys, isAlive] (const Name& ckName) {
+      contentKeys.get(ckName,
+        [this, isAlive] (const Buffer& aesKey) {
+          if (!isAlive.expired()) {
+            reportErrors([&] {
+              m_decryptor->setContentKey(aesKey);
+              checkCompletion();
+            });
+          }
+        },
+        [this, isAlive] (std::exception_ptr error) {
+          if (!isAlive.expired()) {
+            fail(error);
+          }
+        });
+    });
+}
+
+void
+Consumer::enablePositionalWrites()
+{
+  BOOST_ASSERT(m_decryptor == nullptr);
+  m_wantPositionalWrites = true;
+}
+
+void
+Consumer::enableResume(const std::string& statePath, optional<ResumeState> savedState)
+{
+  enablePositionalWrites();
+  m_resumeStatePath = statePath;
+  if (savedState) {
+    m_resumeState = std::move(*savedState);
+  }
+}
+
+void
+Consumer::setValidationPool(ValidationPool& pool)
+{
+  m_validationPool = &pool;
+}
+
+void
+Consumer::setMemoryLimit(size_t maxBufferedBytes, boost::asio::io_service& io)
 {
+  m_maxBufferedBytes = maxBufferedBytes;
+  m_io = &io;
+  if (maxBufferedBytes > 0) {
+    // memory kept for reuse counts towards the limit, keep a fraction of it at most
+    m_reorderBuffer.setMaxIdleBytes(maxBufferedBytes / 4);
+  }
 }
 
 void
@@ -43,48 +123,296 @@ Consumer::run(unique_ptr<DiscoverVersion> discover, unique_ptr<PipelineInterests
 {
   m_discover = std::move(discover);
   m_pipeline = std::move(pipeline);
-  m_nextToPrint = 0;
-  m_bufferedData.clear();
+  m_lastSegmentNo = nullopt;
+  m_reorderBuffer.clear();
+  m_segmentSize = nullopt;
+  m_unplacedSegments.clear();
+  m_isDone = false;
+  m_receivedSize = 0;
+  if (m_resumeStatePath.empty()) {
+    m_resumeState = ResumeState();
+  }
+
+  if (m_validationPool != nullptr) {
+    m_pipeline->setBackpressureCheck([this] { return m_validationPool->isBacklogged(); });
+  }
+  if (m_maxBufferedBytes > 0) {
+    std::weak_ptr<bool> isAlive = m_isAlive;
+    m_writer.setDrainCallback(*m_io, [this, isAlive] {
+      if (!isAlive.expired()) {
+        m_pipeline->resume();
+      }
+    });
+    m_pipeline->setThrottleCheck([this] { return isOverMemoryLimit(); });
+  }
 
   m_discover->onDiscoverySuccess.connect([this] (const Name& versionedName) {
-    m_pipeline->run(versionedName,
-      [this] (const Data& data) { handleData(data); },
-      [] (const std::string& msg) { NDN_THROW(std::runtime_error(msg)); });
+    reportErrors([&] {
+      if (!m_resumeStatePath.empty()) {
+        prepareResume(versionedName);
+        // an earlier retrieval may have written everything but the state file removal
+        checkCompletion();
+      }
+      const auto& firstSegment = m_discover->getFirstSegment();
+      bool hasFirstSegment = firstSegment && !m_resumeState.hasSegment(0);
+      if (hasFirstSegment) {
+        skipFirstSegment(*firstSegment);
+      }
+      m_pipeline->run(versionedName,
+        [this] (const Data& data) { reportErrors([&] { handleData(data); }); },
+        [this] (const std::string& msg) { fail(std::make_exception_ptr(std::runtime_error(msg))); });
+      if (hasFirstSegment) {
+        handleData(*firstSegment);
+      }
+    });
   });
-  m_discover->onDiscoveryFailure.connect([] (const std::string& msg) {
-    NDN_THROW(std::runtime_error(msg));
+  m_discover->onDiscoveryFailure.connect([this] (const std::string& msg) {
+    fail(std::make_exception_ptr(std::runtime_error(msg)));
   });
   m_discover->run();
 }
 
+void
+Consumer::fail(std::exception_ptr error)
+{
+  if (m_onError == nullptr) {
+    std::rethrow_exception(error);
+  }
+  if (m_isDone) {
+    return;
+  }
+
+  m_isDone = true;
+  m_pipeline->cancel();
+  m_onError(error);
+}
+
+void
+Consumer::checkCompletion()
+{
+  if (m_isDone || !m_lastSegmentNo) {
+    return;
+  }
+
+  if (m_wantPositionalWrites) {
+    if (m_resumeState.getNSegments() <= *m_lastSegmentNo) {
+      return;
+    }
+  }
+  else if (m_reorderBuffer.getNextSegment() <= *m_lastSegmentNo ||
+           (m_decryptor != nullptr && !m_decryptor->isFinished())) {
+    return;
+  }
+
+  m_isDone = true;
+  if (m_onComplete) {
+    m_onComplete();
+  }
+}
+
+bool
+Consumer::isOverMemoryLimit()
+{
+  auto isOver = [this] {
+    return m_reorderBuffer.getRetainedBytes() + m_writer.getPendingBytes() >= m_maxBufferedBytes;
+  };
+  if (!isOver()) {
+    return false;
+  }
+
+  // checking again after arming the writer closes the race with writes completing in between
+  m_writer.watchDrain();
+  return isOver();
+}
+
 void
 Consumer::handleData(const Data& data)
 {
-  auto dataPtr = data.shared_from_this();
+  auto onFailure = [this] (const Data&, const security::v2::ValidationError& error) {
+    reportErrors([&] { NDN_THROW(DataValidationError(error)); });
+  };
 
-  m_validator.validate(data,
-    [this, dataPtr] (const Data& data) {
-      if (data.getContentType() == ndn::tlv::ContentType_Nack) {
-        NDN_THROW(ApplicationNackError(data));
-      }
+  if (m_validationPool != nullptr) {
+    // results may come back out of order, they go through the same reordering as the packets;
+    // they are dropped if the consumer is gone by then
+    std::weak_ptr<bool> isAlive = m_isAlive;
+    m_validationPool->validate(data,
+      [this, isAlive] (const Data& data) {
+        if (!isAlive.expired()) {
+          reportErrors([&] { handleValidatedData(data); });
+        }
+      },
+      [onFailure, isAlive] (const Data& data, const security::v2::ValidationError& error) {
+        if (!isAlive.expired()) {
+          onFailure(data, error);
+        }
+      });
+  }
+  else {
+    m_validator.validate(data, [this] (const Data& data) { handleValidatedData(data); }, onFailure);
+  }
+}
 
-      // 'data' passed to callback comes from DataValidationState and was not created with make_shared
-      m_bufferedData[getSegmentFromPacket(data)] = dataPtr;
-      writeInOrderData();
-    },
-    [] (const Data&, const security::v2::ValidationError& error) {
-      NDN_THROW(DataValidationError(error));
-    });
+void
+Consumer::handleValidatedData(const Data& data)
+{
+  if (m_isDone) {
+    return;
+  }
+
+  if (data.getContentType() == ndn::tlv::ContentType_Nack) {
+    NDN_THROW(ApplicationNackError(data));
+  }
+
+  if (data.getFinalBlock()) {
+    m_lastSegmentNo = data.getFinalBlock()->toSegment();
+  }
+
+  uint64_t segNo = getSegmentFromPacket(data);
+  const Block& content = data.getContent();
+  m_receivedSize += content.value_size();
+  if (m_wantPositionalWrites) {
+    writeSegmentAtOffset(segNo, content.value(), content.value_size());
+  }
+  else if (segNo == m_reorderBuffer.getNextSegment()) {
+    // in-order segments are written straight from the packet
+    writeSegment(segNo, content.value(), content.value_size());
+    m_reorderBuffer.pop();
+    writeInOrderData();
+    // the missing segment may have been all that held the pipeline back
+    m_pipeline->resume();
+  }
+  else {
+    m_reorderBuffer.insert(segNo, content.value(), content.value_size());
+  }
+
+  checkCompletion();
 }
 
 void
 Consumer::writeInOrderData()
 {
-  for (auto it = m_bufferedData.begin();
-       it != m_bufferedData.end() && it->first == m_nextToPrint;
-       it = m_bufferedData.erase(it), ++m_nextToPrint) {
-    const Block& content = it->second->getContent();
-    m_outputStream.write(reinterpret_cast<const char*>(content.value()), content.value_size());
+  while (m_reorderBuffer.hasNext()) {
+    const Buffer& content = m_reorderBuffer.front();
+    writeSegment(m_reorderBuffer.getNextSegment(), content.data(), content.size());
+    m_reorderBuffer.pop();
+  }
+}
+
+void
+Consumer::writeSegment(uint64_t segNo, const uint8_t* buf, size_t size)
+{
+  if (m_decryptor == nullptr) {
+    m_writer.append(buf, size);
+    return;
+  }
+
+  m_decryptor->write(buf, size);
+  if (m_lastSegmentNo && *m_lastSegmentNo == segNo) {
+    m_decryptor->end();
+  }
+}
+
+void
+Consumer::writeSegmentAtOffset(uint64_t segNo, const uint8_t* buf, size_t size)
+{
+  if (!m_segmentSize) {
+    // the offset of a segment is only known once the size of a non-last segment is
+    bool isLast = m_lastSegmentNo && *m_lastSegmentNo == segNo;
+    if (!m_lastSegmentNo || (isLast && segNo > 0)) {
+      m_unplacedSegments.emplace_back(segNo, Buffer(buf, size));
+      return;
+    }
+
+    m_segmentSize = size;
+    m_writer.preallocate((*m_lastSegmentNo + 1) * *m_segmentSize);
+
+    auto unplaced = std::move(m_unplacedSegments);
+    m_unplacedSegments.clear();
+    for (const auto& segment : unplaced) {
+      writeSegmentAtOffset(segment.first, segment.second.data(), segment.second.size());
+    }
+  }
+
+  if (size != *m_segmentSize && segNo != *m_lastSegmentNo) {
+    NDN_THROW(std::runtime_error("Segment " + std::to_string(segNo) + " has " + std::to_string(size) +
+                                 " bytes instead of " + std::to_string(*m_segmentSize) +
+                                 ", cannot write segments at their offsets"));
+  }
+
+  // a segment can arrive twice, e.g. when its validation completes after a retransmission
+  // was sent, and must not count twice towards completion
+  if (m_resumeState.hasSegment(segNo)) {
+    return;
+  }
+
+  m_writer.write(segNo * *m_segmentSize, buf, size);
+  m_resumeState.lastSegmentNo = m_lastSegmentNo;
+  m_resumeState.addSegment(segNo);
+
+  if (!m_resumeStatePath.empty()) {
+    updateResumeState(segNo, size);
+  }
+}
+
+void
+Consumer::prepareResume(const Name& versionedName)
+{
+  m_lastCheckpoint = time::steady_clock::now();
+
+  if (m_resumeState.versionedName != versionedName || m_resumeState.getNSegments() == 0) {
+    // nothing retrieved yet, or a different version whose segments must all be overwritten
+    m_resumeState = ResumeState(versionedName);
+    return;
+  }
+
+  m_lastSegmentNo = m_resumeState.lastSegmentNo;
+  if (m_resumeState.segmentSize > 0 && m_lastSegmentNo) {
+    m_segmentSize = m_resumeState.segmentSize;
+    m_writer.preallocate((*m_lastSegmentNo + 1) * *m_segmentSize);
+  }
+  if (m_resumeState.fileSize) {
+    m_writer.setSize(*m_resumeState.fileSize);
+  }
+
+  m_pipeline->setReceivedSegments([this] (uint64_t segNo) { return m_resumeState.hasSegment(segNo); },
+                                  m_resumeState.getNSegments(), m_lastSegmentNo);
+}
+
+void
+Consumer::skipFirstSegment(const Data& data)
+{
+  optional<uint64_t> lastSegmentNo = m_lastSegmentNo;
+  if (data.getFinalBlock()) {
+    lastSegmentNo = data.getFinalBlock()->toSegment();
+  }
+
+  if (m_resumeState.getNSegments() == 0) {
+    m_pipeline->setReceivedSegments([] (uint64_t segNo) { return segNo == 0; }, 1, lastSegmentNo);
+    return;
+  }
+
+  // replaces the predicate set by prepareResume; segment 0 joins the resume state once written
+  m_pipeline->setReceivedSegments([this] (uint64_t segNo) {
+                                    return segNo == 0 || m_resumeState.hasSegment(segNo);
+                                  },
+                                  m_resumeState.getNSegments() + 1, lastSegmentNo);
+}
+
+void
+Consumer::updateResumeState(uint64_t segNo, size_t size)
+{
+  m_resumeState.segmentSize = *m_segmentSize;
+  if (segNo == *m_lastSegmentNo) {
+    m_resumeState.fileSize = segNo * *m_segmentSize + size;
+    m_writer.setSize(*m_resumeState.fileSize);
+  }
+
+  auto now = time::steady_clock::now();
+  if (now - m_lastCheckpoint >= RESUME_CHECKPOINT_INTERVAL) {
+    // the writer saves it only after the writes above are on storage
+    m_writer.checkpoint(m_resumeStatePath, m_resumeState.serialize());
+    m_lastCheckpoint = now;
   }
 }
 
@@ -28,15 +28,24 @@
 #ifndef NDN_TOOLS_CHUNKS_CATCHUNKS_CONSUMER_HPP
 #define NDN_TOOLS_CHUNKS_CATCHUNKS_CONSUMER_HPP
 
+#include "data-fetcher.hpp"
 #include "discover-version.hpp"
+#include "async-writer.hpp"
 #include "pipeline-interests.hpp"
-#include <fstream> 
+#include "reorder-buffer.hpp"
+#include "resume-state.hpp"
+#include "validation-pool.hpp"
+#include "../crypto/content-decryptor.hpp"
 #include <ndn-cxx/security/v2/validation-error.hpp>
 #include <ndn-cxx/security/v2/validator.hpp>
 
+#include <exception>
+
 namespace ndn {
 namespace chunks {
 
+class ContentKeyCache;
+
 /**
  * @brief Segmented version consumer
  *
@@ -69,9 +78,84 @@ public:
 
   /**
    * @brief Create the consumer
+   * @param writer receives the retrieved content; the caller closes it after the transfer
    */
   explicit
-  Consumer(security::v2::Validator& validator, std::ofstream& os);
+  Consumer(security::v2::Validator& validator, AsyncWriter& writer);
+
+  ~Consumer();
+
+  using CompletionCallback = std::function<void()>;
+  using ErrorCallback = std::function<void(std::exception_ptr error)>;
+
+  /**
+   * @brief Report the outcome of the retrieval through callbacks instead of exceptions
+   *
+   * Without an error callback, errors are thrown out of Face::processEvents(). Must be called
+   * before run().
+   * @param onComplete invoked once all the content has been handed to the writer
+   * @param onError invoked with the first error, after which the consumer stops retrieving
+   */
+  void
+  setCompletionCallbacks(CompletionCallback onComplete, ErrorCallback onError);
+
+  /**
+   * @brief Decrypt the content while it is written, instead of writing the ciphertext
+   *
+   * Must be called before run(). Content keys published separately from the content are
+   * obtained from @p contentKeys, which may be shared by several consumers and must outlive
+   * this one.
+   * @param contentKeys holds the recipient private key of the content encrypted with
+   *                    encryptDataContentWithCK or encryptDataContentWithLocator
+   */
+  void
+  setDecryptionKey(ContentKeyCache& contentKeys);
+
+  /**
+   * @brief Write every segment at its offset in the output file as soon as it arrives
+   *
+   * Replaces the reorder buffer. All segments but the last must have the same size, which is
+   * learned from the first such segment. Cannot be combined with setDecryptionKey(). Must be
+   * called before run().
+   */
+  void
+  enablePositionalWrites();
+
+  /**
+   * @brief Keep track of the segments written to the output file in @p statePath
+   *
+   * The state is saved every RESUME_CHECKPOINT_INTERVAL, once the segments it lists are on
+   * storage. If @p savedState is for the version being retrieved, the segments it lists are
+   * not retrieved again. Implies positional writes. Must be called before run().
+   */
+  void
+  enableResume(const std::string& statePath, optional<ResumeState> savedState);
+
+  /**
+   * @brief Validate segments on the workers of @p pool instead of the event loop
+   *
+   * The pipeline stops growing its window while the pool is backlogged. Content keys are
+   * still validated by the validator given to the constructor. Must be called before run().
+   */
+  void
+  setValidationPool(ValidationPool& pool);
+
+  /**
+   * @brief Stop requesting new segments while the reorder buffer and the writer together hold
+   *        @p maxBufferedBytes
+   *
+   * Segments received after a missing one wait in the reorder buffer until it arrives, and
+   * written segments wait in the writer until storage catches up, both of which take more and
+   * more memory as long as the pipeline keeps requesting new segments. With a limit, only
+   * retransmissions are sent while it is reached, lowest segment first, so the memory never
+   * exceeds it by more than the segments already in flight. The memory the reorder buffer keeps
+   * for reuse counts towards the limit, and is bounded to a quarter of it. Must be called before
+   * run().
+   * @param maxBufferedBytes maximum content size, in bytes, or 0 for no limit
+   * @param io io_service on which the writer reports that storage caught up
+   */
+  void
+  setMemoryLimit(size_t maxBufferedBytes, boost::asio::io_service& io);
 
   /**
    * @brief Run the consumer
@@ -79,23 +163,101 @@ public:
   void
   run(unique_ptr<DiscoverVersion> discover, unique_ptr<PipelineInterests> pipeline);
 
+  /**
+   * @brief Size of the content received so far, in bytes
+   */
+  uint64_t
+  getReceivedSize() const
+  {
+    return m_receivedSize;
+  }
+
 private:
   void
   handleData(const Data& data);
 
+  void
+  handleValidatedData(const Data& data);
+
+  /**
+   * @brief Invoke @p f, handing whatever it throws to fail()
+   */
+  template<typename Function>
+  void
+  reportErrors(const Function& f);
+
+  /**
+   * @brief Stop the retrieval and pass @p error to the error callback, or rethrow it
+   */
+  void
+  fail(std::exception_ptr error);
+
+  /**
+   * @brief Invoke the completion callback if all the content has been written
+   */
+  void
+  checkCompletion();
+
+  /**
+   * @brief Whether the content held in memory reached the limit set by setMemoryLimit()
+   */
+  bool
+  isOverMemoryLimit();
+
+  /**
+   * @brief Restore the progress of an earlier retrieval of @p versionedName, if any
+   */
+  void
+  prepareResume(const Name& versionedName);
+
+  void
+  updateResumeState(uint64_t segNo, size_t size);
+
+  /**
+   * @brief Keep the pipeline from requesting segment 0, which arrived with the version
+   */
+  void
+  skipFirstSegment(const Data& data);
+
 PUBLIC_WITH_TESTS_ELSE_PRIVATE:
   void
   writeInOrderData();
 
+  void
+  writeSegment(uint64_t segNo, const uint8_t* buf, size_t size);
+
+  void
+  writeSegmentAtOffset(uint64_t segNo, const uint8_t* buf, size_t size);
+
 private:
   security::v2::Validator& m_validator;
-  std::ofstream& m_outputStream;
+  ValidationPool* m_validationPool = nullptr;
+  AsyncWriter& m_writer;
   unique_ptr<DiscoverVersion> m_discover;
   unique_ptr<PipelineInterests> m_pipeline;
-  uint64_t m_nextToPrint;
+  optional<uint64_t> m_lastSegmentNo;
+  unique_ptr<ContentDecryptor> m_decryptor;
+  CompletionCallback m_onComplete;
+  ErrorCallback m_onError;
+  bool m_isDone = false;
+  uint64_t m_receivedSize = 0;
+  size_t m_maxBufferedBytes = 0;   ///< 0 if the memory is not limited
+  boost::asio::io_service* m_io = nullptr;
+  shared_ptr<bool> m_isAlive = make_shared<bool>(true); ///< observed by pending validations
+
+  bool m_wantPositionalWrites = false;
+  optional<size_t> m_segmentSize;
+  std::vector<std::pair<uint64_t, Buffer>> m_unplacedSegments; ///< received before m_segmentSize
+
+  std::string m_resumeStatePath; ///< empty if resuming is disabled
+  ResumeState m_resumeState; ///< segments written at their offset, including resumed ones,
+                             ///< also kept when resuming is disabled
+  time::steady_clock::TimePoint m_lastCheckpoint;
 
 PUBLIC_WITH_TESTS_ELSE_PRIVATE:
-  std::map<uint64_t, shared_ptr<const Data>> m_bufferedData;
+  ReorderBuffer m_reorderBuffer;
+
+  static constexpr time::milliseconds RESUME_CHECKPOINT_INTERVAL = 1_s;
 };
 
 } // namespace chunks
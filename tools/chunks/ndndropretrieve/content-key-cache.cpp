@@ -0,0 +1,137 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016-2019, Regents of the University of California,
+ *                          Colorado State University,
+ *                          University Pierre & Marie Curie, Sorbonne University.
+ *
+ * This file is part of ndn-tools (Named Data Networking Essential Tools).
+ * See AUTHORS.md for complete list of ndn-tools authors and contributors.
+ *
+ * ndn-tools is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-tools is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-tools, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "content-key-cache.hpp"
+#include "consumer.hpp"
+#include "../crypto/data-enc-dec.hpp"
+
+namespace ndn {
+namespace chunks {
+
+ContentKeyCache::ContentKeyCache(Face& face, security::v2::Validator& validator, Buffer recipientKey,
+                                 const Options& options)
+  : m_face(face)
+  , m_validator(validator)
+  , m_recipientKey(std::move(recipientKey))
+  , m_options(options)
+{
+}
+
+ContentKeyCache::~ContentKeyCache()
+{
+  for (auto& entry : m_entries) {
+    if (entry.second.fetcher != nullptr) {
+      entry.second.fetcher->cancel();
+    }
+  }
+}
+
+void
+ContentKeyCache::get(const Name& ckName, KeyCallback onKey, ErrorCallback onError)
+{
+  auto it = m_entries.find(ckName);
+  if (it != m_entries.end() && !it->second.aesKey.empty()) {
+    onKey(it->second.aesKey);
+    return;
+  }
+
+  bool isFetching = it != m_entries.end();
+  m_entries[ckName].waiters.emplace_back(std::move(onKey), std::move(onError));
+  if (!isFetching) {
+    fetch(ckName);
+  }
+}
+
+void
+ContentKeyCache::fetch(const Name& ckName)
+{
+  if (m_options.isVerbose)
+    std::cerr << "Fetching content key " << ckName << std::endl;
+
+  Interest interest(ckName);
+  interest.setCanBePrefix(false);
+  interest.setMustBeFresh(m_options.mustBeFresh);
+  interest.setInterestLifetime(m_options.interestLifetime);
+
+  auto onFailure = [this] (const Interest& interest, const std::string& reason) {
+    fail(interest.getName(), std::make_exception_ptr(std::runtime_error(
+      "Failed to fetch content key " + interest.getName().toUri() + ": " + reason)));
+  };
+
+  auto onData = [this] (const Interest&, const Data& data) {
+    m_validator.validate(data,
+      [this] (const Data& data) { onKeyPacket(data); },
+      [this] (const Data& data, const security::v2::ValidationError& error) {
+        fail(data.getName(), std::make_exception_ptr(Consumer::DataValidationError(error)));
+      });
+  };
+
+  m_entries[ckName].fetcher = DataFetcher::fetch(m_face, interest,
+                                                 m_options.maxRetriesOnTimeoutOrNack,
+                                                 m_options.maxRetriesOnTimeoutOrNack,
+                                                 onData, onFailure, onFailure, m_options.isVerbose);
+}
+
+void
+ContentKeyCache::onKeyPacket(const Data& data)
+{
+  auto it = m_entries.find(data.getName());
+  if (it == m_entries.end()) {
+    return;
+  }
+
+  Buffer aesKey;
+  try {
+    const Block& content = data.getContent();
+    content.parse();
+    aesKey = unwrapContentKey(content, m_recipientKey.data(), m_recipientKey.size());
+  }
+  catch (const std::exception&) {
+    return fail(data.getName(), std::current_exception());
+  }
+
+  Entry& entry = it->second;
+  entry.aesKey = std::move(aesKey);
+  entry.fetcher = nullptr;
+  auto waiters = std::move(entry.waiters);
+  entry.waiters.clear();
+  for (const auto& waiter : waiters) {
+    waiter.first(entry.aesKey);
+  }
+}
+
+void
+ContentKeyCache::fail(const Name& ckName, std::exception_ptr error)
+{
+  auto it = m_entries.find(ckName);
+  if (it == m_entries.end()) {
+    return;
+  }
+
+  auto waiters = std::move(it->second.waiters);
+  m_entries.erase(it);
+  for (const auto& waiter : waiters) {
+    waiter.second(error);
+  }
+}
+
+} // namespace chunks
+} // namespace ndn
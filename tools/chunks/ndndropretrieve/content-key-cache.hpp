@@ -0,0 +1,107 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016-2019, Regents of the University of California,
+ *                          Colorado State University,
+ *                          University Pierre & Marie Curie, Sorbonne University.
+ *
+ * This file is part of ndn-tools (Named Data Networking Essential Tools).
+ * See AUTHORS.md for complete list of ndn-tools authors and contributors.
+ *
+ * ndn-tools is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-tools is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-tools, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NDN_TOOLS_CHUNKS_CATCHUNKS_CONTENT_KEY_CACHE_HPP
+#define NDN_TOOLS_CHUNKS_CATCHUNKS_CONTENT_KEY_CACHE_HPP
+
+#include "data-fetcher.hpp"
+#include "options.hpp"
+
+#include <ndn-cxx/security/v2/validator.hpp>
+
+#include <exception>
+#include <map>
+
+namespace ndn {
+namespace chunks {
+
+/**
+ * @brief Fetches and unwraps the content keys that encrypted content refers to by name
+ *
+ * Content published with a shared content key carries a CK_LOCATOR instead of the wrapped key.
+ * The cache fetches the key packet the first time a name is requested, validates it, unwraps it
+ * with the recipient private key and keeps the AES key for later requests, so that the files of
+ * a batch sharing a key cost one fetch and one public key operation in total. Requests made
+ * while the key is on its way wait for the same fetch. A failed fetch is reported to all the
+ * waiting requests and forgotten, so a later request tries again.
+ */
+class ContentKeyCache : noncopyable
+{
+public:
+  using KeyCallback = std::function<void(const Buffer& aesKey)>;
+  using ErrorCallback = std::function<void(std::exception_ptr error)>;
+
+  /**
+   * @param validator validates the key packets
+   * @param recipientKey private key the content keys are wrapped for, also the key of content
+   *                     that embeds its wrapped key
+   */
+  ContentKeyCache(Face& face, security::v2::Validator& validator, Buffer recipientKey,
+                  const Options& options);
+
+  ~ContentKeyCache();
+
+  const Buffer&
+  getRecipientKey() const
+  {
+    return m_recipientKey;
+  }
+
+  /**
+   * @brief Obtain the AES key carried by the key packet @p ckName
+   *
+   * @p onKey is invoked before get() returns if the key is already known. Callers that may be
+   * destroyed before a pending fetch completes must make their callbacks check for it.
+   * @param onError invoked with Consumer::DataValidationError if the key packet fails
+   *                validation, or another exception if it cannot be fetched or unwrapped
+   */
+  void
+  get(const Name& ckName, KeyCallback onKey, ErrorCallback onError);
+
+private:
+  void
+  fetch(const Name& ckName);
+
+  void
+  onKeyPacket(const Data& data);
+
+  void
+  fail(const Name& ckName, std::exception_ptr error);
+
+private:
+  struct Entry
+  {
+    Buffer aesKey;      ///< empty until the key packet has been unwrapped
+    std::vector<std::pair<KeyCallback, ErrorCallback>> waiters;
+    shared_ptr<DataFetcher> fetcher;
+  };
+
+  Face& m_face;
+  security::v2::Validator& m_validator;
+  const Buffer m_recipientKey;
+  const Options& m_options;
+  std::map<Name, Entry> m_entries;
+};
+
+} // namespace chunks
+} // namespace ndn
+
+#endif // NDN_TOOLS_CHUNKS_CATCHUNKS_CONTENT_KEY_CACHE_HPP
@@ -54,7 +54,8 @@ DataFetcher::DataFetcher(Face& face, int maxNackRetries, int maxTimeoutRetries,
                          DataCallback onData, FailureCallback onNack, FailureCallback onTimeout,
                          bool isVerbose)
   : m_face(face)
-  , m_scheduler(m_face.getIoService())
+  , m_ownScheduler(make_unique<Scheduler>(m_face.getIoService()))
+  , m_scheduler(*m_ownScheduler)
   , m_onData(std::move(onData))
   , m_onNack(std::move(onNack))
   , m_onTimeout(std::move(onTimeout))
@@ -70,13 +71,45 @@ DataFetcher::DataFetcher(Face& face, int maxNackRetries, int maxTimeoutRetries,
   BOOST_ASSERT(m_onData != nullptr);
 }
 
+DataFetcher::DataFetcher(Face& face, Scheduler& scheduler, int maxNackRetries, int maxTimeoutRetries,
+                         DataCallback onData, FailureCallback onTimeout, FailureCallback onNack,
+                         bool isVerbose)
+  : m_face(face)
+  , m_scheduler(scheduler)
+  , m_onData(std::move(onData))
+  , m_onNack(std::move(onNack))
+  , m_onTimeout(std::move(onTimeout))
+  , m_maxNackRetries(maxNackRetries)
+  , m_maxTimeoutRetries(maxTimeoutRetries)
+  , m_nNacks(0)
+  , m_nTimeouts(0)
+  , m_nCongestionRetries(0)
+  , m_isVerbose(isVerbose)
+  , m_isStopped(true)
+  , m_hasError(false)
+{
+  BOOST_ASSERT(m_onData != nullptr);
+}
+
+void
+DataFetcher::restart(const Interest& interest)
+{
+  cancel();
+
+  m_nNacks = 0;
+  m_nTimeouts = 0;
+  m_isStopped = false;
+  m_hasError = false;
+  expressInterest(interest, nullptr);
+}
+
 void
 DataFetcher::cancel()
 {
   if (isRunning()) {
     m_isStopped = true;
     m_pendingInterest.cancel();
-    m_scheduler.cancelAllEvents();
+    m_retryEvent.cancel();
   }
 }
 
@@ -132,7 +165,7 @@ DataFetcher::handleNack(const Interest& interest, const lp::Nack& nack,
         else {
           m_nCongestionRetries++;
         }
-        m_scheduler.schedule(backoffTime, [=] { expressInterest(newInterest, self); });
+        m_retryEvent = m_scheduler.schedule(backoffTime, [=] { expressInterest(newInterest, self); });
         break;
       }
       default: {
@@ -45,6 +45,8 @@ namespace chunks {
  * can be different for timeout and nack. The data callback must be defined but the others callback
  * are optional.
  *
+ * A DataFetcher can also be owned by the caller and reused for a sequence of Interests through
+ * restart(), which avoids allocating a fetcher and its callbacks for each of them.
  */
 class DataFetcher
 {
@@ -72,6 +74,24 @@ public:
         DataCallback onData, FailureCallback onTimeout, FailureCallback onNack,
         bool isVerbose);
 
+  /**
+   * @brief create an idle DataFetcher that fetches Data each time restart() is called
+   *
+   * The caller must keep the object alive, or cancel it, while an Interest is pending.
+   * Backoff timers are scheduled on @p scheduler, which may be shared by several fetchers.
+   */
+  DataFetcher(Face& face, Scheduler& scheduler, int maxNackRetries, int maxTimeoutRetries,
+              DataCallback onData, FailureCallback onTimeout, FailureCallback onNack,
+              bool isVerbose);
+
+  /**
+   * @brief stop any ongoing fetch and start fetching data for @p interest
+   *
+   * The retry counters are reset, as if the fetcher had just been created.
+   */
+  void
+  restart(const Interest& interest);
+
   /**
    * @brief stop data fetching without error and calling any callback
    */
@@ -109,8 +129,10 @@ private:
 
 private:
   Face& m_face;
-  Scheduler m_scheduler;
+  unique_ptr<Scheduler> m_ownScheduler; ///< only set for fetchers created by fetch()
+  Scheduler& m_scheduler;
   PendingInterestHandle m_pendingInterest;
+  scheduler::ScopedEventId m_retryEvent;
   DataCallback m_onData;
   FailureCallback m_onNack;
   FailureCallback m_onTimeout;
@@ -56,12 +56,25 @@ DiscoverVersion::run()
                                  m_options.maxRetriesOnTimeoutOrNack, m_options.maxRetriesOnTimeoutOrNack,
                                  bind(&DiscoverVersion::handleData, this, _1, _2),
                                  [this] (const Interest&, const std::string& reason) {
-                                   onDiscoveryFailure(reason);
+                                   handleMetadataFailure(reason);
                                  },
                                  [this] (const Interest&, const std::string& reason) {
-                                   onDiscoveryFailure(reason);
+                                   handleMetadataFailure(reason);
                                  },
                                  m_options.isVerbose);
+
+  // the producer answers an Interest for the bare prefix with segment 0 of its latest version;
+  // a single attempt is enough, the metadata Interest remains the authoritative path
+  Interest firstSegmentInterest(m_prefix);
+  firstSegmentInterest.setCanBePrefix(true);
+  firstSegmentInterest.setMustBeFresh(true);
+  firstSegmentInterest.setInterestLifetime(m_options.interestLifetime);
+
+  m_isSpeculating = true;
+  m_firstSegmentInterest = m_face.expressInterest(firstSegmentInterest,
+    [this] (const Interest&, const Data& data) { handleFirstSegment(data); },
+    [this] (const Interest&, const lp::Nack&) { stopSpeculation(); },
+    [this] (const Interest&) { stopSpeculation(); });
 }
 
 void
@@ -76,12 +89,12 @@ DiscoverVersion::handleData(const Interest& interest, const Data& data)
     mobject = MetadataObject(data);
   }
   catch (const tlv::Error& e) {
-    onDiscoveryFailure("Invalid metadata packet: "s + e.what());
+    handleMetadataFailure("Invalid metadata packet: "s + e.what());
     return;
   }
 
   if (mobject.getVersionedName().empty() || !mobject.getVersionedName()[-1].isVersion()) {
-    onDiscoveryFailure(mobject.getVersionedName().toUri() + " is not a valid versioned name");
+    handleMetadataFailure(mobject.getVersionedName().toUri() + " is not a valid versioned name");
     return;
   }
 
@@ -89,8 +102,53 @@ DiscoverVersion::handleData(const Interest& interest, const Data& data)
     std::cerr << "Discovered Data version: " << mobject.getVersionedName()[-1] << std::endl;
   }
 
+  // the pipeline's own Interest for segment 0 is still answered if the segment is in flight
+  m_firstSegmentInterest.cancel();
+  m_isSpeculating = false;
   onDiscoverySuccess(mobject.getVersionedName());
 }
 
+void
+DiscoverVersion::handleFirstSegment(const Data& data)
+{
+  const Name& name = data.getName();
+  if (name.size() != m_prefix.size() + 2 || !name[-2].isVersion() ||
+      !name[-1].isSegment() || name[-1].toSegment() != 0) {
+    // not the segmented content this tool retrieves, leave the decision to the metadata
+    stopSpeculation();
+    return;
+  }
+
+  m_isSpeculating = false;
+  m_fetcher->cancel();
+
+  if (m_options.isVerbose) {
+    std::cerr << "Data: " << data << std::endl;
+    std::cerr << "Discovered Data version: " << name[-2] << std::endl;
+  }
+
+  m_firstSegment = data;
+  onDiscoverySuccess(name.getPrefix(-1));
+}
+
+void
+DiscoverVersion::handleMetadataFailure(const std::string& reason)
+{
+  if (m_isSpeculating) {
+    m_metadataFailure = reason;
+    return;
+  }
+  onDiscoveryFailure(reason);
+}
+
+void
+DiscoverVersion::stopSpeculation()
+{
+  m_isSpeculating = false;
+  if (m_metadataFailure) {
+    onDiscoveryFailure(*m_metadataFailure);
+  }
+}
+
 } // namespace chunks
 } // namespace ndn
@@ -41,6 +41,11 @@ class DataFetcher;
  *
  * DiscoverVersion's user is notified once after identifying the latest retrievable version or
  * on failure to find any Data version.
+ *
+ * Alongside the metadata Interest, an Interest for the unversioned prefix with CanBePrefix is
+ * sent, which the producer answers with segment 0 of its latest version. Whichever answer comes
+ * first determines the version; when it is the segment, it is kept for getFirstSegment() and
+ * the retrieval does not have to request it again.
  */
 class DiscoverVersion
 {
@@ -64,15 +69,39 @@ public:
   void
   run();
 
+  /**
+   * @brief segment 0 of the discovered version, if it arrived before the metadata
+   *
+   * Set when onDiscoverySuccess is emitted.
+   */
+  const optional<Data>&
+  getFirstSegment() const
+  {
+    return m_firstSegment;
+  }
+
 private:
   void
   handleData(const Interest& interest, const Data& data);
 
+  void
+  handleFirstSegment(const Data& data);
+
+  void
+  handleMetadataFailure(const std::string& reason);
+
+  void
+  stopSpeculation();
+
 private:
   Face& m_face;
   const Name m_prefix;
   const Options& m_options;
   shared_ptr<DataFetcher> m_fetcher;
+  ScopedPendingInterestHandle m_firstSegmentInterest;
+  optional<Data> m_firstSegment;
+  bool m_isSpeculating = false;
+  optional<std::string> m_metadataFailure; ///< reported once the speculative Interest fails too
 };
 
 } // namespace chunks
@@ -0,0 +1,129 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016-2019, Regents of the University of California,
+ *                          Colorado State University,
+ *                          University Pierre & Marie Curie, Sorbonne University.
+ *
+ * This file is part of ndn-tools (Named Data Networking Essential Tools).
+ * See AUTHORS.md for complete list of ndn-tools authors and contributors.
+ *
+ * ndn-tools is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-tools is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-tools, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "interest-template.hpp"
+
+#include <ndn-cxx/delegation-list.hpp>
+#include <ndn-cxx/encoding/encoding-buffer.hpp>
+#include <ndn-cxx/util/random.hpp>
+
+#include <cstring>
+
+namespace ndn {
+namespace chunks {
+
+static uint8_t*
+writeVarNumber(uint8_t* pos, uint64_t number)
+{
+  size_t size = tlv::sizeOfVarNumber(number);
+  if (size == 1) {
+    *pos++ = static_cast<uint8_t>(number);
+    return pos;
+  }
+
+  *pos++ = size == 3 ? 253 : size == 5 ? 254 : 255;
+  for (size_t i = size - 1; i > 0; --i) {
+    *pos++ = static_cast<uint8_t>(number >> (8 * (i - 1)));
+  }
+  return pos;
+}
+
+static uint8_t*
+writeNonNegativeInteger(uint8_t* pos, uint64_t integer)
+{
+  for (size_t i = tlv::sizeOfNonNegativeInteger(integer); i > 0; --i) {
+    *pos++ = static_cast<uint8_t>(integer >> (8 * (i - 1)));
+  }
+  return pos;
+}
+
+InterestTemplate::InterestTemplate(const Name& prefix, bool mustBeFresh, time::milliseconds lifetime,
+                                   const Name& forwardingHint)
+{
+  const Block& nameWire = prefix.wireEncode();
+  m_nameValue.assign(nameWire.value_begin(), nameWire.value_end());
+
+  // the segment number is the last byte of the component value, whatever the convention
+  auto segment = name::Component::fromSegment(0);
+  m_segmentType = segment.type();
+  m_segmentMarker.assign(segment.value_begin(), segment.value_end() - 1);
+
+  EncodingBuffer hintEncoder;
+  if (!forwardingHint.empty()) {
+    DelegationList{{0, forwardingHint}}.wireEncode(hintEncoder, tlv::ForwardingHint);
+  }
+
+  uint64_t lifetimeMs = static_cast<uint64_t>(lifetime.count());
+  m_tail.resize((mustBeFresh ? 2 : 0) + hintEncoder.size() + 2 + 4 + 2 +
+                tlv::sizeOfNonNegativeInteger(lifetimeMs));
+  uint8_t* pos = m_tail.data();
+  if (mustBeFresh) {
+    pos = writeVarNumber(pos, tlv::MustBeFresh);
+    pos = writeVarNumber(pos, 0);
+  }
+  pos = std::copy(hintEncoder.begin(), hintEncoder.end(), pos);
+  pos = writeVarNumber(pos, tlv::Nonce);
+  pos = writeVarNumber(pos, 4);
+  m_nonceOffset = pos - m_tail.data();
+  pos += 4;
+  pos = writeVarNumber(pos, tlv::InterestLifetime);
+  pos = writeVarNumber(pos, tlv::sizeOfNonNegativeInteger(lifetimeMs));
+  pos = writeNonNegativeInteger(pos, lifetimeMs);
+  BOOST_ASSERT(pos == m_tail.data() + m_tail.size());
+}
+
+Interest
+InterestTemplate::make(uint64_t segNo) const
+{
+  BOOST_ASSERT(m_segmentType != 0);
+
+  size_t segmentValueSize = m_segmentMarker.size() + tlv::sizeOfNonNegativeInteger(segNo);
+  size_t segmentSize = tlv::sizeOfVarNumber(m_segmentType) + tlv::sizeOfVarNumber(segmentValueSize) +
+                       segmentValueSize;
+  size_t nameValueSize = m_nameValue.size() + segmentSize;
+  size_t nameSize = tlv::sizeOfVarNumber(tlv::Name) + tlv::sizeOfVarNumber(nameValueSize) +
+                    nameValueSize;
+  size_t interestValueSize = nameSize + m_tail.size();
+
+  auto wire = make_shared<Buffer>(tlv::sizeOfVarNumber(tlv::Interest) +
+                                  tlv::sizeOfVarNumber(interestValueSize) + interestValueSize);
+  uint8_t* pos = wire->data();
+  pos = writeVarNumber(pos, tlv::Interest);
+  pos = writeVarNumber(pos, interestValueSize);
+  pos = writeVarNumber(pos, tlv::Name);
+  pos = writeVarNumber(pos, nameValueSize);
+  pos = std::copy(m_nameValue.begin(), m_nameValue.end(), pos);
+  pos = writeVarNumber(pos, m_segmentType);
+  pos = writeVarNumber(pos, segmentValueSize);
+  pos = std::copy(m_segmentMarker.begin(), m_segmentMarker.end(), pos);
+  pos = writeNonNegativeInteger(pos, segNo);
+  uint8_t* tail = pos;
+  pos = std::copy(m_tail.begin(), m_tail.end(), pos);
+  BOOST_ASSERT(pos == wire->data() + wire->size());
+
+  uint32_t nonce = random::generateWord32();
+  std::memcpy(tail + m_nonceOffset, &nonce, sizeof(nonce));
+
+  return Interest(Block(std::move(wire)));
+}
+
+} // namespace chunks
+} // namespace ndn
@@ -0,0 +1,71 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016-2019, Regents of the University of California,
+ *                          Colorado State University,
+ *                          University Pierre & Marie Curie, Sorbonne University.
+ *
+ * This file is part of ndn-tools (Named Data Networking Essential Tools).
+ * See AUTHORS.md for complete list of ndn-tools authors and contributors.
+ *
+ * ndn-tools is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-tools is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-tools, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NDN_TOOLS_CHUNKS_CATCHUNKS_INTEREST_TEMPLATE_HPP
+#define NDN_TOOLS_CHUNKS_CATCHUNKS_INTEREST_TEMPLATE_HPP
+
+#include "core/common.hpp"
+
+namespace ndn {
+namespace chunks {
+
+/**
+ * @brief Pre-encoded Interest for the segments of one versioned prefix
+ *
+ * The prefix, MustBeFresh, the forwarding hint and the lifetime are encoded once. make() writes
+ * the segment component and a fresh Nonce around them into a single buffer, so sending an
+ * Interest neither copies the prefix Name nor runs the ndn-cxx encoder. The Interest keeps the
+ * buffer, which therefore cannot be shared with the next one.
+ *
+ * The segment component follows the naming convention in effect when the template is created.
+ */
+class InterestTemplate
+{
+public:
+  /**
+   * @brief Create an empty template; make() may only be called after assigning a real one
+   */
+  InterestTemplate() = default;
+
+  /**
+   * @param forwardingHint delegation the Interests carry, none if empty
+   */
+  InterestTemplate(const Name& prefix, bool mustBeFresh, time::milliseconds lifetime,
+                   const Name& forwardingHint = Name());
+
+  /**
+   * @brief Interest for segment @p segNo of the prefix, with CanBePrefix=false and a random Nonce
+   */
+  Interest
+  make(uint64_t segNo) const;
+
+private:
+  Buffer m_nameValue;          ///< encoded components of the prefix
+  Buffer m_segmentMarker;      ///< leading bytes of the segment component value, if any
+  uint32_t m_segmentType = 0;  ///< TLV type of the segment component
+  Buffer m_tail;               ///< elements that follow the Name, including a Nonce placeholder
+  size_t m_nonceOffset = 0;    ///< offset of the Nonce value in m_tail
+};
+
+} // namespace chunks
+} // namespace ndn
+
+#endif // NDN_TOOLS_CHUNKS_CATCHUNKS_INTEREST_TEMPLATE_HPP
@@ -29,37 +29,91 @@
  * @author Chavoosh Ghasemi
  */
 
+#include "batch-consumer.hpp"
 #include "consumer.hpp"
+#include "content-key-cache.hpp"
 #include "discover-version.hpp"
 #include "pipeline-interests-aimd.hpp"
+#include "pipeline-interests-bbr.hpp"
 #include "pipeline-interests-cubic.hpp"
 #include "pipeline-interests-fixed.hpp"
+#include "pipeline-interests-ledbat.hpp"
+#include "pipeline-interests-multi-source.hpp"
+#include "resume-state.hpp"
 #include "statistics-collector.hpp"
 #include "core/version.hpp"
 
+#include <boost/algorithm/string/trim.hpp>
+#include <cstdio>
 #include <fstream>
+#include <iterator>
+#include <unistd.h>
 #include <ndn-cxx/security/validator-null.hpp>
+#include <ndn-cxx/security/v2/certificate-fetcher-offline.hpp>
+#include <ndn-cxx/security/v2/validation-policy-accept-all.hpp>
 
 namespace ndn {
 namespace chunks {
 
+/**
+ * @brief Name of the output file for @p uri, which is its last component
+ */
+static std::string
+getOutputFileName(std::string uri)
+{
+  std::string delimiter = "/";
+  size_t pos = 0;
+  while ((pos = uri.find(delimiter)) != std::string::npos) {
+    uri.erase(0, pos + delimiter.length());
+  }
+  return uri;
+}
+
+/**
+ * @brief Read one item per line of @p is, skipping empty lines and lines starting with '#'
+ *
+ * Each line is turned into a name and an output file name by @p makeItem.
+ */
+template<typename MakeItem>
+static std::vector<BatchConsumer::Item>
+readBatchItems(std::istream& is, const MakeItem& makeItem)
+{
+  std::vector<BatchConsumer::Item> items;
+  std::string line;
+  while (std::getline(is, line)) {
+    boost::algorithm::trim(line);
+    if (!line.empty() && line[0] != '#') {
+      items.push_back(makeItem(line));
+    }
+  }
+  return items;
+}
+
 static int
 main(int argc, char* argv[])
 {
   std::string programName(argv[0]);
 
   Options options;
-  std::string uri, pipelineType("cubic"), cwndPath, rttPath;
+  std::string uri, pipelineType("cubic"), cwndPath, rttPath, decryptKeyPath, outputPath;
   time::milliseconds::rep minRto(200), maxRto(60000);
   double rtoAlpha(0.125), rtoBeta(0.25);
   int rtoK(8);
+  bool wantPositionalWrites = false;
+  bool wantResume = false;
+  size_t nValidationThreads = 0;
+  size_t maxBufferMb = 256;
+  std::string batchPath;
+  bool isCatalog = false;
+  size_t maxConcurrent = 4;
+  std::vector<std::string> sourceUris;
 
   namespace po = boost::program_options;
   po::options_description basicDesc("Basic Options");
   basicDesc.add_options()
     ("help,h",      "print this help message and exit")
     ("pipeline-type,p", po::value<std::string>(&pipelineType)->default_value(pipelineType),
-                        "type of Interest pipeline to use; valid values are: 'fixed', 'aimd', 'cubic'")
+                        "type of Interest pipeline to use; valid values are: 'fixed', 'aimd', 'cubic', 'bbr', 'ledbat'")
     ("fresh,f",     po::bool_switch(&options.mustBeFresh),
                     "only return fresh content (set MustBeFresh on all outgoing Interests)")
     ("lifetime,l",  po::value<time::milliseconds::rep>()->default_value(options.interestLifetime.count()),
@@ -68,21 +122,69 @@ main(int argc, char* argv[])
                     "maximum number of retries in case of Nack or timeout (-1 = no limit)")
     ("no-version-discovery,D", po::bool_switch(&options.disableVersionDiscovery),
                     "skip version discovery, even if the supplied name does not end with a version component")
+    ("output,o",    po::value<std::string>(&outputPath),
+                    "write the content to this file instead of the last component of the name; "
+                    "'-' streams it to the standard output")
+    ("decrypt-key,k", po::value<std::string>(&decryptKeyPath),
+                      "decrypt the content while it is retrieved, using the private key in this file")
+    ("positional-writes,P", po::bool_switch(&wantPositionalWrites),
+                    "preallocate the output file and write each segment at its offset as it arrives, "
+                    "instead of reordering segments in memory")
+    ("resume,R",    po::bool_switch(&wantResume),
+                    "record the progress in <output file>.ndndrop-state and, if an earlier retrieval "
+                    "of the same version was interrupted, only retrieve the missing segments; implies -P")
+    ("validation-threads,j", po::value<size_t>(&nValidationThreads)->default_value(nValidationThreads),
+                    "number of threads validating segments in parallel (0 = validate on the main thread)")
+    ("max-buffer",  po::value<size_t>(&maxBufferMb)->default_value(maxBufferMb),
+                    "stop requesting new segments while this many megabytes of content wait in memory "
+                    "for a missing segment or for storage (0 = no limit); in batch mode the limit applies "
+                    "to each file, so up to --concurrency times as much may be held")
     ("quiet,q",     po::bool_switch(&options.isQuiet), "suppress all diagnostic output, except fatal errors")
     ("verbose,v",   po::bool_switch(&options.isVerbose), "turn on verbose output (per segment information")
     ("version,V",   "print program version and exit")
     ;
 
+  po::options_description batchDesc("Batch options");
+  batchDesc.add_options()
+    ("batch,b",     po::value<std::string>(&batchPath),
+                    "retrieve every name listed in this file, one per line ('-' for the standard input), "
+                    "instead of a single name")
+    ("catalog,c",   po::bool_switch(&isCatalog),
+                    "the name is a catalog, such as the list.txt kept by listHelper.sh; retrieve it, "
+                    "then every file it lists under the same prefix")
+    ("concurrency", po::value<size_t>(&maxConcurrent)->default_value(maxConcurrent),
+                    "maximum number of files retrieved at the same time in batch mode")
+    ;
+
+  po::options_description multiSourceDesc("Multi-source options");
+  multiSourceDesc.add_options()
+    ("source",      po::value<std::vector<std::string>>(&sourceUris)->composing(),
+                    "forwarding hint of a producer of the content, e.g. the prefix of a LAN peer running "
+                    "ndndroplist ('/' uses the routes of the content name); repeat to retrieve from several "
+                    "producers at once, each with its own window following the AIMD options. All sources must "
+                    "publish the same version: peers that each publish their own copy, with its own version "
+                    "and key, share no segment")
+    ;
+
   po::options_description fixedPipeDesc("Fixed pipeline options");
   fixedPipeDesc.add_options()
     ("pipeline-size,s", po::value<size_t>(&options.maxPipelineSize)->default_value(options.maxPipelineSize),
                         "size of the Interest pipeline")
     ;
 
-  po::options_description adaptivePipeDesc("Adaptive pipeline options (AIMD & CUBIC)");
+  po::options_description adaptivePipeDesc("Adaptive pipeline options (AIMD, CUBIC, BBR & LEDBAT)");
   adaptivePipeDesc.add_options()
     ("ignore-marks", po::bool_switch(&options.ignoreCongMarks),
                      "do not reduce the window after receiving a congestion mark")
+    ("proportional-marks", po::bool_switch(&options.proportionalMarks),
+                           "reduce the window once per RTT in proportion to the fraction of marked Data, "
+                           "like DCTCP, instead of by the full decrease factor on every mark")
+    ("pacing",       po::bool_switch(&options.enablePacing),
+                     "spread the Interests of each window over the smoothed RTT instead of sending "
+                     "them in bursts (BBR always paces)")
+    ("reorder-threshold", po::value<uint64_t>(&options.reorderThreshold)->default_value(options.reorderThreshold),
+                          "retransmit a missing segment as soon as a segment this many numbers beyond it "
+                          "is received, instead of waiting for its RTO (0 to disable)")
     ("disable-cwa",  po::bool_switch(&options.disableCwa),
                      "disable Conservative Window Adaptation, i.e., reduce the window on "
                      "each timeout or congestion mark instead of at most once per RTT")
@@ -115,13 +217,25 @@ main(int argc, char* argv[])
   cubicPipeDesc.add_options()
     ("cubic-beta", po::value<double>(&options.cubicBeta), "window decrease factor (defaults to 0.7)")
     ("fast-conv",  po::bool_switch(&options.enableFastConv), "enable fast convergence")
+    ("disable-hystart", po::bool_switch(&options.disableHystart),
+                        "stay in slow start until the first loss or congestion mark, instead of leaving it "
+                        "when the RTT starts to grow (HyStart)")
+    ;
+
+  po::options_description ledbatPipeDesc("LEDBAT pipeline options");
+  ledbatPipeDesc.add_options()
+    ("ledbat-target", po::value<time::milliseconds::rep>()->default_value(options.ledbatTarget.count()),
+                      "queuing delay, in milliseconds, above which the window shrinks")
     ;
 
   po::options_description visibleDesc;
   visibleDesc.add(basicDesc)
+             .add(batchDesc)
+             .add(multiSourceDesc)
              .add(fixedPipeDesc)
              .add(adaptivePipeDesc)
-             .add(cubicPipeDesc);
+             .add(cubicPipeDesc)
+             .add(ledbatPipeDesc);
 
   po::options_description hiddenDesc;
   hiddenDesc.add_options()
@@ -158,14 +272,15 @@ main(int argc, char* argv[])
     return 0;
   }
 
-  if (vm.count("ndn-name") == 0) {
+  bool isBatch = !batchPath.empty() || isCatalog;
+  if (vm.count("ndn-name") == 0 && batchPath.empty()) {
     std::cerr << "Usage: " << programName << " [options] ndn:/name" << std::endl;
     std::cerr << visibleDesc;
     return 2;
   }
 
-  if (options.maxPipelineSize < 1 || options.maxPipelineSize > 1024) {
-    std::cerr << "ERROR: pipeline size must be between 1 and 1024" << std::endl;
+  if (options.maxPipelineSize < 1 || options.maxPipelineSize > 65536) {
+    std::cerr << "ERROR: pipeline size must be between 1 and 65536" << std::endl;
     return 2;
   }
 
@@ -174,19 +289,184 @@ main(int argc, char* argv[])
     return 2;
   }
 
+  if (!batchPath.empty() && (isCatalog || vm.count("ndn-name") > 0)) {
+    std::cerr << "ERROR: a batch file cannot be combined with a name or a catalog" << std::endl;
+    return 2;
+  }
+
+  if (isBatch && (maxConcurrent < 1 || maxConcurrent > 1024)) {
+    std::cerr << "ERROR: concurrency must be between 1 and 1024" << std::endl;
+    return 2;
+  }
+
+  if (isBatch && (wantResume || !cwndPath.empty() || !rttPath.empty())) {
+    std::cerr << "ERROR: resuming and statistics logs are not supported in batch mode" << std::endl;
+    return 2;
+  }
+
+  if (outputPath == "-" && (wantPositionalWrites || wantResume)) {
+    std::cerr << "ERROR: the standard output can only be written in order, "
+                 "positional writes and resuming need a file" << std::endl;
+    return 2;
+  }
+
+  if (isBatch && !outputPath.empty()) {
+    std::cerr << "ERROR: an output file cannot be given in batch mode" << std::endl;
+    return 2;
+  }
+
+  if (!sourceUris.empty() && !vm["pipeline-type"].defaulted()) {
+    std::cerr << "ERROR: --source selects the multi-source pipeline and cannot be combined with -p" << std::endl;
+    return 2;
+  }
+
+  if (!sourceUris.empty() && (!cwndPath.empty() || !rttPath.empty())) {
+    std::cerr << "ERROR: statistics logs are not supported with multiple sources" << std::endl;
+    return 2;
+  }
+
+  if (nValidationThreads > 64) {
+    std::cerr << "ERROR: validation threads must be between 0 and 64" << std::endl;
+    return 2;
+  }
+
+  if (maxBufferMb > 1000000) {
+    std::cerr << "ERROR: the maximum buffer size cannot exceed 1000000 MB" << std::endl;
+    return 2;
+  }
+  size_t maxBufferedBytes = maxBufferMb * 1000000;
+
   options.interestLifetime = time::milliseconds(vm["lifetime"].as<time::milliseconds::rep>());
   if (options.interestLifetime < 0_ms) {
     std::cerr << "ERROR: lifetime cannot be negative" << std::endl;
     return 2;
   }
 
+  options.ledbatTarget = time::milliseconds(vm["ledbat-target"].as<time::milliseconds::rep>());
+  if (options.ledbatTarget <= 0_ms) {
+    std::cerr << "ERROR: the LEDBAT target must be positive" << std::endl;
+    return 2;
+  }
+
   if (options.isQuiet && options.isVerbose) {
     std::cerr << "ERROR: cannot be quiet and verbose at the same time" << std::endl;
     return 2;
   }
 
+  if ((wantPositionalWrites || wantResume) && !decryptKeyPath.empty()) {
+    std::cerr << "ERROR: positional writes and resuming cannot be combined with decryption" << std::endl;
+    return 2;
+  }
+
   try {
     Face face;
+    std::vector<Name> sources(sourceUris.begin(), sourceUris.end());
+
+    auto optionsRttEst = make_shared<RttEstimatorWithStats::Options>();
+    optionsRttEst->alpha = rtoAlpha;
+    optionsRttEst->beta = rtoBeta;
+    optionsRttEst->k = rtoK;
+    optionsRttEst->initialRto = 1_s;
+    optionsRttEst->minRto = time::milliseconds(minRto);
+    optionsRttEst->maxRto = time::milliseconds(maxRto);
+    optionsRttEst->rtoBackoffMultiplier = 2;
+
+    unique_ptr<ValidationPool> validationPool;
+    if (nValidationThreads > 0) {
+      // every worker gets its own validator with the same policy as the main one
+      validationPool = make_unique<ValidationPool>(face.getIoService(), nValidationThreads,
+        [] (boost::asio::io_service&) {
+          return make_unique<security::v2::Validator>(make_unique<security::v2::ValidationPolicyAcceptAll>(),
+                                                      make_unique<security::v2::CertificateFetcherOffline>());
+        });
+    }
+
+    optional<Buffer> decryptKey;
+    if (!decryptKeyPath.empty()) {
+      std::ifstream keyFile(decryptKeyPath, std::ifstream::binary);
+      if (keyFile.fail()) {
+        std::cerr << "ERROR: failed to open " << decryptKeyPath << std::endl;
+        return 4;
+      }
+      decryptKey.emplace(std::istreambuf_iterator<char>(keyFile), std::istreambuf_iterator<char>());
+    }
+
+    if (isBatch) {
+      if (pipelineType != "fixed" && pipelineType != "aimd" && pipelineType != "cubic" &&
+          pipelineType != "bbr" && pipelineType != "ledbat") {
+        std::cerr << "ERROR: Interest pipeline type not valid" << std::endl;
+        return 2;
+      }
+
+      BatchConsumer batch(face, security::v2::getAcceptAllValidator(), options, maxConcurrent,
+        [&] (RttEstimatorWithStats& rttEstimator) -> unique_ptr<PipelineInterests> {
+          if (!sources.empty()) {
+            return make_unique<PipelineInterestsMultiSource>(face, sources, optionsRttEst, options);
+          }
+          else if (pipelineType == "fixed") {
+            return make_unique<PipelineInterestsFixed>(face, options);
+          }
+          else if (pipelineType == "aimd") {
+            return make_unique<PipelineInterestsAimd>(face, rttEstimator, options);
+          }
+          else if (pipelineType == "bbr") {
+            return make_unique<PipelineInterestsBbr>(face, rttEstimator, options);
+          }
+          else if (pipelineType == "ledbat") {
+            return make_unique<PipelineInterestsLedbat>(face, rttEstimator, options);
+          }
+          return make_unique<PipelineInterestsCubic>(face, rttEstimator, options);
+        },
+        optionsRttEst);
+      if (validationPool != nullptr) {
+        batch.setValidationPool(*validationPool);
+      }
+      batch.setMemoryLimit(maxBufferedBytes);
+      if (wantPositionalWrites) {
+        batch.enablePositionalWrites();
+      }
+      if (decryptKey) {
+        batch.setDecryptionKey(*decryptKey);
+      }
+
+      std::vector<BatchConsumer::Item> items;
+      if (isCatalog) {
+        std::string catalogPath = getOutputFileName(uri);
+        batch.run({{Name(uri), catalogPath}});
+        face.processEvents();
+        if (batch.getNFailed() > 0) {
+          return 1;
+        }
+
+        // the catalog lists file names, published under the same prefix as the catalog
+        std::ifstream catalog(catalogPath);
+        std::string prefix = uri.substr(0, uri.rfind('/') + 1);
+        items = readBatchItems(catalog, [&prefix] (const std::string& fileName) {
+          return BatchConsumer::Item{Name(prefix + fileName), getOutputFileName(fileName)};
+        });
+      }
+      else {
+        std::ifstream batchFile;
+        if (batchPath != "-") {
+          batchFile.open(batchPath);
+          if (batchFile.fail()) {
+            std::cerr << "ERROR: failed to open " << batchPath << std::endl;
+            return 4;
+          }
+        }
+        items = readBatchItems(batchPath == "-" ? std::cin : batchFile, [] (const std::string& name) {
+          return BatchConsumer::Item{Name(name), getOutputFileName(name)};
+        });
+      }
+
+      batch.run(std::move(items));
+      face.processEvents();
+      if (!options.isQuiet) {
+        batch.printSummary();
+      }
+      return batch.getNFailed() > 0 ? 1 : 0;
+    }
+
     auto discover = make_unique<DiscoverVersion>(face, Name(uri), options);
     unique_ptr<PipelineInterests> pipeline;
     unique_ptr<StatisticsCollector> statsCollector;
@@ -194,18 +474,14 @@ main(int argc, char* argv[])
     std::ofstream statsFileCwnd;
     std::ofstream statsFileRtt;
 
-    if (pipelineType == "fixed") {
+    if (!sources.empty()) {
+      pipeline = make_unique<PipelineInterestsMultiSource>(face, sources, optionsRttEst, options);
+    }
+    else if (pipelineType == "fixed") {
       pipeline = make_unique<PipelineInterestsFixed>(face, options);
     }
-    else if (pipelineType == "aimd" || pipelineType == "cubic") {
-      auto optionsRttEst = make_shared<RttEstimatorWithStats::Options>();
-      optionsRttEst->alpha = rtoAlpha;
-      optionsRttEst->beta = rtoBeta;
-      optionsRttEst->k = rtoK;
-      optionsRttEst->initialRto = 1_s;
-      optionsRttEst->minRto = time::milliseconds(minRto);
-      optionsRttEst->maxRto = time::milliseconds(maxRto);
-      optionsRttEst->rtoBackoffMultiplier = 2;
+    else if (pipelineType == "aimd" || pipelineType == "cubic" || pipelineType == "bbr" ||
+             pipelineType == "ledbat") {
       if (options.isVerbose) {
         using namespace ndn::time;
         std::cerr << "RTT estimator parameters:\n"
@@ -223,6 +499,12 @@ main(int argc, char* argv[])
       if (pipelineType == "aimd") {
         adaptivePipeline = make_unique<PipelineInterestsAimd>(face, *rttEstimator, options);
       }
+      else if (pipelineType == "bbr") {
+        adaptivePipeline = make_unique<PipelineInterestsBbr>(face, *rttEstimator, options);
+      }
+      else if (pipelineType == "ledbat") {
+        adaptivePipeline = make_unique<PipelineInterestsLedbat>(face, *rttEstimator, options);
+      }
       else {
         adaptivePipeline = make_unique<PipelineInterestsCubic>(face, *rttEstimator, options);
       }
@@ -251,19 +533,51 @@ main(int argc, char* argv[])
       std::cerr << "ERROR: Interest pipeline type not valid" << std::endl;
       return 2;
     }
-    std::string outputFileName = uri;
-    std::string delimiter = "/";
-    size_t pos = 0;
-    std::string token;
-    while ((pos = outputFileName.find(delimiter)) != std::string::npos) {
-      outputFileName.erase(0, pos + delimiter.length());
+    std::string outputFileName = outputPath.empty() ? getOutputFileName(uri) : outputPath;
+    std::string resumeStatePath = outputFileName + ".ndndrop-state";
+    optional<ResumeState> resumeState;
+    if (wantResume) {
+      resumeState = ResumeState::load(resumeStatePath);
+    }
+
+    unique_ptr<AsyncWriter> outputFile;
+    if (outputPath == "-") {
+      outputFile = make_unique<AsyncWriter>(STDOUT_FILENO);
+    }
+    else {
+      // keep what an interrupted retrieval wrote
+      outputFile = make_unique<AsyncWriter>(outputFileName, !resumeState);
+    }
+    unique_ptr<ContentKeyCache> contentKeys;
+    if (decryptKey) {
+      contentKeys = make_unique<ContentKeyCache>(face, security::v2::getAcceptAllValidator(),
+                                                 std::move(*decryptKey), options);
+    }
+    Consumer consumer(security::v2::getAcceptAllValidator(), *outputFile);
+    if (validationPool != nullptr) {
+      consumer.setValidationPool(*validationPool);
+    }
+    consumer.setMemoryLimit(maxBufferedBytes, face.getIoService());
+    if (wantResume) {
+      consumer.enableResume(resumeStatePath, std::move(resumeState));
+    }
+    else if (wantPositionalWrites) {
+      consumer.enablePositionalWrites();
+    }
+    if (contentKeys != nullptr) {
+      consumer.setDecryptionKey(*contentKeys);
     }
-    std::ofstream outputFile(outputFileName, std::ofstream::binary);
-    Consumer consumer(security::v2::getAcceptAllValidator(), outputFile);
     BOOST_ASSERT(discover != nullptr);
     BOOST_ASSERT(pipeline != nullptr);
     consumer.run(std::move(discover), std::move(pipeline));
     face.processEvents();
+    outputFile->close();
+
+    if (wantResume) {
+      // the retrieval is complete
+      std::remove(resumeStatePath.data());
+      std::remove((resumeStatePath + ".tmp").data());
+    }
   }
   catch (const Consumer::ApplicationNackError& e) {
     std::cerr << "ERROR: " << e.what() << std::endl;
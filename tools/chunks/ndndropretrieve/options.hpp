@@ -48,9 +48,13 @@ struct Options : noncopyable
   // Adaptive pipeline common options
   double initCwnd = 2.0;        ///< initial congestion window size
   double initSsthresh = std::numeric_limits<double>::max(); ///< initial slow start threshold
-  time::milliseconds rtoCheckInterval{10}; ///< interval for checking retransmission timer
   bool ignoreCongMarks = false; ///< disable window decrease after receiving congestion mark
+  bool proportionalMarks = false; ///< decrease the window once per RTT in proportion to the
+                                  ///< fraction of marked Data (DCTCP) instead of multiplicatively
   bool disableCwa = false;      ///< disable conservative window adaptation
+  bool enablePacing = false;    ///< spread the Interests of a window over the smoothed RTT
+  uint64_t reorderThreshold = 3; ///< # of segments the highest received one must be beyond a
+                                 ///< missing segment to retransmit it before its RTO, 0 disables
 
   // AIMD pipeline options
   double aiStep = 1.0;          ///< AIMD additive increase step (in segments)
@@ -60,6 +64,10 @@ struct Options : noncopyable
   // Cubic pipeline options
   double cubicBeta = 0.7;       ///< cubic multiplicative decrease factor
   bool enableFastConv = false;  ///< use cubic fast convergence
+  bool disableHystart = false;  ///< stay in slow start until the first loss or mark
+
+  // LEDBAT pipeline options
+  time::milliseconds ledbatTarget{25}; ///< queuing delay above which the window shrinks
 };
 
 } // namespace chunks
@@ -36,6 +36,8 @@ namespace ndn {
 namespace chunks {
 
 constexpr double PipelineInterestsAdaptive::MIN_SSTHRESH;
+constexpr double PipelineInterestsAdaptive::MARK_FRACTION_GAIN;
+constexpr time::nanoseconds PipelineInterestsAdaptive::MAX_PACING_LAG;
 
 PipelineInterestsAdaptive::PipelineInterestsAdaptive(Face& face,
                                                      RttEstimatorWithStats& rttEstimator,
@@ -45,17 +47,27 @@ PipelineInterestsAdaptive::PipelineInterestsAdaptive(Face& face,
   , m_ssthresh(m_options.initSsthresh)
   , m_rttEstimator(rttEstimator)
   , m_scheduler(m_face.getIoService())
+  , m_isPacingTimerArmed(false)
+  , m_nDelivered(0)
   , m_highData(0)
   , m_highInterest(0)
   , m_recPoint(0)
+  , m_nextLossCheckSegNo(0)
+  , m_markFraction(1.0)
+  , m_markRoundEnd(0)
+  , m_nRoundDelivered(0)
+  , m_nRoundMarked(0)
   , m_nInFlight(0)
   , m_nLossDecr(0)
   , m_nMarkDecr(0)
   , m_nTimeouts(0)
+  , m_nFastRetx(0)
   , m_nSkippedRetx(0)
   , m_nRetransmitted(0)
   , m_nCongMarks(0)
   , m_nSent(0)
+  , m_nBackpressured(0)
+  , m_rtoTimer(m_scheduler, m_segmentInfo, [this] { checkRto(); })
   , m_hasFailure(false)
   , m_failedSegNo(0)
 {
@@ -77,19 +89,23 @@ PipelineInterestsAdaptive::doRun()
     return;
   }
 
-  // schedule the event to check retransmission timer
-  m_checkRtoEvent = m_scheduler.schedule(m_options.rtoCheckInterval, [this] { checkRto(); });
-
   schedulePackets();
 }
 
 void
 PipelineInterestsAdaptive::doCancel()
 {
-  m_checkRtoEvent.cancel();
+  m_rtoTimer.cancel();
+  m_pacingEvent.cancel();
   m_segmentInfo.clear();
 }
 
+void
+PipelineInterestsAdaptive::doResume()
+{
+  schedulePackets();
+}
+
 void
 PipelineInterestsAdaptive::checkRto()
 {
@@ -97,78 +113,68 @@ PipelineInterestsAdaptive::checkRto()
     return;
 
   bool hasTimeout = false;
-
-  for (auto& entry : m_segmentInfo) {
-    SegmentInfo& segInfo = entry.second;
-    if (segInfo.state != SegmentState::InRetxQueue) { // skip segments already in the retx queue
-      auto timeElapsed = time::steady_clock::now() - segInfo.timeSent;
-      if (timeElapsed > segInfo.rto) { // timer expired?
-        m_nTimeouts++;
-        hasTimeout = true;
-        enqueueForRetransmission(entry.first);
-      }
-    }
-  }
+  m_rtoTimer.popExpired([this, &hasTimeout] (uint64_t segNo, SegmentInfo&) {
+    m_nTimeouts++;
+    hasTimeout = true;
+    enqueueForRetransmission(segNo);
+  });
 
   if (hasTimeout) {
-    recordTimeout();
+    recordLoss(true);
     schedulePackets();
   }
-
-  // schedule the next check after predefined interval
-  m_checkRtoEvent = m_scheduler.schedule(m_options.rtoCheckInterval, [this] { checkRto(); });
 }
 
-void
+bool
 PipelineInterestsAdaptive::sendInterest(uint64_t segNo, bool isRetransmission)
 {
   if (isStopping())
-    return;
+    return false;
 
   if (m_hasFinalBlockId && segNo > m_lastSegmentNo)
-    return;
+    return false;
 
   if (!isRetransmission && m_hasFailure)
-    return;
+    return false;
 
   if (m_options.isVerbose) {
     std::cerr << (isRetransmission ? "Retransmitting" : "Requesting")
               << " segment #" << segNo << std::endl;
   }
 
+  SegmentInfo& segInfo = m_segmentInfo.insert(segNo);
   if (isRetransmission) {
     // keep track of retx count for this segment
-    auto ret = m_retxCount.emplace(segNo, 1);
-    if (ret.second == false) { // not the first retransmission
-      m_retxCount[segNo] += 1;
+    if (++segInfo.nRetx > 1) { // not the first retransmission
       if (m_options.maxRetriesOnTimeoutOrNack != DataFetcher::MAX_RETRIES_INFINITE &&
-          m_retxCount[segNo] > m_options.maxRetriesOnTimeoutOrNack) {
-        return handleFail(segNo, "Reached the maximum number of retries (" +
-                          to_string(m_options.maxRetriesOnTimeoutOrNack) +
-                          ") while retrieving segment #" + to_string(segNo));
+          segInfo.nRetx > m_options.maxRetriesOnTimeoutOrNack) {
+        handleFail(segNo, "Reached the maximum number of retries (" +
+                   to_string(m_options.maxRetriesOnTimeoutOrNack) +
+                   ") while retrieving segment #" + to_string(segNo));
+        return false;
       }
 
       if (m_options.isVerbose) {
         std::cerr << "# of retries for segment #" << segNo
-                  << " is " << m_retxCount[segNo] << std::endl;
+                  << " is " << segInfo.nRetx << std::endl;
       }
     }
   }
 
-  auto interest = Interest()
-                  .setName(Name(m_prefix).appendSegment(segNo))
-                  .setCanBePrefix(false)
-                  .setMustBeFresh(m_options.mustBeFresh)
-                  .setInterestLifetime(m_options.interestLifetime);
-
-  SegmentInfo& segInfo = m_segmentInfo[segNo];
-  segInfo.interestHdl = m_face.expressInterest(interest,
+  segInfo.interestHdl = m_face.expressInterest(m_interestTemplate.make(segNo),
                                                bind(&PipelineInterestsAdaptive::handleData, this, _1, _2),
                                                bind(&PipelineInterestsAdaptive::handleNack, this, _1, _2),
                                                bind(&PipelineInterestsAdaptive::handleLifetimeExpiration, this, _1));
   segInfo.timeSent = time::steady_clock::now();
   segInfo.rto = m_rttEstimator.getEstimatedRto();
 
+  // nothing in flight, delivery rate samples start from now
+  if (m_nInFlight == 0) {
+    m_deliveredTime = segInfo.timeSent;
+  }
+  segInfo.nDeliveredAtSend = m_nDelivered;
+  segInfo.deliveredTimeAtSend = m_deliveredTime;
+
   m_nInFlight++;
   m_nSent++;
 
@@ -180,6 +186,9 @@ PipelineInterestsAdaptive::sendInterest(uint64_t segNo, bool isRetransmission)
     m_highInterest = segNo;
     segInfo.state = SegmentState::FirstTimeSent;
   }
+
+  m_rtoTimer.add(segNo);
+  return true;
 }
 
 void
@@ -188,24 +197,74 @@ PipelineInterestsAdaptive::schedulePackets()
   BOOST_ASSERT(m_nInFlight >= 0);
   auto availableWindowSize = static_cast<int64_t>(m_cwnd) - m_nInFlight;
 
-  while (availableWindowSize > 0) {
-    if (!m_retxQueue.empty()) { // do retransmission first
-      uint64_t retxSegNo = m_retxQueue.front();
+  auto pacingInterval = getPacingInterval();
+  auto now = time::steady_clock::now();
+  if (pacingInterval > time::nanoseconds::zero()) {
+    // credit left unused while the window was full is not saved up for a burst
+    m_nextSendTime = std::max(m_nextSendTime, now - MAX_PACING_LAG);
+  }
+
+  while (availableWindowSize > 0 && !isStopping()) {
+    // segments received since they were queued need no retransmission
+    while (!m_retxQueue.empty() && m_segmentInfo.find(m_retxQueue.top()) == nullptr) {
       m_retxQueue.pop();
-      if (m_segmentInfo.count(retxSegNo) == 0) {
-        m_nSkippedRetx++;
-        continue;
-      }
-      // the segment is still in the map, that means it needs to be retransmitted
-      sendInterest(retxSegNo, true);
+      m_nSkippedRetx++;
+    }
+
+    bool isRetransmission = !m_retxQueue.empty(); // do retransmission first
+    if (!isRetransmission && !canSendNewSegment()) {
+      break;
+    }
+
+    if (pacingInterval > time::nanoseconds::zero() && m_nextSendTime > now) {
+      armPacingTimer(m_nextSendTime - now);
+      break;
     }
-    else { // send next segment
-      sendInterest(getNextSegmentNo(), false);
+
+    bool hasSent = false;
+    if (isRetransmission) {
+      uint64_t retxSegNo = m_retxQueue.top();
+      m_retxQueue.pop();
+      hasSent = sendInterest(retxSegNo, true);
+    }
+    else {
+      hasSent = sendInterest(getNextSegmentNo(), false);
+    }
+
+    // window and pacing credit are only consumed by Interests actually sent
+    if (hasSent) {
+      availableWindowSize--;
+      m_nextSendTime += pacingInterval;
+    }
+    else if (!isRetransmission) {
+      break;
     }
-    availableWindowSize--;
   }
 }
 
+bool
+PipelineInterestsAdaptive::canSendNewSegment()
+{
+  if (m_hasFailure || (m_hasFinalBlockId && peekNextSegmentNo() > m_lastSegmentNo)) {
+    return false;
+  }
+  // the consumer is holding too much content already
+  return !isThrottled();
+}
+
+void
+PipelineInterestsAdaptive::armPacingTimer(time::nanoseconds delay)
+{
+  if (m_isPacingTimerArmed)
+    return;
+
+  m_isPacingTimerArmed = true;
+  m_pacingEvent = m_scheduler.schedule(delay, [this] {
+    m_isPacingTimerArmed = false;
+    schedulePackets();
+  });
+}
+
 void
 PipelineInterestsAdaptive::handleData(const Interest& interest, const Data& data)
 {
@@ -229,17 +288,16 @@ PipelineInterestsAdaptive::handleData(const Interest& interest, const Data& data
   }
 
   uint64_t recvSegNo = getSegmentFromPacket(data);
-  auto segIt = m_segmentInfo.find(recvSegNo);
-  if (segIt == m_segmentInfo.end()) {
+  SegmentInfo* segInfo = m_segmentInfo.find(recvSegNo);
+  if (segInfo == nullptr) {
     return; // ignore already-received segment
   }
 
-  SegmentInfo& segInfo = segIt->second;
-  time::nanoseconds rtt = time::steady_clock::now() - segInfo.timeSent;
+  time::nanoseconds rtt = time::steady_clock::now() - segInfo->timeSent;
   if (m_options.isVerbose) {
     std::cerr << "Received segment #" << recvSegNo
               << ", rtt=" << rtt.count() / 1e6 << "ms"
-              << ", rto=" << segInfo.rto.count() / 1e6 << "ms" << std::endl;
+              << ", rto=" << segInfo->rto.count() / 1e6 << "ms" << std::endl;
   }
 
   if (m_highData < recvSegNo) {
@@ -248,41 +306,51 @@ PipelineInterestsAdaptive::handleData(const Interest& interest, const Data& data
 
   // for segments in retx queue, we must not decrement m_nInFlight
   // because it was already decremented when the segment timed out
-  if (segInfo.state != SegmentState::InRetxQueue) {
+  if (segInfo->state != SegmentState::InRetxQueue) {
     m_nInFlight--;
   }
 
+  auto now = time::steady_clock::now();
+  m_nDelivered++;
+  m_deliveredTime = now;
+  DeliverySample sample{segInfo->nDeliveredAtSend, m_nDelivered - segInfo->nDeliveredAtSend,
+                        now - segInfo->deliveredTimeAtSend, nullopt};
+  // do not sample RTT for retransmitted segments
+  if ((segInfo->state == SegmentState::FirstTimeSent ||
+       segInfo->state == SegmentState::InRetxQueue) &&
+      segInfo->nRetx == 0) {
+    sample.rtt = rtt;
+  }
+  onDelivery(sample);
+
   // upon finding congestion mark, decrease the window size
   // without retransmitting any packet
-  if (data.getCongestionMark() > 0) {
+  bool isMarked = data.getCongestionMark() > 0;
+  if (isMarked) {
     m_nCongMarks++;
-    if (!m_options.ignoreCongMarks) {
-      if (m_options.disableCwa || m_highData > m_recPoint) {
-        m_recPoint = m_highInterest;  // react to only one congestion event (timeout or congestion mark)
-                                      // per RTT (conservative window adaptation)
-        m_nMarkDecr++;
-        decreaseWindow();
-
-        if (m_options.isVerbose) {
-          std::cerr << "Received congestion mark, value = " << data.getCongestionMark()
-                    << ", new cwnd = " << m_cwnd << std::endl;
-        }
+  }
+  if (isMarked && !m_options.ignoreCongMarks && !m_options.proportionalMarks) {
+    if (m_options.disableCwa || m_highData > m_recPoint) {
+      m_recPoint = m_highInterest;  // react to only one congestion event (timeout or congestion mark)
+                                    // per RTT (conservative window adaptation)
+      m_nMarkDecr++;
+      decreaseWindow();
+
+      if (m_options.isVerbose) {
+        std::cerr << "Received congestion mark, value = " << data.getCongestionMark()
+                  << ", new cwnd = " << m_cwnd << std::endl;
       }
     }
-    else {
-      increaseWindow();
-    }
   }
   else {
-    increaseWindow();
+    increaseWindowUnlessBackpressured();
   }
 
-  onData(data);
+  if (m_options.proportionalMarks && !m_options.ignoreCongMarks) {
+    updateMarkFraction(sample, isMarked);
+  }
 
-  // do not sample RTT for retransmitted segments
-  if ((segInfo.state == SegmentState::FirstTimeSent ||
-       segInfo.state == SegmentState::InRetxQueue) &&
-      m_retxCount.count(recvSegNo) == 0) {
+  if (sample.rtt) {
     auto nExpectedSamples = std::max<int64_t>((m_nInFlight + 1) >> 1, 1);
     BOOST_ASSERT(nExpectedSamples > 0);
     m_rttEstimator.addMeasurement(rtt, static_cast<size_t>(nExpectedSamples));
@@ -293,7 +361,13 @@ PipelineInterestsAdaptive::handleData(const Interest& interest, const Data& data
   }
 
   // remove the entry associated with the received segment
-  m_segmentInfo.erase(segIt);
+  m_segmentInfo.erase(recvSegNo);
+  detectLostSegments();
+
+  // the user of the pipeline may cancel it, which clears m_segmentInfo
+  onData(data);
+  if (isStopping())
+    return;
 
   if (allSegmentsReceived()) {
     cancel();
@@ -325,7 +399,7 @@ PipelineInterestsAdaptive::handleNack(const Interest& interest, const lp::Nack&
     case lp::NackReason::CONGESTION:
       // treated the same as timeout for now
       enqueueForRetransmission(segNo);
-      recordTimeout();
+      recordLoss(true);
       schedulePackets();
       break;
     default:
@@ -343,19 +417,106 @@ PipelineInterestsAdaptive::handleLifetimeExpiration(const Interest& interest)
 
   m_nTimeouts++;
   enqueueForRetransmission(getSegmentFromPacket(interest));
-  recordTimeout();
+  recordLoss(true);
   schedulePackets();
 }
 
 void
-PipelineInterestsAdaptive::recordTimeout()
+PipelineInterestsAdaptive::detectLostSegments()
+{
+  bool hasLoss = false;
+  m_segmentInfo.detectOvertaken(m_nextLossCheckSegNo, m_highData, m_options.reorderThreshold,
+                                [this, &hasLoss] (uint64_t segNo, SegmentInfo&) {
+    m_nFastRetx++;
+    if (m_options.isVerbose) {
+      std::cerr << "Segment #" << segNo << " lost, segment #" << m_highData
+                << " already received (fast retransmission #" << m_nFastRetx << ")" << std::endl;
+    }
+    enqueueForRetransmission(segNo);
+    hasLoss = true;
+  });
+
+  if (hasLoss) {
+    recordLoss(false);
+  }
+}
+
+void
+PipelineInterestsAdaptive::updateMarkFraction(const DeliverySample& sample, bool isMarked)
+{
+  m_nRoundDelivered++;
+  if (isMarked) {
+    m_nRoundMarked++;
+  }
+
+  // a round trip ends when Data requested after it started arrives
+  if (sample.priorDelivered < m_markRoundEnd)
+    return;
+
+  double fraction = static_cast<double>(m_nRoundMarked) / m_nRoundDelivered;
+  m_markFraction = (1 - MARK_FRACTION_GAIN) * m_markFraction + MARK_FRACTION_GAIN * fraction;
+  if (m_nRoundMarked > 0) {
+    m_nMarkDecr++;
+    decreaseWindowForMarks(m_markFraction / 2);
+
+    if (m_options.isVerbose) {
+      std::cerr << "Marked fraction = " << m_markFraction << " (" << m_nRoundMarked << "/"
+                << m_nRoundDelivered << " last round), new cwnd = " << m_cwnd << std::endl;
+    }
+  }
+
+  m_markRoundEnd = sample.priorDelivered + sample.nDelivered;
+  m_nRoundDelivered = 0;
+  m_nRoundMarked = 0;
+}
+
+void
+PipelineInterestsAdaptive::increaseWindowUnlessBackpressured()
+{
+  if (isBackpressured()) {
+    m_nBackpressured++;
+    return;
+  }
+  increaseWindow();
+}
+
+void
+PipelineInterestsAdaptive::decreaseWindowForMarks(double fraction)
+{
+  m_ssthresh = std::max(MIN_SSTHRESH, m_cwnd * (1 - fraction));
+  m_cwnd = m_ssthresh;
+
+  emitSignal(afterCwndChange, time::steady_clock::now() - getStartTime(), m_cwnd);
+}
+
+void
+PipelineInterestsAdaptive::onDelivery(const DeliverySample&)
+{
+}
+
+time::nanoseconds
+PipelineInterestsAdaptive::getPacingInterval() const
+{
+  auto sRtt = m_rttEstimator.getSmoothedRtt();
+  if (!m_options.enablePacing || sRtt <= time::nanoseconds::zero()) {
+    return time::nanoseconds::zero();
+  }
+
+  double gain = m_cwnd < m_ssthresh ? 2.0 : 1.2;
+  return time::nanoseconds(static_cast<time::nanoseconds::rep>(sRtt.count() / (gain * std::max(m_cwnd, 1.0))));
+}
+
+void
+PipelineInterestsAdaptive::recordLoss(bool isTimeout)
 {
   if (m_options.disableCwa || m_highData > m_recPoint) {
-    // react to only one timeout per RTT (conservative window adaptation)
+    // react to only one loss event per RTT (conservative window adaptation)
     m_recPoint = m_highInterest;
 
     decreaseWindow();
-    m_rttEstimator.backoffRto();
+    if (isTimeout) {
+      m_rttEstimator.backoffRto();
+    }
     m_nLossDecr++;
 
     if (m_options.isVerbose) {
@@ -371,7 +532,9 @@ PipelineInterestsAdaptive::enqueueForRetransmission(uint64_t segNo)
   BOOST_ASSERT(m_nInFlight > 0);
   m_nInFlight--;
   m_retxQueue.push(segNo);
-  m_segmentInfo.at(segNo).state = SegmentState::InRetxQueue;
+  SegmentInfo* segInfo = m_segmentInfo.find(segNo);
+  BOOST_ASSERT(segInfo != nullptr);
+  segInfo->state = SegmentState::InRetxQueue;
 }
 
 void
@@ -403,16 +566,8 @@ PipelineInterestsAdaptive::handleFail(uint64_t segNo, const std::string& reason)
 void
 PipelineInterestsAdaptive::cancelInFlightSegmentsGreaterThan(uint64_t segNo)
 {
-  for (auto it = m_segmentInfo.begin(); it != m_segmentInfo.end();) {
-    // cancel fetching all segments that follow
-    if (it->first > segNo) {
-      it = m_segmentInfo.erase(it);
-      m_nInFlight--;
-    }
-    else {
-      ++it;
-    }
-  }
+  // cancel fetching all segments that follow
+  m_nInFlight -= static_cast<int64_t>(m_segmentInfo.eraseAfter(segNo));
 }
 
 void
@@ -424,9 +579,11 @@ PipelineInterestsAdaptive::printOptions() const
       << "\tInitial slow start threshold = " << m_options.initSsthresh << "\n"
       << "\tAdditive increase step = " << m_options.aiStep << "\n"
       << "\tMultiplicative decrease factor = " << m_options.mdCoef << "\n"
-      << "\tRTO check interval = " << m_options.rtoCheckInterval << "\n"
-      << "\tReact to congestion marks = " << (m_options.ignoreCongMarks ? "no" : "yes") << "\n"
+      << "\tReact to congestion marks = " << (m_options.ignoreCongMarks ? "no" :
+                                                 m_options.proportionalMarks ? "in proportion" : "yes") << "\n"
       << "\tConservative window adaptation = " << (m_options.disableCwa ? "no" : "yes") << "\n"
+      << "\tInterest pacing = " << (m_options.enablePacing ? "yes" : "no") << "\n"
+      << "\tReordering threshold = " << m_options.reorderThreshold << " segments\n"
       << "\tResetting window to " << (m_options.resetCwndToInit ?
                                         "initial value" : "ssthresh") << " upon loss event\n";
 }
@@ -454,22 +611,5 @@ PipelineInterestsAdaptive::printSummary() const
   // }
 }
 
-std::ostream&
-operator<<(std::ostream& os, SegmentState state)
-{
-  switch (state) {
-  case SegmentState::FirstTimeSent:
-    os << "FirstTimeSent";
-    break;
-  case SegmentState::InRetxQueue:
-    os << "InRetxQueue";
-    break;
-  case SegmentState::Retransmitted:
-    os << "Retransmitted";
-    break;
-  }
-  return os;
-}
-
 } // namespace chunks
 } // namespace ndn
@@ -30,40 +30,19 @@
 #define NDN_TOOLS_CHUNKS_CATCHUNKS_PIPELINE_INTERESTS_ADAPTIVE_HPP
 
 #include "pipeline-interests.hpp"
+#include "rto-timer.hpp"
+#include "segment-table.hpp"
 
 #include <ndn-cxx/util/rtt-estimator.hpp>
 
+#include <functional>
 #include <queue>
-#include <unordered_map>
 
 namespace ndn {
 namespace chunks {
 
 using util::RttEstimatorWithStats;
 
-/**
- * @brief indicates the state of the segment
- */
-enum class SegmentState {
-  FirstTimeSent, ///< segment has been sent for the first time
-  InRetxQueue,   ///< segment is in retransmission queue
-  Retransmitted, ///< segment has been retransmitted
-};
-
-std::ostream&
-operator<<(std::ostream& os, SegmentState state);
-
-/**
- * @brief Wraps up information that's necessary for segment transmission
- */
-struct SegmentInfo
-{
-  ScopedPendingInterestHandle interestHdl;
-  time::steady_clock::TimePoint timeSent;
-  time::nanoseconds rto;
-  SegmentState state;
-};
-
 /**
  * @brief Service for retrieving Data via an Interest pipeline
  *
@@ -116,6 +95,29 @@ protected:
   void
   printOptions() const;
 
+  /**
+   * @brief Delivery rate sample taken when a segment is received.
+   *
+   * Covers the segments delivered between the time the segment was requested and its arrival,
+   * so that the rate is measured over at least one round trip.
+   */
+  struct DeliverySample
+  {
+    uint64_t priorDelivered;      ///< # of segments delivered when the segment was requested
+    uint64_t nDelivered;          ///< # of segments delivered over the interval
+    time::nanoseconds interval;   ///< time over which they were delivered
+    optional<time::nanoseconds> rtt; ///< RTT of the segment, unless it was retransmitted
+  };
+
+  /**
+   * @return # of segments in flight
+   */
+  int64_t
+  getNInFlight() const
+  {
+    return m_nInFlight;
+  }
+
 private:
   /**
    * @brief Increase congestion window.
@@ -129,6 +131,35 @@ private:
   virtual void
   decreaseWindow() = 0;
 
+  /**
+   * @brief Shrink the congestion window by @p fraction of its size, in reaction to the congestion
+   *        marks of the last round trip (Options::proportionalMarks).
+   *
+   * The default sets both the window and ssthresh to the reduced size.
+   */
+  virtual void
+  decreaseWindowForMarks(double fraction);
+
+  /**
+   * @brief Called for every received segment, before the window is adjusted.
+   *
+   * Lets subclasses that model the path estimate its bandwidth, or react to delay. Unlike
+   * increaseWindow(), it also runs while the user of the pipeline is backpressured. Does
+   * nothing by default.
+   */
+  virtual void
+  onDelivery(const DeliverySample& sample);
+
+  /**
+   * @brief Interval between two Interests, or zero to send as fast as the window allows.
+   *
+   * With Options::enablePacing, the default spreads a window over the smoothed RTT, twice as
+   * fast in slow start and 1.2 times as fast afterwards so that pacing does not hold the window
+   * back (as Linux TCP does). Otherwise it does not pace.
+   */
+  virtual time::nanoseconds
+  getPacingInterval() const;
+
 private:
   /**
    * @brief Fetch all the segments between 0 and lastSegment of the specified prefix.
@@ -146,8 +177,11 @@ private:
   void
   doCancel() final;
 
+  void
+  doResume() final;
+
   /**
-   * @brief Check RTO for all sent-but-not-acked segments.
+   * @brief Retransmit the segments whose RTO has expired.
    */
   void
   checkRto();
@@ -155,13 +189,27 @@ private:
   /**
    * @param segNo the segment # of the to-be-sent Interest
    * @param isRetransmission true if this is a retransmission
+   * @return whether the Interest was sent; it is not if @p segNo is past the last segment, the
+   *         pipeline is stopping or failed, or the segment has exhausted its retries
    */
-  void
+  bool
   sendInterest(uint64_t segNo, bool isRetransmission);
 
   void
   schedulePackets();
 
+  /**
+   * @brief Whether a segment that was never requested can be requested now
+   */
+  bool
+  canSendNewSegment();
+
+  /**
+   * @brief Call schedulePackets() at the next paced send time.
+   */
+  void
+  armPacingTimer(time::nanoseconds delay);
+
   void
   handleData(const Interest& interest, const Data& data);
 
@@ -171,8 +219,32 @@ private:
   void
   handleLifetimeExpiration(const Interest& interest);
 
+  /**
+   * @brief Increase the window unless the user of the pipeline cannot keep up.
+   */
   void
-  recordTimeout();
+  increaseWindowUnlessBackpressured();
+
+  /**
+   * @brief Retransmit the segments that m_highData is at least Options::reorderThreshold
+   *        beyond, without waiting for their RTO.
+   */
+  void
+  detectLostSegments();
+
+  /**
+   * @brief Decrease the window after a loss, at most once per RTT unless CWA is disabled.
+   * @param isTimeout the loss was detected by a timeout, which also backs off the RTO
+   */
+  void
+  recordLoss(bool isTimeout);
+
+  /**
+   * @brief Update the fraction of marked Data at the end of every round trip, and shrink the
+   *        window in proportion to it if any Data of the round was marked, as DCTCP does.
+   */
+  void
+  updateMarkFraction(const DeliverySample& sample, bool isMarked);
 
   void
   enqueueForRetransmission(uint64_t segNo);
@@ -189,6 +261,9 @@ PUBLIC_WITH_TESTS_ELSE_PRIVATE:
 
 PUBLIC_WITH_TESTS_ELSE_PROTECTED:
   static constexpr double MIN_SSTHRESH = 2.0;
+  static constexpr double MARK_FRACTION_GAIN = 1.0 / 16; ///< weight of the last round trip (DCTCP's g)
+  /// how far behind schedule paced Interests may catch up, e.g. after the timer fired late
+  static constexpr time::nanoseconds MAX_PACING_LAG = time::milliseconds(1);
 
   double m_cwnd; ///< current congestion window size (in segments)
   double m_ssthresh; ///< current slow start threshold
@@ -196,29 +271,44 @@ PUBLIC_WITH_TESTS_ELSE_PROTECTED:
 
 PUBLIC_WITH_TESTS_ELSE_PRIVATE:
   Scheduler m_scheduler;
-  scheduler::ScopedEventId m_checkRtoEvent;
+
+  scheduler::ScopedEventId m_pacingEvent;
+  bool m_isPacingTimerArmed;
+  time::steady_clock::TimePoint m_nextSendTime; ///< earliest time of the next paced Interest
+
+  uint64_t m_nDelivered; ///< # of segments received, for delivery rate samples
+  time::steady_clock::TimePoint m_deliveredTime; ///< time of the last delivery
 
   uint64_t m_highData; ///< the highest segment number of the Data packet the consumer has received so far
   uint64_t m_highInterest; ///< the highest segment number of the Interests the consumer has sent so far
   uint64_t m_recPoint; ///< the value of m_highInterest when a packet loss event occurred,
                        ///< it remains fixed until the next packet loss event happens
+  uint64_t m_nextLossCheckSegNo; ///< lowest segment not yet checked by detectLostSegments()
+
+  double m_markFraction; ///< moving average of the fraction of marked Data (DCTCP's alpha)
+  uint64_t m_markRoundEnd; ///< delivered count that ends the current round trip
+  uint64_t m_nRoundDelivered; ///< # of Data received in the current round trip
+  uint64_t m_nRoundMarked; ///< # of those that were marked
 
   int64_t m_nInFlight; ///< # of segments in flight
   int64_t m_nLossDecr; ///< # of window decreases caused by packet loss
   int64_t m_nMarkDecr; ///< # of window decreases caused by congestion marks
   int64_t m_nTimeouts; ///< # of timed out segments
+  int64_t m_nFastRetx; ///< # of segments retransmitted because later segments were received
   int64_t m_nSkippedRetx; ///< # of segments queued for retransmission but received before the
                           ///< retransmission occurred
   int64_t m_nRetransmitted; ///< # of retransmitted segments
   int64_t m_nCongMarks; ///< # of data packets with congestion mark
   int64_t m_nSent; ///< # of interest packets sent out (including retransmissions)
-
-  std::unordered_map<uint64_t, SegmentInfo> m_segmentInfo; ///< keeps all the internal information
-                                                           ///< on sent but not acked segments
-  std::unordered_map<uint64_t, int> m_retxCount; ///< maps segment number to its retransmission count;
-                                                 ///< if the count reaches to the maximum number of
-                                                 ///< timeout/nack retries, the pipeline will be aborted
-  std::queue<uint64_t> m_retxQueue;
+  int64_t m_nBackpressured; ///< # of window increases skipped because of backpressure
+
+  SegmentTable m_segmentInfo; ///< keeps all the internal information on sent but not acked
+                              ///< segments; if the retransmission count of a segment reaches the
+                              ///< maximum number of timeout/nack retries, the pipeline is aborted
+  RtoTimer m_rtoTimer;
+  std::priority_queue<uint64_t, std::vector<uint64_t>,
+                      std::greater<uint64_t>> m_retxQueue; ///< lowest segment first, it holds back
+                                                           ///< the most content in the consumer
 
   bool m_hasFailure;
   uint64_t m_failedSegNo;
@@ -0,0 +1,276 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016-2019, Regents of the University of California,
+ *                          Colorado State University,
+ *                          University Pierre & Marie Curie, Sorbonne University.
+ *
+ * This file is part of ndn-tools (Named Data Networking Essential Tools).
+ * See AUTHORS.md for complete list of ndn-tools authors and contributors.
+ *
+ * ndn-tools is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-tools is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-tools, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pipeline-interests-bbr.hpp"
+
+#include <ndn-cxx/util/random.hpp>
+
+#include <cmath>
+
+namespace ndn {
+namespace chunks {
+
+constexpr size_t PipelineInterestsBbr::BW_WINDOW_ROUNDS;
+constexpr double PipelineInterestsBbr::MIN_CWND;
+
+/// gain that doubles the delivery rate every round trip
+static const double HIGH_GAIN = 2.0 / std::log(2.0);
+/// pacing gains of the ProbeBw phases, each lasting one min RTT
+static const double PROBE_BW_GAINS[] = {1.25, 0.75, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0};
+static const size_t PROBE_BW_CYCLE_LENGTH = sizeof(PROBE_BW_GAINS) / sizeof(PROBE_BW_GAINS[0]);
+static const double PROBE_BW_CWND_GAIN = 2.0;
+/// Startup ends once the bandwidth grew by less than this factor for FULL_BW_ROUNDS rounds
+static const double FULL_BW_THRESHOLD = 1.25;
+static const int FULL_BW_ROUNDS = 3;
+static const time::seconds MIN_RTT_WINDOW(10);
+static const time::milliseconds PROBE_RTT_DURATION(200);
+
+PipelineInterestsBbr::PipelineInterestsBbr(Face& face, RttEstimatorWithStats& rttEstimator,
+                                           const Options& opts)
+  : PipelineInterestsAdaptive(face, rttEstimator, opts)
+  , m_pacingGain(HIGH_GAIN)
+  , m_cwndGain(HIGH_GAIN)
+  , m_minRttStamp(time::steady_clock::now())
+  , m_probeRttDone(time::steady_clock::TimePoint::max())
+{
+  if (m_options.isVerbose) {
+    printOptions();
+  }
+}
+
+void
+PipelineInterestsBbr::increaseWindow()
+{
+  if (m_mode == Mode::ProbeRtt) {
+    return; // held at MIN_CWND until the propagation delay has been measured
+  }
+
+  double target = m_cwndGain * getBdp();
+  if (target <= 0.0) {
+    m_cwnd += 1.0; // no model of the path yet, grow like slow start
+  }
+  else if (m_isFullPipe) {
+    m_cwnd = std::min(m_cwnd + 1.0, target);
+  }
+  else if (m_cwnd < target) {
+    m_cwnd += 1.0;
+  }
+  m_cwnd = std::max(m_cwnd, MIN_CWND);
+
+  emitSignal(afterCwndChange, time::steady_clock::now() - getStartTime(), m_cwnd);
+}
+
+void
+PipelineInterestsBbr::decreaseWindow()
+{
+  // a timeout or a congestion mark is not taken as a sign of congestion on its own:
+  // the data in flight is already bounded by the bandwidth-delay product
+}
+
+void
+PipelineInterestsBbr::decreaseWindowForMarks(double)
+{
+  // see decreaseWindow()
+}
+
+void
+PipelineInterestsBbr::onDelivery(const DeliverySample& sample)
+{
+  auto now = time::steady_clock::now();
+
+  // a round trip ends when a segment requested after its start is delivered
+  m_isRoundStart = false;
+  if (sample.priorDelivered >= m_nextRoundDelivered) {
+    m_nextRoundDelivered = sample.priorDelivered + sample.nDelivered;
+    m_round++;
+    m_isRoundStart = true;
+  }
+
+  updateBandwidth(sample);
+  checkFullPipe();
+
+  if (m_mode == Mode::Startup && m_isFullPipe) {
+    m_mode = Mode::Drain;
+    m_pacingGain = 1.0 / HIGH_GAIN;
+    m_cwndGain = HIGH_GAIN;
+  }
+  if (m_mode == Mode::Drain && getNInFlight() <= getBdp()) {
+    enterProbeBw(now);
+  }
+  if (m_mode == Mode::ProbeBw) {
+    updateProbeBwCycle(now);
+  }
+
+  updateMinRtt(sample, now);
+}
+
+time::nanoseconds
+PipelineInterestsBbr::getPacingInterval() const
+{
+  double rate = m_pacingGain * m_btlBw;
+  if (rate <= 0.0) {
+    return time::nanoseconds::zero();
+  }
+  return time::nanoseconds(static_cast<time::nanoseconds::rep>(1e9 / rate));
+}
+
+void
+PipelineInterestsBbr::updateBandwidth(const DeliverySample& sample)
+{
+  if (sample.nDelivered == 0 || sample.interval <= time::nanoseconds::zero()) {
+    return;
+  }
+  // deliveries bunched over less than the propagation delay do not reflect the bottleneck
+  if (m_minRtt != time::nanoseconds::max() && sample.interval < m_minRtt) {
+    return;
+  }
+
+  double rate = sample.nDelivered / (sample.interval.count() / 1e9);
+  BandwidthSample& slot = m_bwSamples[m_round % BW_WINDOW_ROUNDS];
+  if (slot.round != m_round) {
+    slot.round = m_round;
+    slot.rate = rate;
+  }
+  else {
+    slot.rate = std::max(slot.rate, rate);
+  }
+
+  m_btlBw = 0.0;
+  for (const auto& bw : m_bwSamples) {
+    if (bw.round + BW_WINDOW_ROUNDS > m_round) {
+      m_btlBw = std::max(m_btlBw, bw.rate);
+    }
+  }
+}
+
+void
+PipelineInterestsBbr::checkFullPipe()
+{
+  if (m_isFullPipe || !m_isRoundStart) {
+    return;
+  }
+
+  if (m_btlBw >= m_fullBw * FULL_BW_THRESHOLD) {
+    m_fullBw = m_btlBw;
+    m_nFullBwRounds = 0;
+    return;
+  }
+  if (++m_nFullBwRounds >= FULL_BW_ROUNDS) {
+    m_isFullPipe = true;
+    if (m_options.isVerbose) {
+      std::cerr << "BBR: bottleneck bandwidth reached, " << m_btlBw << " segments/s" << std::endl;
+    }
+  }
+}
+
+void
+PipelineInterestsBbr::enterProbeBw(time::steady_clock::TimePoint now)
+{
+  m_mode = Mode::ProbeBw;
+  m_cwndGain = PROBE_BW_CWND_GAIN;
+
+  // start at a random phase, except the one draining the queue
+  m_cycleIndex = random::generateWord32() % (PROBE_BW_CYCLE_LENGTH - 1);
+  if (m_cycleIndex >= 1) {
+    m_cycleIndex++;
+  }
+  m_pacingGain = PROBE_BW_GAINS[m_cycleIndex];
+  m_cycleStart = now;
+}
+
+void
+PipelineInterestsBbr::updateProbeBwCycle(time::steady_clock::TimePoint now)
+{
+  bool isFullLength = now - m_cycleStart > m_minRtt;
+  // the draining phase ends early once the queue it drains is gone
+  bool isDrained = m_pacingGain < 1.0 && getNInFlight() <= getBdp();
+  if (!isFullLength && !isDrained) {
+    return;
+  }
+
+  m_cycleIndex = (m_cycleIndex + 1) % PROBE_BW_CYCLE_LENGTH;
+  m_pacingGain = PROBE_BW_GAINS[m_cycleIndex];
+  m_cycleStart = now;
+}
+
+void
+PipelineInterestsBbr::updateMinRtt(const DeliverySample& sample, time::steady_clock::TimePoint now)
+{
+  bool isExpired = now - m_minRttStamp > MIN_RTT_WINDOW;
+  if (sample.rtt && (*sample.rtt <= m_minRtt || isExpired)) {
+    m_minRtt = *sample.rtt;
+    m_minRttStamp = now;
+  }
+
+  if (isExpired && m_mode != Mode::ProbeRtt) {
+    // the path may have changed, drain the queue to measure the propagation delay again
+    m_mode = Mode::ProbeRtt;
+    m_pacingGain = 1.0;
+    m_cwndGain = 1.0;
+    m_priorCwnd = m_cwnd;
+    m_cwnd = std::min(m_cwnd, MIN_CWND);
+    m_probeRttDone = time::steady_clock::TimePoint::max();
+    emitSignal(afterCwndChange, now - getStartTime(), m_cwnd);
+  }
+
+  if (m_mode != Mode::ProbeRtt) {
+    return;
+  }
+
+  if (m_probeRttDone == time::steady_clock::TimePoint::max()) {
+    if (getNInFlight() <= MIN_CWND) {
+      // stay there for PROBE_RTT_DURATION and at least one round trip
+      m_probeRttDone = now + PROBE_RTT_DURATION;
+      m_isProbeRttRoundDone = false;
+      m_nextRoundDelivered = sample.priorDelivered + sample.nDelivered;
+    }
+    return;
+  }
+
+  if (m_isRoundStart) {
+    m_isProbeRttRoundDone = true;
+  }
+  if (m_isProbeRttRoundDone && now >= m_probeRttDone) {
+    m_minRttStamp = now;
+    m_cwnd = std::max(m_cwnd, m_priorCwnd);
+    emitSignal(afterCwndChange, now - getStartTime(), m_cwnd);
+    if (m_isFullPipe) {
+      enterProbeBw(now);
+    }
+    else {
+      m_mode = Mode::Startup;
+      m_pacingGain = HIGH_GAIN;
+      m_cwndGain = HIGH_GAIN;
+    }
+  }
+}
+
+double
+PipelineInterestsBbr::getBdp() const
+{
+  if (m_btlBw <= 0.0 || m_minRtt == time::nanoseconds::max()) {
+    return 0.0;
+  }
+  return m_btlBw * (m_minRtt.count() / 1e9);
+}
+
+} // namespace chunks
+} // namespace ndn
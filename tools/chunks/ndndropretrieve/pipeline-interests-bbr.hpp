@@ -0,0 +1,131 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016-2019, Regents of the University of California,
+ *                          Colorado State University,
+ *                          University Pierre & Marie Curie, Sorbonne University.
+ *
+ * This file is part of ndn-tools (Named Data Networking Essential Tools).
+ * See AUTHORS.md for complete list of ndn-tools authors and contributors.
+ *
+ * ndn-tools is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-tools is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-tools, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NDN_TOOLS_CHUNKS_CATCHUNKS_PIPELINE_INTERESTS_BBR_HPP
+#define NDN_TOOLS_CHUNKS_CATCHUNKS_PIPELINE_INTERESTS_BBR_HPP
+
+#include "pipeline-interests-adaptive.hpp"
+
+#include <array>
+
+namespace ndn {
+namespace chunks {
+
+/**
+ * @brief Sizes the window from a model of the path instead of reacting to losses.
+ *
+ * Estimates the bottleneck bandwidth as the highest delivery rate over the last 10 round trips
+ * and the propagation delay as the lowest RTT over the last 10 seconds, then paces Interests at
+ * the bandwidth estimate and keeps about two bandwidth-delay products in flight. Timeouts,
+ * Nacks and congestion marks do not shrink the window, so random loss on wireless links does
+ * not collapse the throughput.
+ *
+ * This implementation follows BBR version 1,
+ * https://tools.ietf.org/html/draft-cardwell-iccrg-bbr-congestion-control-00, with windows and
+ * rates counted in segments.
+ */
+class PipelineInterestsBbr final : public PipelineInterestsAdaptive
+{
+public:
+  PipelineInterestsBbr(Face& face, RttEstimatorWithStats& rttEstimator, const Options& opts);
+
+private:
+  void
+  increaseWindow() final;
+
+  void
+  decreaseWindow() final;
+
+  void
+  decreaseWindowForMarks(double fraction) final;
+
+  void
+  onDelivery(const DeliverySample& sample) final;
+
+  time::nanoseconds
+  getPacingInterval() const final;
+
+  void
+  updateBandwidth(const DeliverySample& sample);
+
+  void
+  checkFullPipe();
+
+  void
+  updateProbeBwCycle(time::steady_clock::TimePoint now);
+
+  void
+  updateMinRtt(const DeliverySample& sample, time::steady_clock::TimePoint now);
+
+  void
+  enterProbeBw(time::steady_clock::TimePoint now);
+
+  /**
+   * @return estimated bandwidth-delay product, in segments, or zero if there is no estimate yet
+   */
+  double
+  getBdp() const;
+
+private:
+  enum class Mode {
+    Startup,  ///< doubles the delivery rate every round trip until it stops growing
+    Drain,    ///< drains the queue built during Startup
+    ProbeBw,  ///< cycles the pacing rate around the bandwidth estimate
+    ProbeRtt, ///< shrinks the window to measure the propagation delay again
+  };
+
+  struct BandwidthSample
+  {
+    uint64_t round = 0;
+    double rate = 0.0; ///< segments per second
+  };
+
+  static constexpr size_t BW_WINDOW_ROUNDS = 10;
+  static constexpr double MIN_CWND = 4.0;
+
+  Mode m_mode = Mode::Startup;
+  double m_pacingGain;
+  double m_cwndGain;
+
+  std::array<BandwidthSample, BW_WINDOW_ROUNDS> m_bwSamples; ///< highest rate of each recent round
+  double m_btlBw = 0.0; ///< bottleneck bandwidth estimate, in segments per second
+  uint64_t m_round = 0;
+  uint64_t m_nextRoundDelivered = 0; ///< delivered count that ends the current round
+  bool m_isRoundStart = false;
+
+  double m_fullBw = 0.0; ///< bandwidth reached before the last 25% increase
+  int m_nFullBwRounds = 0; ///< rounds since that increase
+  bool m_isFullPipe = false;
+
+  size_t m_cycleIndex = 0;
+  time::steady_clock::TimePoint m_cycleStart;
+
+  time::nanoseconds m_minRtt = time::nanoseconds::max();
+  time::steady_clock::TimePoint m_minRttStamp;
+  time::steady_clock::TimePoint m_probeRttDone; ///< max() until the window has drained
+  bool m_isProbeRttRoundDone = false;
+  double m_priorCwnd = 0.0; ///< window saved when entering ProbeRtt
+};
+
+} // namespace chunks
+} // namespace ndn
+
+#endif // NDN_TOOLS_CHUNKS_CATCHUNKS_PIPELINE_INTERESTS_BBR_HPP
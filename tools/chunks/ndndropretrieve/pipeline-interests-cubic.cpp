@@ -32,6 +32,13 @@ namespace chunks {
 
 constexpr double CUBIC_C = 0.4;
 
+// HyStart parameters, as in Linux
+constexpr double HYSTART_LOW_WINDOW = 16.0; ///< smaller windows are left to slow start
+constexpr int HYSTART_MIN_SAMPLES = 8; ///< RTT samples per round for the delay increase check
+constexpr time::milliseconds HYSTART_ACK_DELTA(2); ///< largest gap between Data of a train
+constexpr time::milliseconds HYSTART_DELAY_MIN(4);
+constexpr time::milliseconds HYSTART_DELAY_MAX(16);
+
 PipelineInterestsCubic::PipelineInterestsCubic(Face& face, RttEstimatorWithStats& rttEstimator,
                                                const Options& opts)
   : PipelineInterestsAdaptive(face, rttEstimator, opts)
@@ -40,7 +47,8 @@ PipelineInterestsCubic::PipelineInterestsCubic(Face& face, RttEstimatorWithStats
   if (m_options.isVerbose) {
     printOptions();
     std::cerr << "\tCubic beta = " << m_options.cubicBeta << "\n"
-              << "\tFast convergence = " << (m_options.enableFastConv ? "yes" : "no") << "\n";
+              << "\tFast convergence = " << (m_options.enableFastConv ? "yes" : "no") << "\n"
+              << "\tHyStart = " << (m_options.disableHystart ? "no" : "yes") << "\n";
   }
 }
 
@@ -111,5 +119,85 @@ PipelineInterestsCubic::decreaseWindow()
   emitSignal(afterCwndChange, time::steady_clock::now() - getStartTime(), m_cwnd);
 }
 
+void
+PipelineInterestsCubic::decreaseWindowForMarks(double fraction)
+{
+  m_lastWmax = m_cwnd;
+  m_wmax = m_cwnd;
+  m_ssthresh = std::max(m_options.initCwnd, m_cwnd * (1 - fraction));
+  m_cwnd = m_ssthresh;
+  // the decrease is usually much smaller than cubicBeta's, which the epoch must account for
+  startEpoch(time::steady_clock::now());
+
+  emitSignal(afterCwndChange, time::steady_clock::now() - getStartTime(), m_cwnd);
+}
+
+void
+PipelineInterestsCubic::onDelivery(const DeliverySample& sample)
+{
+  if (m_options.disableHystart || m_isHystartDone || m_cwnd >= m_ssthresh)
+    return;
+
+  auto now = time::steady_clock::now();
+  // a round ends when Data requested after it started arrives
+  if (sample.priorDelivered >= m_roundEndDelivered) {
+    m_roundEndDelivered = sample.priorDelivered + sample.nDelivered;
+    m_roundStart = m_lastTrainAck = now;
+    m_roundMinRtt = time::nanoseconds::max();
+    m_nRoundSamples = 0;
+  }
+
+  // samples of retransmitted segments are left out of the estimator, like the ones used here
+  time::nanoseconds minRtt = m_rttEstimator.getMinRtt();
+  if (m_cwnd < HYSTART_LOW_WINDOW || minRtt == time::nanoseconds::max())
+    return;
+
+  // ACK train: Data keeps arriving back to back for longer than half the minimum RTT, so the
+  // window already fills the path
+  if (now - m_lastTrainAck <= HYSTART_ACK_DELTA) {
+    m_lastTrainAck = now;
+    if (now - m_roundStart > minRtt / 2) {
+      return exitSlowStart("ACK train", now);
+    }
+  }
+
+  // delay increase: the first Data of the round was queued behind the previous round's
+  if (sample.rtt && m_nRoundSamples < HYSTART_MIN_SAMPLES) {
+    m_roundMinRtt = std::min(m_roundMinRtt, *sample.rtt);
+    if (++m_nRoundSamples == HYSTART_MIN_SAMPLES) {
+      time::nanoseconds threshold = std::min<time::nanoseconds>(
+        std::max<time::nanoseconds>(minRtt / 8, HYSTART_DELAY_MIN), HYSTART_DELAY_MAX);
+      if (m_roundMinRtt > minRtt + threshold) {
+        return exitSlowStart("delay increase", now);
+      }
+    }
+  }
+}
+
+void
+PipelineInterestsCubic::exitSlowStart(const char* reason, time::steady_clock::TimePoint now)
+{
+  m_isHystartDone = true;
+  m_ssthresh = m_cwnd;
+
+  // no loss happened, so start probing above the current window right away instead of
+  // levelling off below it (like Linux, which starts the epoch with K = 0)
+  m_wmax = m_cwnd;
+  startEpoch(now);
+
+  if (m_options.isVerbose) {
+    std::cerr << "HyStart (" << reason << "): leaving slow start, cwnd = " << m_cwnd << std::endl;
+  }
+}
+
+void
+PipelineInterestsCubic::startEpoch(time::steady_clock::TimePoint now)
+{
+  // W_cubic(t) = C*(t-K)^3 + wmax equals cwnd at t = K - cubic_root((wmax-cwnd)/C)
+  const double k = std::cbrt(m_wmax * (1 - m_options.cubicBeta) / CUBIC_C);
+  const double t = k - std::cbrt((m_wmax - m_cwnd) / CUBIC_C);
+  m_lastDecrease = now - time::nanoseconds(static_cast<time::nanoseconds::rep>(t * 1e9));
+}
+
 } // namespace chunks
 } // namespace ndn
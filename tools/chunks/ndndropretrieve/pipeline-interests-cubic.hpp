@@ -36,6 +36,11 @@ namespace chunks {
  *
  * This implementation follows the RFC8312 https://tools.ietf.org/html/rfc8312
  * and the Linux kernel implementation https://github.com/torvalds/linux/blob/master/net/ipv4/tcp_cubic.c
+ *
+ * Unless Options::disableHystart is set, slow start ends early as with HyStart, when the Data of
+ * a round trip arrives in a train longer than half the minimum RTT, or when the lowest RTT of the
+ * round rises noticeably above the minimum RTT. Either means the queue at the bottleneck has
+ * started to build up.
  */
 class PipelineInterestsCubic final : public PipelineInterestsAdaptive
 {
@@ -49,10 +54,36 @@ private:
   void
   decreaseWindow() final;
 
+  void
+  decreaseWindowForMarks(double fraction) final;
+
+  /**
+   * @brief Run the HyStart checks while in slow start.
+   */
+  void
+  onDelivery(const DeliverySample& sample) final;
+
+  void
+  exitSlowStart(const char* reason, time::steady_clock::TimePoint now);
+
+  /**
+   * @brief Start a new cubic epoch in which W_cubic(t) passes through the current window now,
+   *        and levels off at m_wmax.
+   */
+  void
+  startEpoch(time::steady_clock::TimePoint now);
+
 private:
   double m_wmax = 0.0; ///< window size before last window decrease
   double m_lastWmax = 0.0; ///< last wmax
   time::steady_clock::TimePoint m_lastDecrease; ///< time of last window decrease
+
+  bool m_isHystartDone = false;
+  uint64_t m_roundEndDelivered = 0; ///< delivered count that ends the current round
+  time::steady_clock::TimePoint m_roundStart;
+  time::steady_clock::TimePoint m_lastTrainAck; ///< last Data of the current ACK train
+  time::nanoseconds m_roundMinRtt; ///< lowest of the first RTT samples of the round
+  int m_nRoundSamples = 0;
 };
 
 } // namespace chunks
@@ -35,8 +35,18 @@ namespace chunks {
 
 PipelineInterestsFixed::PipelineInterestsFixed(Face& face, const Options& opts)
   : PipelineInterests(face, opts)
+  , m_scheduler(m_face.getIoService())
 {
-  m_segmentFetchers.resize(m_options.maxPipelineSize);
+  m_slots.resize(m_options.maxPipelineSize);
+  for (size_t pipeNo = 0; pipeNo < m_slots.size(); ++pipeNo) {
+    m_slots[pipeNo].fetcher = make_unique<DataFetcher>(m_face, m_scheduler,
+                                                       m_options.maxRetriesOnTimeoutOrNack,
+                                                       m_options.maxRetriesOnTimeoutOrNack,
+                                                       bind(&PipelineInterestsFixed::handleData, this, _1, _2, pipeNo),
+                                                       bind(&PipelineInterestsFixed::handleFail, this, _2, pipeNo),
+                                                       bind(&PipelineInterestsFixed::handleFail, this, _2, pipeNo),
+                                                       m_options.isVerbose);
+  }
 
   if (m_options.isVerbose) {
     printOptions();
@@ -81,22 +91,10 @@ PipelineInterestsFixed::fetchNextSegment(std::size_t pipeNo)
   if (m_options.isVerbose)
     std::cerr << "Requesting segment #" << nextSegmentNo << std::endl;
 
-  auto interest = Interest()
-                  .setName(Name(m_prefix).appendSegment(nextSegmentNo))
-                  .setCanBePrefix(false)
-                  .setMustBeFresh(m_options.mustBeFresh)
-                  .setInterestLifetime(m_options.interestLifetime);
-
-  auto fetcher = DataFetcher::fetch(m_face, interest,
-                                    m_options.maxRetriesOnTimeoutOrNack,
-                                    m_options.maxRetriesOnTimeoutOrNack,
-                                    bind(&PipelineInterestsFixed::handleData, this, _1, _2, pipeNo),
-                                    bind(&PipelineInterestsFixed::handleFail, this, _2, pipeNo),
-                                    bind(&PipelineInterestsFixed::handleFail, this, _2, pipeNo),
-                                    m_options.isVerbose);
-
-  BOOST_ASSERT(!m_segmentFetchers[pipeNo].first || !m_segmentFetchers[pipeNo].first->isRunning());
-  m_segmentFetchers[pipeNo] = make_pair(fetcher, nextSegmentNo);
+  auto& slot = m_slots[pipeNo];
+  BOOST_ASSERT(!slot.fetcher->isRunning());
+  slot.segNo = nextSegmentNo;
+  slot.fetcher->restart(m_interestTemplate.make(nextSegmentNo));
 
   return true;
 }
@@ -104,12 +102,28 @@ PipelineInterestsFixed::fetchNextSegment(std::size_t pipeNo)
 void
 PipelineInterestsFixed::doCancel()
 {
-  for (auto& fetcher : m_segmentFetchers) {
-    if (fetcher.first)
-      fetcher.first->cancel();
+  // the fetchers are kept, because this can be reached from within one of their callbacks
+  for (auto& slot : m_slots) {
+    slot.fetcher->cancel();
   }
 
-  m_segmentFetchers.clear();
+  m_idlePipes.clear();
+}
+
+void
+PipelineInterestsFixed::doResume()
+{
+  fetchOnIdlePipes();
+}
+
+void
+PipelineInterestsFixed::fetchOnIdlePipes()
+{
+  while (!m_idlePipes.empty() && !isStopping() && !isThrottled()) {
+    size_t pipeNo = m_idlePipes.back();
+    m_idlePipes.pop_back();
+    fetchNextSegment(pipeNo);
+  }
 }
 
 void
@@ -125,22 +139,21 @@ PipelineInterestsFixed::handleData(const Interest& interest, const Data& data, s
     std::cerr << "Received segment #" << getSegmentFromPacket(data) << std::endl;
 
   onData(data);
+  if (isStopping()) // the user of the pipeline cancelled it
+    return;
 
   if (!m_hasFinalBlockId && data.getFinalBlock()) {
     m_lastSegmentNo = data.getFinalBlock()->toSegment();
     m_hasFinalBlockId = true;
 
-    for (auto& fetcher : m_segmentFetchers) {
-      if (fetcher.first == nullptr)
-        continue;
-
-      if (fetcher.second > m_lastSegmentNo) {
+    for (auto& slot : m_slots) {
+      if (slot.segNo > m_lastSegmentNo) {
         // stop trying to fetch segments that are beyond m_lastSegmentNo
-        fetcher.first->cancel();
+        slot.fetcher->cancel();
       }
-      else if (fetcher.first->hasError()) { // fetcher.second <= m_lastSegmentNo
+      else if (slot.fetcher->hasError()) { // slot.segNo <= m_lastSegmentNo
         // there was an error while fetching a segment that is part of the content
-        return onFailure("Failure retrieving segment #" + to_string(fetcher.second));
+        return onFailure("Failure retrieving segment #" + to_string(slot.segNo));
       }
     }
   }
@@ -151,7 +164,8 @@ PipelineInterestsFixed::handleData(const Interest& interest, const Data& data, s
     }
   }
   else {
-    fetchNextSegment(pipeNo);
+    m_idlePipes.push_back(pipeNo);
+    fetchOnIdlePipes();
   }
 }
 
@@ -161,20 +175,18 @@ void PipelineInterestsFixed::handleFail(const std::string& reason, std::size_t p
     return;
 
   // if the failed segment is definitely part of the content, raise a fatal error
-  if (m_hasFinalBlockId && m_segmentFetchers[pipeNo].second <= m_lastSegmentNo)
+  uint64_t failedSegNo = m_slots[pipeNo].segNo;
+  if (m_hasFinalBlockId && failedSegNo <= m_lastSegmentNo)
     return onFailure(reason);
 
   if (!m_hasFinalBlockId) {
     bool areAllFetchersStopped = true;
-    for (auto& fetcher : m_segmentFetchers) {
-      if (fetcher.first == nullptr)
-        continue;
-
+    for (auto& slot : m_slots) {
       // cancel fetching all segments that follow
-      if (fetcher.second > m_segmentFetchers[pipeNo].second) {
-        fetcher.first->cancel();
+      if (slot.segNo > failedSegNo) {
+        slot.fetcher->cancel();
       }
-      else if (fetcher.first->isRunning()) { // fetcher.second <= m_segmentFetchers[pipeNo].second
+      else if (slot.fetcher->isRunning()) { // slot.segNo <= failedSegNo
         areAllFetchersStopped = false;
       }
     }
@@ -46,6 +46,10 @@ class DataFetcher;
  *
  * No guarantees are made as to the order in which segments are fetched or callbacks are invoked,
  * i.e. out-of-order delivery is possible.
+ *
+ * Each of the N pipes owns a DataFetcher that is created with the pipeline and restarted for
+ * every segment assigned to the pipe, so no fetcher, scheduler or callback is allocated per
+ * segment.
  */
 class PipelineInterestsFixed final : public PipelineInterests
 {
@@ -67,6 +71,9 @@ private:
   void
   doCancel() final;
 
+  void
+  doResume() final;
+
   /**
    * @brief fetch the next segment that has not been requested yet
    *
@@ -75,6 +82,12 @@ private:
   bool
   fetchNextSegment(size_t pipeNo);
 
+  /**
+   * @brief fetch the next segments on the idle pipes, unless the pipeline is throttled
+   */
+  void
+  fetchOnIdlePipes();
+
   void
   handleData(const Interest& interest, const Data& data, size_t pipeNo);
 
@@ -82,7 +95,15 @@ private:
   handleFail(const std::string& reason, size_t pipeNo);
 
 private:
-  std::vector<std::pair<shared_ptr<DataFetcher>, uint64_t>> m_segmentFetchers;
+  struct FetchSlot
+  {
+    unique_ptr<DataFetcher> fetcher;
+    uint64_t segNo = 0; ///< segment most recently assigned to the pipe
+  };
+
+  Scheduler m_scheduler; ///< shared by the fetchers of all pipes
+  std::vector<FetchSlot> m_slots;
+  std::vector<size_t> m_idlePipes; ///< pipes whose next segment was held back by throttling
 
   /**
    * true if one or more segment fetchers encountered an error; if m_hasFinalBlockId
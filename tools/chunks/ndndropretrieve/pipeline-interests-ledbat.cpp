@@ -0,0 +1,140 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016-2019, Regents of the University of California,
+ *                          Colorado State University,
+ *                          University Pierre & Marie Curie, Sorbonne University.
+ *
+ * This file is part of ndn-tools (Named Data Networking Essential Tools).
+ * See AUTHORS.md for complete list of ndn-tools authors and contributors.
+ *
+ * ndn-tools is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-tools is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-tools, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pipeline-interests-ledbat.hpp"
+
+#include <algorithm>
+
+namespace ndn {
+namespace chunks {
+
+constexpr size_t PipelineInterestsLedbat::CURRENT_FILTER;
+constexpr size_t PipelineInterestsLedbat::BASE_HISTORY;
+constexpr double PipelineInterestsLedbat::MIN_CWND;
+
+static const double LEDBAT_GAIN = 1.0;
+/// segments the window may exceed the segments in flight by
+static const double ALLOWED_INCREASE = 1.0;
+
+PipelineInterestsLedbat::PipelineInterestsLedbat(Face& face, RttEstimatorWithStats& rttEstimator,
+                                                 const Options& opts)
+  : PipelineInterestsAdaptive(face, rttEstimator, opts)
+  , m_lastRollover(time::steady_clock::now())
+{
+  if (m_options.isVerbose) {
+    printOptions();
+    std::cerr << "\tLEDBAT target queuing delay = " << m_options.ledbatTarget << "\n";
+  }
+}
+
+void
+PipelineInterestsLedbat::increaseWindow()
+{
+  auto queuingDelay = getQueuingDelay();
+  double target = m_options.ledbatTarget.count();
+  if (queuingDelay && queuingDelay->count() / 1e6 > target) {
+    return; // onDelivery() shrinks the window
+  }
+
+  if (m_cwnd < m_ssthresh && (!queuingDelay || queuingDelay->count() / 1e6 < target * 3 / 4)) {
+    m_cwnd += 1.0; // slow start
+  }
+  else {
+    if (m_cwnd < m_ssthresh) {
+      m_ssthresh = m_cwnd; // slow start ends at 3/4 of the target
+    }
+    // proportionally to the distance below the target
+    double offTarget = queuingDelay ? (target - queuingDelay->count() / 1e6) / target : 1.0;
+    m_cwnd += LEDBAT_GAIN * offTarget / m_cwnd;
+  }
+
+  // do not grow a window that the segments in flight do not use
+  m_cwnd = std::min(m_cwnd, getNInFlight() + 1 + ALLOWED_INCREASE);
+  m_cwnd = std::max(m_cwnd, MIN_CWND);
+
+  emitSignal(afterCwndChange, time::steady_clock::now() - getStartTime(), m_cwnd);
+}
+
+void
+PipelineInterestsLedbat::decreaseWindow()
+{
+  m_ssthresh = std::max(MIN_CWND, m_cwnd / 2);
+  m_cwnd = m_ssthresh;
+
+  emitSignal(afterCwndChange, time::steady_clock::now() - getStartTime(), m_cwnd);
+}
+
+void
+PipelineInterestsLedbat::onDelivery(const DeliverySample& sample)
+{
+  if (sample.rtt) {
+    updateDelays(*sample.rtt);
+  }
+
+  // above the target, the window shrinks on every delivery, even those on which it may not grow
+  // because the user of the pipeline cannot keep up
+  auto queuingDelay = getQueuingDelay();
+  double target = m_options.ledbatTarget.count();
+  if (!queuingDelay || queuingDelay->count() / 1e6 <= target) {
+    return;
+  }
+
+  m_ssthresh = std::min(m_ssthresh, m_cwnd); // no slow start above the target
+  double offTarget = (target - queuingDelay->count() / 1e6) / target;
+  m_cwnd = std::max(m_cwnd + LEDBAT_GAIN * offTarget / m_cwnd, MIN_CWND);
+
+  emitSignal(afterCwndChange, time::steady_clock::now() - getStartTime(), m_cwnd);
+}
+
+void
+PipelineInterestsLedbat::updateDelays(time::nanoseconds rtt)
+{
+  m_currentDelays.push_back(rtt);
+  if (m_currentDelays.size() > CURRENT_FILTER) {
+    m_currentDelays.pop_front();
+  }
+
+  auto now = time::steady_clock::now();
+  if (m_baseDelays.empty() || now - m_lastRollover >= time::minutes(1)) {
+    m_baseDelays.push_back(rtt);
+    if (m_baseDelays.size() > BASE_HISTORY) {
+      m_baseDelays.pop_front();
+    }
+    m_lastRollover = now;
+  }
+  else {
+    m_baseDelays.back() = std::min(m_baseDelays.back(), rtt);
+  }
+}
+
+optional<time::nanoseconds>
+PipelineInterestsLedbat::getQueuingDelay() const
+{
+  if (m_currentDelays.empty()) {
+    return nullopt;
+  }
+  auto currentDelay = *std::min_element(m_currentDelays.begin(), m_currentDelays.end());
+  auto baseDelay = *std::min_element(m_baseDelays.begin(), m_baseDelays.end());
+  return currentDelay - baseDelay;
+}
+
+} // namespace chunks
+} // namespace ndn
@@ -0,0 +1,88 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016-2019, Regents of the University of California,
+ *                          Colorado State University,
+ *                          University Pierre & Marie Curie, Sorbonne University.
+ *
+ * This file is part of ndn-tools (Named Data Networking Essential Tools).
+ * See AUTHORS.md for complete list of ndn-tools authors and contributors.
+ *
+ * ndn-tools is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-tools is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-tools, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NDN_TOOLS_CHUNKS_CATCHUNKS_PIPELINE_INTERESTS_LEDBAT_HPP
+#define NDN_TOOLS_CHUNKS_CATCHUNKS_PIPELINE_INTERESTS_LEDBAT_HPP
+
+#include "pipeline-interests-adaptive.hpp"
+
+#include <deque>
+
+namespace ndn {
+namespace chunks {
+
+/**
+ * @brief Delay-based window for background retrievals.
+ *
+ * Grows the window while the queuing delay, the RTT above the lowest RTT seen over the last
+ * ten minutes, is below a target and shrinks it in proportion once the delay exceeds the
+ * target, so a bulk retrieval only uses capacity that other traffic leaves unused. A loss
+ * halves the window.
+ *
+ * This implementation follows RFC 6817 https://tools.ietf.org/html/rfc6817, measuring the
+ * round-trip delay rather than the one-way delay, with the slow start of LEDBAT++ that ends
+ * once the queuing delay reaches 3/4 of the target.
+ */
+class PipelineInterestsLedbat final : public PipelineInterestsAdaptive
+{
+public:
+  PipelineInterestsLedbat(Face& face, RttEstimatorWithStats& rttEstimator, const Options& opts);
+
+private:
+  /**
+   * @brief Grow the window while the queuing delay is below the target
+   */
+  void
+  increaseWindow() final;
+
+  void
+  decreaseWindow() final;
+
+  /**
+   * @brief Update the delay filters and shrink the window while the queuing delay is above
+   *        the target
+   */
+  void
+  onDelivery(const DeliverySample& sample) final;
+
+  void
+  updateDelays(time::nanoseconds rtt);
+
+  /**
+   * @return current delay minus base delay, or nullopt before the first RTT sample
+   */
+  optional<time::nanoseconds>
+  getQueuingDelay() const;
+
+private:
+  static constexpr size_t CURRENT_FILTER = 4;
+  static constexpr size_t BASE_HISTORY = 10;
+  static constexpr double MIN_CWND = 2.0;
+
+  std::deque<time::nanoseconds> m_currentDelays; ///< last CURRENT_FILTER RTT samples
+  std::deque<time::nanoseconds> m_baseDelays; ///< lowest RTT of each of the last BASE_HISTORY minutes
+  time::steady_clock::TimePoint m_lastRollover; ///< start of the minute of m_baseDelays.back()
+};
+
+} // namespace chunks
+} // namespace ndn
+
+#endif // NDN_TOOLS_CHUNKS_CATCHUNKS_PIPELINE_INTERESTS_LEDBAT_HPP
@@ -0,0 +1,488 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016-2019, Regents of the University of California,
+ *                          Colorado State University,
+ *                          University Pierre & Marie Curie, Sorbonne University.
+ *
+ * This file is part of ndn-tools (Named Data Networking Essential Tools).
+ * See AUTHORS.md for complete list of ndn-tools authors and contributors.
+ *
+ * ndn-tools is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-tools is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-tools, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "pipeline-interests-multi-source.hpp"
+#include "data-fetcher.hpp"
+
+#include <cmath>
+
+namespace ndn {
+namespace chunks {
+
+constexpr double PipelineInterestsMultiSource::MIN_SSTHRESH;
+constexpr int PipelineInterestsMultiSource::MAX_CONSECUTIVE_FAILURES;
+
+PipelineInterestsMultiSource::Source::Source(const Name& hint,
+                                             shared_ptr<const RttEstimator::Options> rttOptions,
+                                             double cwnd, double ssthresh)
+  : hint(hint)
+  , rttEstimator(std::move(rttOptions))
+  , cwnd(cwnd)
+  , ssthresh(ssthresh)
+{
+}
+
+PipelineInterestsMultiSource::PipelineInterestsMultiSource(Face& face, const std::vector<Name>& sources,
+                                                           shared_ptr<const RttEstimator::Options> rttOptions,
+                                                           const Options& opts)
+  : PipelineInterests(face, opts)
+  , m_scheduler(m_face.getIoService())
+  , m_rtoTimer(m_scheduler, m_segmentInfo, [this] { checkRto(); })
+{
+  BOOST_ASSERT(!sources.empty());
+  for (const auto& hint : sources) {
+    m_sources.push_back(make_unique<Source>(hint, rttOptions, m_options.initCwnd, m_options.initSsthresh));
+  }
+
+  if (m_options.isVerbose) {
+    printOptions();
+    std::cerr << "\tInitial congestion window size = " << m_options.initCwnd << "\n"
+              << "\tAdditive increase step = " << m_options.aiStep << "\n"
+              << "\tMultiplicative decrease factor = " << m_options.mdCoef << "\n"
+              << "\tReordering threshold = " << m_options.reorderThreshold << " segments\n"
+              << "\tSources =";
+    for (const auto& source : m_sources) {
+      std::cerr << " " << (source->hint.empty() ? "(content name)" : source->hint.toUri());
+    }
+    std::cerr << "\n";
+  }
+}
+
+PipelineInterestsMultiSource::~PipelineInterestsMultiSource()
+{
+  cancel();
+}
+
+void
+PipelineInterestsMultiSource::doRun()
+{
+  if (allSegmentsReceived()) {
+    cancel();
+    if (!m_options.isQuiet) {
+      printSummary();
+    }
+    return;
+  }
+
+  for (auto& source : m_sources) {
+    source->interestTemplate = InterestTemplate(m_prefix, m_options.mustBeFresh,
+                                                m_options.interestLifetime, source->hint);
+  }
+
+  schedulePackets();
+}
+
+void
+PipelineInterestsMultiSource::doCancel()
+{
+  m_rtoTimer.cancel();
+  for (auto& source : m_sources) {
+    source->resumeEvent.cancel();
+  }
+  m_segmentInfo.clear();
+}
+
+void
+PipelineInterestsMultiSource::doResume()
+{
+  schedulePackets();
+}
+
+void
+PipelineInterestsMultiSource::checkRto()
+{
+  if (isStopping())
+    return;
+
+  bool hasTimeout = false;
+  m_rtoTimer.popExpired([this, &hasTimeout] (uint64_t segNo, SegmentInfo& segInfo) {
+    recordFailure(segNo, segInfo.sourceIdx, true);
+    hasTimeout = true;
+  });
+
+  if (hasTimeout) {
+    schedulePackets();
+  }
+}
+
+bool
+PipelineInterestsMultiSource::sendInterest(uint64_t segNo, size_t sourceIdx, bool isRetransmission)
+{
+  if (isStopping())
+    return false;
+
+  if (m_hasFinalBlockId && segNo > m_lastSegmentNo)
+    return false;
+
+  if (!isRetransmission && m_hasFailure)
+    return false;
+
+  Source& source = *m_sources[sourceIdx];
+  if (m_options.isVerbose) {
+    std::cerr << (isRetransmission ? "Retransmitting" : "Requesting")
+              << " segment #" << segNo << " from source #" << sourceIdx << std::endl;
+  }
+
+  SegmentInfo& segInfo = m_segmentInfo.insert(segNo);
+  if (isRetransmission) {
+    if (++segInfo.nRetx > m_options.maxRetriesOnTimeoutOrNack &&
+        m_options.maxRetriesOnTimeoutOrNack != DataFetcher::MAX_RETRIES_INFINITE) {
+      handleFail(segNo, "Reached the maximum number of retries (" +
+                 to_string(m_options.maxRetriesOnTimeoutOrNack) +
+                 ") while retrieving segment #" + to_string(segNo));
+      return false;
+    }
+  }
+
+  segInfo.interestHdl = m_face.expressInterest(source.interestTemplate.make(segNo),
+    bind(&PipelineInterestsMultiSource::handleData, this, _1, _2, sourceIdx),
+    bind(&PipelineInterestsMultiSource::handleNack, this, _1, _2, sourceIdx),
+    bind(&PipelineInterestsMultiSource::handleLifetimeExpiration, this, _1, sourceIdx));
+  segInfo.timeSent = time::steady_clock::now();
+  segInfo.rto = source.rttEstimator.getEstimatedRto();
+  segInfo.sourceIdx = sourceIdx;
+  segInfo.state = isRetransmission ? SegmentState::Retransmitted : SegmentState::FirstTimeSent;
+
+  source.nInFlight++;
+  m_rtoTimer.add(segNo);
+  return true;
+}
+
+void
+PipelineInterestsMultiSource::schedulePackets()
+{
+  auto now = time::steady_clock::now();
+
+  // retransmissions first
+  while (!m_retxQueue.empty()) {
+    uint64_t segNo = m_retxQueue.top();
+    const SegmentInfo* segInfo = m_segmentInfo.find(segNo);
+    if (segInfo == nullptr || segInfo->state != SegmentState::InRetxQueue) {
+      m_retxQueue.pop(); // received before it was retransmitted
+      continue;
+    }
+    auto sourceIdx = pickRetxSource(segInfo->sourceIdx, now);
+    if (!sourceIdx) {
+      return;
+    }
+    m_retxQueue.pop();
+    sendInterest(segNo, *sourceIdx, true);
+    if (isStopping()) {
+      return;
+    }
+  }
+
+  // then new segments, one per source in turn, unless the consumer is holding too much content
+  for (bool hasSent = true; hasSent;) {
+    hasSent = false;
+    for (size_t i = 0; i < m_sources.size(); ++i) {
+      size_t sourceIdx = m_nextSourceIdx;
+      m_nextSourceIdx = (m_nextSourceIdx + 1) % m_sources.size();
+      if (canSend(*m_sources[sourceIdx], now)) {
+        if (isThrottled() || !sendInterest(getNextSegmentNo(), sourceIdx, false)) {
+          return;
+        }
+        hasSent = true;
+      }
+    }
+  }
+}
+
+bool
+PipelineInterestsMultiSource::canSend(const Source& source, time::steady_clock::TimePoint now) const
+{
+  return now >= source.suspendedUntil && source.nInFlight < static_cast<int64_t>(source.cwnd);
+}
+
+optional<size_t>
+PipelineInterestsMultiSource::pickRetxSource(size_t failedIdx, time::steady_clock::TimePoint now) const
+{
+  optional<size_t> best;
+  auto getRoom = [this] (size_t idx) { return m_sources[idx]->cwnd - m_sources[idx]->nInFlight; };
+
+  for (size_t idx = 0; idx < m_sources.size(); ++idx) {
+    if (!canSend(*m_sources[idx], now)) {
+      continue;
+    }
+    if (!best || (*best == failedIdx && idx != failedIdx) ||
+        ((idx == failedIdx) == (*best == failedIdx) && getRoom(idx) > getRoom(*best))) {
+      best = idx;
+    }
+  }
+  return best;
+}
+
+void
+PipelineInterestsMultiSource::handleData(const Interest& interest, const Data& data, size_t sourceIdx)
+{
+  if (isStopping())
+    return;
+
+  // Interest was expressed with CanBePrefix=false
+  BOOST_ASSERT(data.getName().equals(interest.getName()));
+
+  if (!m_hasFinalBlockId && data.getFinalBlock()) {
+    m_lastSegmentNo = data.getFinalBlock()->toSegment();
+    m_hasFinalBlockId = true;
+    cancelInFlightSegmentsGreaterThan(m_lastSegmentNo);
+    if (m_hasFailure && m_lastSegmentNo >= m_failedSegNo) {
+      // previously failed segment is part of the content
+      return onFailure(m_failureReason);
+    }
+    else {
+      m_hasFailure = false;
+    }
+  }
+
+  uint64_t recvSegNo = getSegmentFromPacket(data);
+  SegmentInfo* segInfo = m_segmentInfo.find(recvSegNo);
+  if (segInfo == nullptr) {
+    return; // ignore already-received segment
+  }
+
+  Source& source = *m_sources[sourceIdx];
+  auto now = time::steady_clock::now();
+  time::nanoseconds rtt = now - segInfo->timeSent;
+  if (m_options.isVerbose) {
+    std::cerr << "Received segment #" << recvSegNo << " from source #" << sourceIdx
+              << ", rtt=" << rtt.count() / 1e6 << "ms"
+              << ", rto=" << segInfo->rto.count() / 1e6 << "ms" << std::endl;
+  }
+
+  // segments in the retx queue were already taken out of the window of their source
+  if (segInfo->state != SegmentState::InRetxQueue) {
+    source.nInFlight--;
+  }
+  if (source.highData < recvSegNo) {
+    source.highData = recvSegNo;
+  }
+  source.nConsecutiveFailures = 0;
+  source.nReceived++;
+  source.receivedSize += data.getContent().value_size();
+
+  if (data.getCongestionMark() > 0 && !m_options.ignoreCongMarks) {
+    if (m_options.disableCwa || now - source.lastDecrease >= source.rttEstimator.getSmoothedRtt()) {
+      source.lastDecrease = now;
+      decreaseWindow(source);
+    }
+  }
+  else if (!isBackpressured()) {
+    increaseWindow(source);
+  }
+
+  // do not sample RTT for retransmitted segments
+  if (segInfo->nRetx == 0) {
+    auto nExpectedSamples = std::max<int64_t>((source.nInFlight + 1) >> 1, 1);
+    source.rttEstimator.addMeasurement(rtt, static_cast<size_t>(nExpectedSamples));
+  }
+
+  m_segmentInfo.erase(recvSegNo);
+  detectLostSegments(sourceIdx);
+
+  // the user of the pipeline may cancel it, which clears m_segmentInfo
+  onData(data);
+  if (isStopping())
+    return;
+
+  if (allSegmentsReceived()) {
+    cancel();
+    if (!m_options.isQuiet) {
+      printSummary();
+    }
+  }
+  else {
+    schedulePackets();
+  }
+}
+
+void
+PipelineInterestsMultiSource::handleNack(const Interest& interest, const lp::Nack& nack, size_t sourceIdx)
+{
+  if (isStopping())
+    return;
+
+  if (m_options.isVerbose)
+    std::cerr << "Received Nack with reason " << nack.getReason()
+              << " from source #" << sourceIdx << " for Interest " << interest << std::endl;
+
+  if (nack.getReason() == lp::NackReason::DUPLICATE) {
+    return;
+  }
+
+  // other sources may still have the segment, so even NoRoute is not fatal
+  uint64_t segNo = getSegmentFromPacket(interest);
+  const SegmentInfo* segInfo = m_segmentInfo.find(segNo);
+  if (segInfo != nullptr && segInfo->state != SegmentState::InRetxQueue) {
+    recordFailure(segNo, sourceIdx, true);
+    schedulePackets();
+  }
+}
+
+void
+PipelineInterestsMultiSource::handleLifetimeExpiration(const Interest& interest, size_t sourceIdx)
+{
+  if (isStopping())
+    return;
+
+  uint64_t segNo = getSegmentFromPacket(interest);
+  const SegmentInfo* segInfo = m_segmentInfo.find(segNo);
+  if (segInfo != nullptr && segInfo->state != SegmentState::InRetxQueue) {
+    recordFailure(segNo, sourceIdx, true);
+    schedulePackets();
+  }
+}
+
+void
+PipelineInterestsMultiSource::detectLostSegments(size_t sourceIdx)
+{
+  Source& source = *m_sources[sourceIdx];
+  m_segmentInfo.detectOvertaken(source.nextLossCheckSegNo, source.highData, m_options.reorderThreshold,
+                                [this, sourceIdx, &source] (uint64_t segNo, SegmentInfo& segInfo) {
+    // segments requested from other sources may be overtaken by this one at no fault of theirs
+    if (segInfo.sourceIdx != sourceIdx)
+      return;
+
+    if (m_options.isVerbose) {
+      std::cerr << "Segment #" << segNo << " lost, segment #" << source.highData
+                << " already received from source #" << sourceIdx << std::endl;
+    }
+    recordFailure(segNo, sourceIdx, false);
+  });
+}
+
+void
+PipelineInterestsMultiSource::recordFailure(uint64_t segNo, size_t sourceIdx, bool isTimeout)
+{
+  Source& source = *m_sources[sourceIdx];
+  BOOST_ASSERT(source.nInFlight > 0);
+  source.nInFlight--;
+  if (isTimeout) {
+    source.nTimeouts++;
+  }
+  else {
+    source.nFastRetx++;
+  }
+  SegmentInfo* segInfo = m_segmentInfo.find(segNo);
+  BOOST_ASSERT(segInfo != nullptr);
+  segInfo->state = SegmentState::InRetxQueue;
+  m_retxQueue.push(segNo);
+
+  auto now = time::steady_clock::now();
+  if (m_options.disableCwa || now - source.lastDecrease >= source.rttEstimator.getSmoothedRtt()) {
+    // react to only one loss per RTT of the source (conservative window adaptation)
+    source.lastDecrease = now;
+    decreaseWindow(source);
+    if (isTimeout) {
+      source.rttEstimator.backoffRto();
+    }
+  }
+
+  // a gap only shows that the source is reordering or dropping some packets, not that it is gone
+  if (!isTimeout || ++source.nConsecutiveFailures < MAX_CONSECUTIVE_FAILURES) {
+    return;
+  }
+
+  source.nConsecutiveFailures = 0;
+  auto suspension = source.rttEstimator.getEstimatedRto();
+  source.suspendedUntil = now + suspension;
+  source.cwnd = m_options.initCwnd;
+  source.resumeEvent = m_scheduler.schedule(suspension, [this] { schedulePackets(); });
+  if (m_options.isVerbose) {
+    std::cerr << "Suspending source #" << sourceIdx << " for "
+              << suspension.count() / 1e6 << "ms" << std::endl;
+  }
+}
+
+void
+PipelineInterestsMultiSource::increaseWindow(Source& source)
+{
+  if (source.cwnd < source.ssthresh) {
+    source.cwnd += m_options.aiStep; // additive increase
+  }
+  else {
+    source.cwnd += m_options.aiStep / std::floor(source.cwnd); // congestion avoidance
+  }
+}
+
+void
+PipelineInterestsMultiSource::decreaseWindow(Source& source)
+{
+  source.ssthresh = std::max(MIN_SSTHRESH, source.cwnd * m_options.mdCoef);
+  source.cwnd = m_options.resetCwndToInit ? m_options.initCwnd : source.ssthresh;
+}
+
+void
+PipelineInterestsMultiSource::handleFail(uint64_t segNo, const std::string& reason)
+{
+  if (isStopping())
+    return;
+
+  // if the failed segment is definitely part of the content, raise a fatal error
+  if (m_hasFinalBlockId && segNo <= m_lastSegmentNo)
+    return onFailure(reason);
+
+  if (!m_hasFinalBlockId) {
+    // the segment is in the retx queue, so it is no longer counted in the window of its source
+    m_segmentInfo.erase(segNo);
+
+    if (m_segmentInfo.empty()) {
+      onFailure("Fetching terminated but no final segment number has been found");
+    }
+    else {
+      cancelInFlightSegmentsGreaterThan(segNo);
+      m_hasFailure = true;
+      m_failedSegNo = segNo;
+      m_failureReason = reason;
+    }
+  }
+}
+
+void
+PipelineInterestsMultiSource::cancelInFlightSegmentsGreaterThan(uint64_t segNo)
+{
+  m_segmentInfo.forEach([this, segNo] (uint64_t entrySegNo, const SegmentInfo& segInfo) {
+    if (entrySegNo > segNo && segInfo.state != SegmentState::InRetxQueue) {
+      m_sources[segInfo.sourceIdx]->nInFlight--;
+    }
+  });
+  m_segmentInfo.eraseAfter(segNo);
+}
+
+void
+PipelineInterestsMultiSource::printSummary() const
+{
+  PipelineInterests::printSummary();
+  if (!m_options.isVerbose) {
+    return;
+  }
+
+  for (size_t idx = 0; idx < m_sources.size(); ++idx) {
+    const Source& source = *m_sources[idx];
+    std::cerr << "Source #" << idx << " (" << (source.hint.empty() ? "content name" : source.hint.toUri())
+              << "): " << source.nReceived << " segments, " << source.receivedSize / 1e3 << " kB, "
+              << source.nTimeouts << " timeouts or Nacks, " << source.nFastRetx
+              << " fast retransmissions, srtt="
+              << source.rttEstimator.getSmoothedRtt().count() / 1e6 << "ms\n";
+  }
+}
+
+} // namespace chunks
+} // namespace ndn
@@ -0,0 +1,187 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016-2019, Regents of the University of California,
+ *                          Colorado State University,
+ *                          University Pierre & Marie Curie, Sorbonne University.
+ *
+ * This file is part of ndn-tools (Named Data Networking Essential Tools).
+ * See AUTHORS.md for complete list of ndn-tools authors and contributors.
+ *
+ * ndn-tools is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-tools is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-tools, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef NDN_TOOLS_CHUNKS_CATCHUNKS_PIPELINE_INTERESTS_MULTI_SOURCE_HPP
+#define NDN_TOOLS_CHUNKS_CATCHUNKS_PIPELINE_INTERESTS_MULTI_SOURCE_HPP
+
+#include "pipeline-interests.hpp"
+#include "rto-timer.hpp"
+#include "segment-table.hpp"
+
+#include <ndn-cxx/util/rtt-estimator.hpp>
+
+#include <functional>
+#include <queue>
+
+namespace ndn {
+namespace chunks {
+
+using util::RttEstimator;
+using util::RttEstimatorWithStats;
+
+/**
+ * @brief Service for retrieving Data from several sources at the same time
+ *
+ * A source is a forwarding hint that steers Interests towards one of the producers of the
+ * content, e.g. one of several LAN peers running ndndroplist; an empty name uses the routes of
+ * the content name itself. Every source has its own RTT estimator and AIMD congestion window.
+ * Sources take the next segment to request in turn whenever their window has room, so faster
+ * sources, whose windows grow larger, retrieve a larger share of the segments.
+ *
+ * All sources must serve the same version of the content, which is requested by name through
+ * every hint. Producers that each stamp their own version, or encrypt with their own key, do not
+ * share any segment; a source that does not have the version only times out or is Nacked.
+ *
+ * Segments are tracked in a SegmentTable, with an RtoTimer for their retransmission timeouts,
+ * and are requested through one InterestTemplate per source. A segment is considered lost when
+ * its RTO expires, when it is Nacked, or when its source delivered a segment at least
+ * Options::reorderThreshold higher. A lost segment is retransmitted through a different source
+ * if one has room. A source that fails MAX_CONSECUTIVE_FAILURES times in a row is suspended for
+ * its RTO and then probed again with the initial window.
+ */
+class PipelineInterestsMultiSource final : public PipelineInterests
+{
+public:
+  /**
+   * @param sources forwarding hints of the sources, at least one
+   * @param rttOptions options of the RTT estimator of every source
+   */
+  PipelineInterestsMultiSource(Face& face, const std::vector<Name>& sources,
+                               shared_ptr<const RttEstimator::Options> rttOptions, const Options& opts);
+
+  ~PipelineInterestsMultiSource() override;
+
+private:
+  struct Source
+  {
+    Source(const Name& hint, shared_ptr<const RttEstimator::Options> rttOptions, double cwnd,
+           double ssthresh);
+
+    Name hint;
+    InterestTemplate interestTemplate;
+    RttEstimatorWithStats rttEstimator;
+    double cwnd;
+    double ssthresh;
+    int64_t nInFlight = 0;
+    time::steady_clock::TimePoint lastDecrease; ///< for reacting to one loss per RTT
+    int nConsecutiveFailures = 0;
+    time::steady_clock::TimePoint suspendedUntil;
+    scheduler::ScopedEventId resumeEvent; ///< ends the suspension
+    uint64_t highData = 0;           ///< highest segment received from this source
+    uint64_t nextLossCheckSegNo = 0; ///< lowest segment not yet checked against highData
+    int64_t nReceived = 0;
+    uint64_t receivedSize = 0;
+    int64_t nTimeouts = 0;
+    int64_t nFastRetx = 0;
+  };
+
+  void
+  doRun() final;
+
+  void
+  doCancel() final;
+
+  void
+  doResume() final;
+
+  void
+  checkRto();
+
+  /**
+   * @return whether the Interest was sent; it is not if @p segNo is past the last segment, the
+   *         pipeline is stopping or the segment has exhausted its retries
+   */
+  bool
+  sendInterest(uint64_t segNo, size_t sourceIdx, bool isRetransmission);
+
+  void
+  schedulePackets();
+
+  bool
+  canSend(const Source& source, time::steady_clock::TimePoint now) const;
+
+  /**
+   * @brief Choose the source with the most room for a retransmission, avoiding @p failedIdx
+   *        if another source can send
+   */
+  optional<size_t>
+  pickRetxSource(size_t failedIdx, time::steady_clock::TimePoint now) const;
+
+  void
+  handleData(const Interest& interest, const Data& data, size_t sourceIdx);
+
+  void
+  handleNack(const Interest& interest, const lp::Nack& nack, size_t sourceIdx);
+
+  void
+  handleLifetimeExpiration(const Interest& interest, size_t sourceIdx);
+
+  /**
+   * @brief Retransmit the segments that a later segment from the same source overtook by at
+   *        least Options::reorderThreshold, without waiting for their RTO
+   */
+  void
+  detectLostSegments(size_t sourceIdx);
+
+  /**
+   * @brief Queue @p segNo for retransmission and penalize the source it was requested from
+   * @param isTimeout the loss was detected by a timeout or Nack, which also backs off the RTO of
+   *                  the source and counts towards its suspension
+   */
+  void
+  recordFailure(uint64_t segNo, size_t sourceIdx, bool isTimeout);
+
+  void
+  increaseWindow(Source& source);
+
+  void
+  decreaseWindow(Source& source);
+
+  void
+  handleFail(uint64_t segNo, const std::string& reason);
+
+  void
+  cancelInFlightSegmentsGreaterThan(uint64_t segNo);
+
+  void
+  printSummary() const final;
+
+PUBLIC_WITH_TESTS_ELSE_PRIVATE:
+  static constexpr double MIN_SSTHRESH = 2.0;
+  static constexpr int MAX_CONSECUTIVE_FAILURES = 3;
+
+  std::vector<unique_ptr<Source>> m_sources;
+  Scheduler m_scheduler;
+
+  SegmentTable m_segmentInfo; ///< sent but not acked segments
+  RtoTimer m_rtoTimer;
+  std::priority_queue<uint64_t, std::vector<uint64_t>,
+                      std::greater<uint64_t>> m_retxQueue; ///< lowest segment first
+  size_t m_nextSourceIdx = 0; ///< source that takes the next new segment first
+
+  bool m_hasFailure = false;
+  uint64_t m_failedSegNo = 0;
+  std::string m_failureReason;
+};
+
+} // namespace chunks
+} // namespace ndn
+
+#endif // NDN_TOOLS_CHUNKS_CATCHUNKS_PIPELINE_INTERESTS_MULTI_SOURCE_HPP
@@ -41,6 +41,8 @@ PipelineInterests::PipelineInterests(Face& face, const Options& opts)
   , m_lastSegmentNo(0)
   , m_nReceived(0)
   , m_receivedSize(0)
+  , m_wasThrottled(false)
+  , m_isDelivering(false)
   , m_nextSegmentNo(0)
   , m_isStopping(false)
 {
@@ -56,6 +58,7 @@ PipelineInterests::run(const Name& versionedName, DataCallback dataCb, FailureCa
   BOOST_ASSERT(dataCb != nullptr);
 
   m_prefix = versionedName;
+  m_interestTemplate = InterestTemplate(m_prefix, m_options.mustBeFresh, m_options.interestLifetime);
   m_onData = std::move(dataCb);
   m_onFailure = std::move(failureCb);
 
@@ -75,6 +78,38 @@ PipelineInterests::cancel()
   doCancel();
 }
 
+void
+PipelineInterests::setReceivedSegments(SegmentPredicate isReceived, uint64_t nReceived,
+                                       optional<uint64_t> lastSegmentNo)
+{
+  m_isReceived = std::move(isReceived);
+  m_nReceived = static_cast<int64_t>(nReceived);
+  if (lastSegmentNo) {
+    m_lastSegmentNo = *lastSegmentNo;
+    m_hasFinalBlockId = true;
+  }
+}
+
+void
+PipelineInterests::resume()
+{
+  if (!m_wasThrottled || m_isDelivering || m_isStopping)
+    return;
+
+  m_wasThrottled = false;
+  doResume();
+}
+
+bool
+PipelineInterests::isThrottled()
+{
+  if (m_isThrottled && m_isThrottled()) {
+    m_wasThrottled = true;
+    return true;
+  }
+  return false;
+}
+
 bool
 PipelineInterests::allSegmentsReceived() const
 {
@@ -86,7 +121,21 @@ PipelineInterests::allSegmentsReceived() const
 uint64_t
 PipelineInterests::getNextSegmentNo()
 {
-  return m_nextSegmentNo++;
+  uint64_t segNo = peekNextSegmentNo();
+  m_nextSegmentNo = segNo + 1;
+  return segNo;
+}
+
+uint64_t
+PipelineInterests::peekNextSegmentNo()
+{
+  if (m_isReceived) {
+    while ((!m_hasFinalBlockId || m_nextSegmentNo <= m_lastSegmentNo) &&
+           m_isReceived(m_nextSegmentNo)) {
+      ++m_nextSegmentNo;
+    }
+  }
+  return m_nextSegmentNo;
 }
 
 void
@@ -95,7 +144,9 @@ PipelineInterests::onData(const Data& data)
   m_nReceived++;
   m_receivedSize += data.getContent().value_size();
 
+  m_isDelivering = true;
   m_onData(data);
+  m_isDelivering = false;
 }
 
 void
@@ -31,6 +31,7 @@
 #ifndef NDN_TOOLS_CHUNKS_CATCHUNKS_PIPELINE_INTERESTS_HPP
 #define NDN_TOOLS_CHUNKS_CATCHUNKS_PIPELINE_INTERESTS_HPP
 
+#include "interest-template.hpp"
 #include "options.hpp"
 
 namespace ndn {
@@ -79,6 +80,62 @@ public:
   void
   cancel();
 
+  using SegmentPredicate = std::function<bool(uint64_t segNo)>;
+
+  /**
+   * @brief do not request the segments for which @p isReceived returns true
+   *
+   * Used to resume an interrupted transfer. Must be called before run().
+   *
+   * @param nReceived number of segments for which @p isReceived returns true
+   * @param lastSegmentNo last segment number, if already known
+   */
+  void
+  setReceivedSegments(SegmentPredicate isReceived, uint64_t nReceived,
+                      optional<uint64_t> lastSegmentNo);
+
+  using BackpressureCheck = std::function<bool()>;
+
+  /**
+   * @brief do not grow the window while @p isBackpressured returns true
+   *
+   * Lets the user of the pipeline hold the request rate at what it can process, e.g. while
+   * segments are waiting for validation. Pipelines with a fixed window ignore it.
+   */
+  void
+  setBackpressureCheck(BackpressureCheck isBackpressured)
+  {
+    m_isBackpressured = std::move(isBackpressured);
+  }
+
+  /**
+   * @brief do not request new segments while @p isThrottled returns true
+   *
+   * Lets the user of the pipeline bound the content it holds while waiting for a missing
+   * segment. Retransmissions are still sent, so that the missing segment keeps being requested.
+   * The user must call resume() once @p isThrottled may have turned false.
+   */
+  void
+  setThrottleCheck(BackpressureCheck isThrottled)
+  {
+    m_isThrottled = std::move(isThrottled);
+  }
+
+  /**
+   * @brief request new segments again if the pipeline was throttled
+   *
+   * Does nothing if called from the data callback, the pipeline schedules more Interests
+   * after it returns anyway.
+   */
+  void
+  resume();
+
+  /**
+   * @param throughput The throughput in bits/s
+   */
+  static std::string
+  formatThroughput(double throughput);
+
 protected:
   time::steady_clock::TimePoint
   getStartTime() const
@@ -92,6 +149,18 @@ protected:
     return m_isStopping;
   }
 
+  bool
+  isBackpressured() const
+  {
+    return m_isBackpressured && m_isBackpressured();
+  }
+
+  /**
+   * @brief whether new segments must not be requested, see setThrottleCheck()
+   */
+  bool
+  isThrottled();
+
   /**
    * @brief check if the transfer is complete
    * @return true if all segments have been received, false otherwise
@@ -100,12 +169,19 @@ protected:
   allSegmentsReceived() const;
 
   /**
-   * @return next segment number to retrieve
+   * @return next segment number to retrieve, skipping those already received by an earlier
+   *         transfer
    * @post m_nextSegmentNo == return-value + 1
    */
   uint64_t
   getNextSegmentNo();
 
+  /**
+   * @return the segment number getNextSegmentNo() will return next, without consuming it
+   */
+  uint64_t
+  peekNextSegmentNo();
+
   /**
    * @brief subclasses must call this method to notify successful retrieval of a segment
    */
@@ -129,12 +205,6 @@ protected:
   virtual void
   printSummary() const;
 
-  /**
-   * @param throughput The throughput in bits/s
-   */
-  static std::string
-  formatThroughput(double throughput);
-
 private:
   /**
    * @brief perform subclass-specific operations to fetch all the segments
@@ -151,10 +221,17 @@ private:
   virtual void
   doCancel() = 0;
 
+  /**
+   * @brief send the Interests held back while the pipeline was throttled
+   */
+  virtual void
+  doResume() = 0;
+
 protected:
   const Options& m_options;
   Face& m_face;
   Name m_prefix;
+  InterestTemplate m_interestTemplate; ///< Interests for the segments of m_prefix
 
 PUBLIC_WITH_TESTS_ELSE_PROTECTED:
   bool m_hasFinalBlockId;   ///< true if the last segment number is known
@@ -165,6 +242,11 @@ PUBLIC_WITH_TESTS_ELSE_PROTECTED:
 private:
   DataCallback m_onData;
   FailureCallback m_onFailure;
+  SegmentPredicate m_isReceived;
+  BackpressureCheck m_isBackpressured;
+  BackpressureCheck m_isThrottled;
+  bool m_wasThrottled; ///< a new segment was held back since the last resume()
+  bool m_isDelivering; ///< m_onData is running
   uint64_t m_nextSegmentNo;
   time::steady_clock::TimePoint m_startTime;
   bool m_isStopping;
@@ -0,0 +1,178 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016-2019, Regents of the University of California,
+ *                          Colorado State University,
+ *                          University Pierre & Marie Curie, Sorbonne University.
+ *
+ * This file is part of ndn-tools (Named Data Networking Essential Tools).
+ * See AUTHORS.md for complete list of ndn-tools authors and contributors.
+ *
+ * ndn-tools is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-tools is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-tools, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "positional-writer.hpp"
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+
+namespace ndn {
+namespace chunks {
+
+static std::string
+describeError(const std::string& what, const std::string& path)
+{
+  return what + " " + path + ": " + std::strerror(errno);
+}
+
+PositionalWriter::PositionalWriter(const std::string& path, bool shouldTruncate)
+  : m_path(path)
+  , m_fd(::open(path.data(), O_WRONLY | O_CREAT | (shouldTruncate ? O_TRUNC : 0), 0644))
+{
+  if (m_fd < 0) {
+    NDN_THROW(Error(describeError("Cannot open", m_path)));
+  }
+}
+
+PositionalWriter::PositionalWriter(int fd)
+  : m_path("descriptor " + to_string(fd))
+  , m_fd(fd)
+  , m_isSequential(true)
+{
+}
+
+PositionalWriter::~PositionalWriter()
+{
+  if (m_fd >= 0 && !m_isSequential) {
+    ::close(m_fd);
+  }
+}
+
+void
+PositionalWriter::preallocate(uint64_t size)
+{
+  if (m_isSequential) {
+    return;
+  }
+
+#ifdef __linux__
+  if (::fallocate(m_fd, 0, 0, static_cast<off_t>(size)) == 0) {
+    return;
+  }
+#endif // __linux__
+  // fallocate is unavailable or unsupported by the file system, only set the final size
+  if (::ftruncate(m_fd, static_cast<off_t>(size)) != 0) {
+    NDN_THROW(Error(describeError("Cannot resize", m_path)));
+  }
+}
+
+void
+PositionalWriter::write(uint64_t offset, const uint8_t* buf, size_t size)
+{
+  checkSequentialOffset(offset);
+  while (size > 0) {
+    ssize_t n = m_isSequential ? ::write(m_fd, buf, size) :
+                                 ::pwrite(m_fd, buf, size, static_cast<off_t>(offset));
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      NDN_THROW(Error(describeError("Cannot write to", m_path)));
+    }
+    buf += n;
+    size -= static_cast<size_t>(n);
+    offset += static_cast<uint64_t>(n);
+  }
+  m_sequentialOffset = offset;
+}
+
+void
+PositionalWriter::write(uint64_t offset, iovec* iov, size_t iovcnt)
+{
+  checkSequentialOffset(offset);
+  while (iovcnt > 0) {
+    ssize_t n = 0;
+    if (m_isSequential) {
+      n = ::writev(m_fd, iov, static_cast<int>(iovcnt));
+    }
+    else {
+#ifdef __linux__
+      n = ::pwritev(m_fd, iov, static_cast<int>(iovcnt), static_cast<off_t>(offset));
+#else
+      n = ::pwrite(m_fd, iov->iov_base, iov->iov_len, static_cast<off_t>(offset));
+#endif // __linux__
+    }
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      NDN_THROW(Error(describeError("Cannot write to", m_path)));
+    }
+    offset += static_cast<uint64_t>(n);
+
+    // skip the buffers written entirely, and the written part of the next one
+    auto nLeft = static_cast<size_t>(n);
+    while (iovcnt > 0 && nLeft >= iov->iov_len) {
+      nLeft -= iov->iov_len;
+      ++iov;
+      --iovcnt;
+    }
+    if (nLeft > 0) {
+      iov->iov_base = static_cast<uint8_t*>(iov->iov_base) + nLeft;
+      iov->iov_len -= nLeft;
+    }
+  }
+  m_sequentialOffset = offset;
+}
+
+void
+PositionalWriter::checkSequentialOffset(uint64_t offset)
+{
+  if (m_isSequential && offset != m_sequentialOffset) {
+    NDN_THROW(Error("Cannot write at offset " + to_string(offset) + " of " + m_path +
+                    ", it can only be written sequentially"));
+  }
+}
+
+void
+PositionalWriter::sync()
+{
+#ifdef __linux__
+  int ret = ::fdatasync(m_fd);
+#else
+  int ret = ::fsync(m_fd);
+#endif // __linux__
+  if (ret != 0) {
+    NDN_THROW(Error(describeError("Cannot sync", m_path)));
+  }
+}
+
+void
+PositionalWriter::close(uint64_t size)
+{
+  if (m_isSequential) {
+    return;
+  }
+
+  if (::ftruncate(m_fd, static_cast<off_t>(size)) != 0) {
+    NDN_THROW(Error(describeError("Cannot resize", m_path)));
+  }
+  int fd = m_fd;
+  m_fd = -1;
+  if (::close(fd) != 0) {
+    NDN_THROW(Error(describeError("Cannot close", m_path)));
+  }
+}
+
+} // namespace chunks
+} // namespace ndn
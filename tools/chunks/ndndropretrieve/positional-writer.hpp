@@ -0,0 +1,131 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016-2019, Regents of the University of California,
+ *                          Colorado State University,
+ *                          University Pierre & Marie Curie, Sorbonne University.
+ *
+ * This file is part of ndn-tools (Named Data Networking Essential Tools).
+ * See AUTHORS.md for complete list of ndn-tools authors and contributors.
+ *
+ * ndn-tools is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-tools is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-tools, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NDN_TOOLS_CHUNKS_CATCHUNKS_POSITIONAL_WRITER_HPP
+#define NDN_TOOLS_CHUNKS_CATCHUNKS_POSITIONAL_WRITER_HPP
+
+#include "core/common.hpp"
+
+#include <sys/uio.h>
+
+namespace ndn {
+namespace chunks {
+
+/**
+ * @brief Writes segments of a file at their offsets, in any order
+ *
+ * The file is preallocated once its size is known, so that writes beyond the current end of
+ * the file neither extend it piecemeal nor fragment it, and then written with pwrite.
+ *
+ * A writer can also wrap an already open descriptor such as the standard output, which may be
+ * a pipe. It is then written sequentially: every write must start where the previous one
+ * ended, and preallocate() and close() leave the descriptor alone.
+ */
+class PositionalWriter : noncopyable
+{
+public:
+  class Error : public std::runtime_error
+  {
+  public:
+    using std::runtime_error::runtime_error;
+  };
+
+  /**
+   * @brief Create @p path, or open it keeping its contents unless @p shouldTruncate
+   * @throw Error the file cannot be opened
+   */
+  explicit
+  PositionalWriter(const std::string& path, bool shouldTruncate = true);
+
+  /**
+   * @brief Write sequentially to @p fd, which is not closed by the writer
+   */
+  explicit
+  PositionalWriter(int fd);
+
+  ~PositionalWriter();
+
+  /**
+   * @brief Reserve @p size bytes of storage for the file
+   *
+   * Uses fallocate where available; otherwise, or if the file system does not support it, the
+   * file is only extended to @p size.
+   */
+  void
+  preallocate(uint64_t size);
+
+  /**
+   * @brief Write @p size bytes at @p offset
+   * @throw Error the write failed
+   */
+  void
+  write(uint64_t offset, const uint8_t* buf, size_t size);
+
+  /**
+   * @brief Write the @p iovcnt buffers of @p iov one after the other, starting at @p offset
+   *
+   * Uses a single system call unless it is interrupted or writes only part of the data.
+   * @p iov is modified to track partial writes.
+   * @throw Error the write failed
+   */
+  void
+  write(uint64_t offset, iovec* iov, size_t iovcnt);
+
+  /**
+   * @brief Flush the data written so far to the storage device
+   */
+  void
+  sync();
+
+  /**
+   * @brief Trim the file to @p size bytes, dropping the unused part of the preallocation, and
+   *        close it
+   */
+  void
+  close(uint64_t size);
+
+  int
+  getFd() const
+  {
+    return m_fd;
+  }
+
+  bool
+  isSequential() const
+  {
+    return m_isSequential;
+  }
+
+private:
+  void
+  checkSequentialOffset(uint64_t offset);
+
+private:
+  std::string m_path;
+  int m_fd;
+  bool m_isSequential = false;
+  uint64_t m_sequentialOffset = 0; ///< where the next sequential write must start
+};
+
+} // namespace chunks
+} // namespace ndn
+
+#endif // NDN_TOOLS_CHUNKS_CATCHUNKS_POSITIONAL_WRITER_HPP
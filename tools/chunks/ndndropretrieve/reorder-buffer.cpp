@@ -0,0 +1,121 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016-2019, Regents of the University of California,
+ *                          Colorado State University,
+ *                          University Pierre & Marie Curie, Sorbonne University.
+ *
+ * This file is part of ndn-tools (Named Data Networking Essential Tools).
+ * See AUTHORS.md for complete list of ndn-tools authors and contributors.
+ *
+ * ndn-tools is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-tools is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-tools, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "reorder-buffer.hpp"
+#include "ring-util.hpp"
+
+namespace ndn {
+namespace chunks {
+
+ReorderBuffer::ReorderBuffer(size_t initialCapacity)
+  : m_slots(roundUpToPowerOf2(std::max<size_t>(initialCapacity, 1)))
+{
+}
+
+void
+ReorderBuffer::insert(uint64_t segNo, const uint8_t* buf, size_t size)
+{
+  if (segNo < m_nextSegment) {
+    return;
+  }
+  if (segNo - m_nextSegment >= m_slots.size()) {
+    grow(segNo);
+  }
+
+  Slot& slot = m_slots[getIndex(segNo)];
+  if (slot.isOccupied) {
+    return;
+  }
+  // assign() keeps the capacity left by earlier segments, so steady state does not allocate
+  size_t oldCapacity = slot.content.capacity();
+  slot.content.assign(buf, buf + size);
+  m_idleBytes -= oldCapacity;
+  m_retainedBytes += slot.content.capacity() - oldCapacity;
+  slot.isOccupied = true;
+  ++m_nBuffered;
+  m_bufferedBytes += size;
+}
+
+bool
+ReorderBuffer::contains(uint64_t segNo) const
+{
+  return segNo >= m_nextSegment &&
+         segNo - m_nextSegment < m_slots.size() &&
+         m_slots[getIndex(segNo)].isOccupied;
+}
+
+const Buffer&
+ReorderBuffer::front() const
+{
+  BOOST_ASSERT(hasNext());
+  return m_slots[getIndex(m_nextSegment)].content;
+}
+
+void
+ReorderBuffer::pop()
+{
+  Slot& slot = m_slots[getIndex(m_nextSegment)];
+  if (slot.isOccupied) {
+    slot.isOccupied = false;
+    --m_nBuffered;
+    m_bufferedBytes -= slot.content.size();
+    m_idleBytes += slot.content.capacity();
+    if (m_idleBytes > m_maxIdleBytes) {
+      m_idleBytes -= slot.content.capacity();
+      m_retainedBytes -= slot.content.capacity();
+      Buffer().swap(slot.content);
+    }
+  }
+  ++m_nextSegment;
+}
+
+void
+ReorderBuffer::clear()
+{
+  for (auto& slot : m_slots) {
+    Buffer().swap(slot.content);
+    slot.isOccupied = false;
+  }
+  m_nextSegment = 0;
+  m_nBuffered = 0;
+  m_bufferedBytes = 0;
+  m_retainedBytes = 0;
+  m_idleBytes = 0;
+}
+
+void
+ReorderBuffer::grow(uint64_t segNo)
+{
+  // only the slots holding a segment are carried over, the memory of empty ones is released
+  std::vector<Slot> slots(roundUpToPowerOf2(static_cast<size_t>(segNo - m_nextSegment + 1)));
+  for (uint64_t i = m_nextSegment; i < m_nextSegment + m_slots.size(); ++i) {
+    Slot& slot = m_slots[getIndex(i)];
+    if (slot.isOccupied) {
+      slots[static_cast<size_t>(i) & (slots.size() - 1)] = std::move(slot);
+    }
+  }
+  m_slots = std::move(slots);
+  m_retainedBytes -= m_idleBytes;
+  m_idleBytes = 0;
+}
+
+} // namespace chunks
+} // namespace ndn
@@ -0,0 +1,171 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016-2019, Regents of the University of California,
+ *                          Colorado State University,
+ *                          University Pierre & Marie Curie, Sorbonne University.
+ *
+ * This file is part of ndn-tools (Named Data Networking Essential Tools).
+ * See AUTHORS.md for complete list of ndn-tools authors and contributors.
+ *
+ * ndn-tools is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-tools is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-tools, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NDN_TOOLS_CHUNKS_CATCHUNKS_REORDER_BUFFER_HPP
+#define NDN_TOOLS_CHUNKS_CATCHUNKS_REORDER_BUFFER_HPP
+
+#include "core/common.hpp"
+
+namespace ndn {
+namespace chunks {
+
+/**
+ * @brief Holds the content of segments received out of order until they can be written
+ *
+ * Segments are kept in a ring indexed by segment number modulo the capacity, which spans from
+ * the next segment to be written to the highest segment buffered. Only the content is kept,
+ * copied into a slot whose memory is reused by later segments, so the Data packets are not
+ * pinned and insert, lookup and pop take constant time without allocating once the slots have
+ * warmed up. The ring doubles when a segment falls beyond its span.
+ *
+ * Slots keep their memory after their segment is popped, so the memory held can exceed the
+ * content buffered. getRetainedBytes() accounts for it, and setMaxIdleBytes() bounds the memory
+ * kept by empty slots.
+ */
+class ReorderBuffer : noncopyable
+{
+public:
+  explicit
+  ReorderBuffer(size_t initialCapacity = 64);
+
+  /**
+   * @brief Store a copy of the content of segment @p segNo
+   *
+   * Segments before getNextSegment() or already buffered are ignored.
+   */
+  void
+  insert(uint64_t segNo, const uint8_t* buf, size_t size);
+
+  bool
+  contains(uint64_t segNo) const;
+
+  /**
+   * @brief Whether the next segment to be written is buffered
+   */
+  bool
+  hasNext() const
+  {
+    return contains(m_nextSegment);
+  }
+
+  /**
+   * @brief Content of the next segment to be written
+   * @pre hasNext()
+   */
+  const Buffer&
+  front() const;
+
+  /**
+   * @brief Move past the next segment to be written, making its slot available to later segments
+   *
+   * The slot keeps its memory for reuse, unless the memory kept by empty slots would exceed
+   * the limit set by setMaxIdleBytes().
+   */
+  void
+  pop();
+
+  /**
+   * @brief Release the memory of slots emptied by pop() beyond @p maxIdleBytes in total
+   *
+   * Without a limit, the memory of all the slots is kept for reuse.
+   */
+  void
+  setMaxIdleBytes(size_t maxIdleBytes)
+  {
+    m_maxIdleBytes = maxIdleBytes;
+  }
+
+  uint64_t
+  getNextSegment() const
+  {
+    return m_nextSegment;
+  }
+
+  /**
+   * @brief Number of buffered segments
+   */
+  size_t
+  size() const
+  {
+    return m_nBuffered;
+  }
+
+  /**
+   * @brief Total content size of the buffered segments, in bytes
+   */
+  size_t
+  getBufferedBytes() const
+  {
+    return m_bufferedBytes;
+  }
+
+  /**
+   * @brief Memory allocated for content, in bytes, including that kept by empty slots
+   */
+  size_t
+  getRetainedBytes() const
+  {
+    return m_retainedBytes;
+  }
+
+  size_t
+  getCapacity() const
+  {
+    return m_slots.size();
+  }
+
+  /**
+   * @brief Drop all buffered segments, release the memory of all slots and start again from
+   *        segment 0
+   */
+  void
+  clear();
+
+private:
+  size_t
+  getIndex(uint64_t segNo) const
+  {
+    return static_cast<size_t>(segNo) & (m_slots.size() - 1);
+  }
+
+  void
+  grow(uint64_t segNo);
+
+private:
+  struct Slot
+  {
+    Buffer content;
+    bool isOccupied = false;
+  };
+
+  std::vector<Slot> m_slots; ///< size is always a power of 2
+  uint64_t m_nextSegment = 0;
+  size_t m_nBuffered = 0;
+  size_t m_bufferedBytes = 0;
+  size_t m_retainedBytes = 0; ///< capacity of the content of all slots
+  size_t m_idleBytes = 0;     ///< capacity of the content of empty slots
+  size_t m_maxIdleBytes = std::numeric_limits<size_t>::max();
+};
+
+} // namespace chunks
+} // namespace ndn
+
+#endif // NDN_TOOLS_CHUNKS_CATCHUNKS_REORDER_BUFFER_HPP
@@ -0,0 +1,148 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016-2019, Regents of the University of California,
+ *                          Colorado State University,
+ *                          University Pierre & Marie Curie, Sorbonne University.
+ *
+ * This file is part of ndn-tools (Named Data Networking Essential Tools).
+ * See AUTHORS.md for complete list of ndn-tools authors and contributors.
+ *
+ * ndn-tools is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-tools is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-tools, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "resume-state.hpp"
+
+#include <cctype>
+#include <fstream>
+#include <sstream>
+
+#include <ndn-cxx/util/string-helper.hpp>
+
+namespace ndn {
+namespace chunks {
+
+static const std::string MAGIC = "ndndrop-resume 1";
+
+ResumeState::ResumeState(const Name& versionedName)
+  : versionedName(versionedName)
+{
+}
+
+static optional<uint64_t>
+parseOptionalNumber(const std::string& line)
+{
+  if (line == "-1") {
+    return nullopt;
+  }
+  // std::stoull would skip leading whitespace and negate a leading minus sign
+  if (line.empty() || !std::isdigit(static_cast<unsigned char>(line.front()))) {
+    NDN_THROW(std::invalid_argument("'" + line + "' is not a number"));
+  }
+  size_t pos = 0;
+  uint64_t value = std::stoull(line, &pos);
+  if (pos != line.size()) {
+    NDN_THROW(std::invalid_argument(line));
+  }
+  return value;
+}
+
+optional<ResumeState>
+ResumeState::load(const std::string& path)
+{
+  std::ifstream is(path);
+  if (!is) {
+    return nullopt;
+  }
+
+  std::string magic, name, segmentSize, lastSegmentNo, fileSize, bitmap;
+  std::getline(is, magic);
+  std::getline(is, name);
+  std::getline(is, segmentSize);
+  std::getline(is, lastSegmentNo);
+  std::getline(is, fileSize);
+  std::getline(is, bitmap);
+  if (is.bad() || magic != MAGIC) {
+    NDN_THROW(Error(path + " is not a valid resume state file"));
+  }
+
+  ResumeState state;
+  try {
+    state.versionedName = Name(name);
+    state.segmentSize = static_cast<size_t>(parseOptionalNumber(segmentSize).value_or(0));
+    state.lastSegmentNo = parseOptionalNumber(lastSegmentNo);
+    state.fileSize = parseOptionalNumber(fileSize);
+    if (!bitmap.empty()) {
+      state.m_bitmap = *fromHex(bitmap);
+    }
+  }
+  catch (const std::exception& e) {
+    NDN_THROW(Error(path + " is not a valid resume state file (" + e.what() + ")"));
+  }
+
+  for (uint8_t byte : state.m_bitmap) {
+    for (; byte != 0; byte &= byte - 1) {
+      ++state.m_nSegments;
+    }
+  }
+  return state;
+}
+
+Buffer
+ResumeState::serialize() const
+{
+  std::ostringstream os;
+  os << MAGIC << "\n"
+     << versionedName << "\n"
+     << segmentSize << "\n";
+  if (lastSegmentNo) {
+    os << *lastSegmentNo << "\n";
+  }
+  else {
+    os << "-1\n";
+  }
+  if (fileSize) {
+    os << *fileSize << "\n";
+  }
+  else {
+    os << "-1\n";
+  }
+  os << toHex(m_bitmap.data(), m_bitmap.size()) << "\n";
+
+  std::string str = os.str();
+  return Buffer(str.data(), str.size());
+}
+
+void
+ResumeState::addSegment(uint64_t segNo)
+{
+  if (segNo / 8 >= m_bitmap.size()) {
+    auto size = static_cast<size_t>(segNo / 8 + 1);
+    if (lastSegmentNo && *lastSegmentNo >= segNo) {
+      size = static_cast<size_t>(*lastSegmentNo / 8 + 1);
+    }
+    else {
+      // grow geometrically while the last segment number is unknown
+      size = std::max(size, 2 * m_bitmap.size());
+    }
+    m_bitmap.resize(size);
+  }
+
+  uint8_t& byte = m_bitmap[segNo / 8];
+  uint8_t mask = static_cast<uint8_t>(1 << (segNo % 8));
+  if ((byte & mask) == 0) {
+    byte |= mask;
+    ++m_nSegments;
+  }
+}
+
+} // namespace chunks
+} // namespace ndn
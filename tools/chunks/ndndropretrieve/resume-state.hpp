@@ -0,0 +1,103 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016-2019, Regents of the University of California,
+ *                          Colorado State University,
+ *                          University Pierre & Marie Curie, Sorbonne University.
+ *
+ * This file is part of ndn-tools (Named Data Networking Essential Tools).
+ * See AUTHORS.md for complete list of ndn-tools authors and contributors.
+ *
+ * ndn-tools is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-tools is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-tools, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NDN_TOOLS_CHUNKS_CATCHUNKS_RESUME_STATE_HPP
+#define NDN_TOOLS_CHUNKS_CATCHUNKS_RESUME_STATE_HPP
+
+#include "core/common.hpp"
+
+namespace ndn {
+namespace chunks {
+
+/**
+ * @brief Progress of a retrieval, saved next to the output file to resume it after interruption
+ *
+ * Records the versioned name being retrieved, the segment size and a bitmap of the segments
+ * that are written to the output file. It is saved as a small text file:
+ *
+ *     ndndrop-resume 1
+ *     <versioned name>
+ *     <segment size>
+ *     <last segment number, or -1>
+ *     <file size, or -1>
+ *     <bitmap in hex, bit i of byte j is segment 8j+i>
+ */
+class ResumeState
+{
+public:
+  class Error : public std::runtime_error
+  {
+  public:
+    using std::runtime_error::runtime_error;
+  };
+
+  ResumeState() = default;
+
+  explicit
+  ResumeState(const Name& versionedName);
+
+  /**
+   * @brief Load the state saved in @p path
+   * @return the saved state, or nullopt if @p path does not exist
+   * @throw Error the file is malformed
+   */
+  static optional<ResumeState>
+  load(const std::string& path);
+
+  /**
+   * @brief Encode the state in the format read by load()
+   */
+  Buffer
+  serialize() const;
+
+  bool
+  hasSegment(uint64_t segNo) const
+  {
+    return segNo / 8 < m_bitmap.size() && (m_bitmap[segNo / 8] & (1 << (segNo % 8))) != 0;
+  }
+
+  void
+  addSegment(uint64_t segNo);
+
+  /**
+   * @brief Number of segments in the bitmap
+   */
+  uint64_t
+  getNSegments() const
+  {
+    return m_nSegments;
+  }
+
+public:
+  Name versionedName;
+  size_t segmentSize = 0;           ///< size of all segments but the last, zero if not known
+  optional<uint64_t> lastSegmentNo;
+  optional<uint64_t> fileSize;      ///< known once the last segment has been written
+
+private:
+  std::vector<uint8_t> m_bitmap;
+  uint64_t m_nSegments = 0;
+};
+
+} // namespace chunks
+} // namespace ndn
+
+#endif // NDN_TOOLS_CHUNKS_CATCHUNKS_RESUME_STATE_HPP
@@ -0,0 +1,86 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016-2019, Regents of the University of California,
+ *                          Colorado State University,
+ *                          University Pierre & Marie Curie, Sorbonne University.
+ *
+ * This file is part of ndn-tools (Named Data Networking Essential Tools).
+ * See AUTHORS.md for complete list of ndn-tools authors and contributors.
+ *
+ * ndn-tools is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-tools is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-tools, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "rto-timer.hpp"
+
+namespace ndn {
+namespace chunks {
+
+constexpr size_t RtoTimer::MIN_DEADLINES_TO_COMPACT;
+
+RtoTimer::RtoTimer(Scheduler& scheduler, SegmentTable& table, ExpiryCallback onExpiry)
+  : m_scheduler(scheduler)
+  , m_table(table)
+  , m_onExpiry(std::move(onExpiry))
+  , m_timerExpiry(time::steady_clock::TimePoint::max())
+{
+}
+
+void
+RtoTimer::add(uint64_t segNo)
+{
+  // deadlines of received segments stay in the heap until they come up, drop them before
+  // they outnumber the segments in the table
+  if (m_deadlines.size() >= 2 * m_table.size() + MIN_DEADLINES_TO_COMPACT) {
+    compact();
+  }
+  else {
+    const SegmentInfo* segInfo = m_table.find(segNo);
+    BOOST_ASSERT(segInfo != nullptr);
+    m_deadlines.push({segInfo->timeSent + segInfo->rto, segNo});
+  }
+  arm();
+}
+
+void
+RtoTimer::cancel()
+{
+  m_timerEvent.cancel();
+  m_timerExpiry = time::steady_clock::TimePoint::max();
+  m_deadlines = decltype(m_deadlines)();
+}
+
+void
+RtoTimer::arm()
+{
+  if (m_deadlines.empty() || m_deadlines.top().expiry >= m_timerExpiry)
+    return;
+
+  m_timerExpiry = m_deadlines.top().expiry;
+  auto delay = std::max<time::nanoseconds>(m_timerExpiry - time::steady_clock::now(), 0_ns);
+  m_timerEvent = m_scheduler.schedule(delay, m_onExpiry);
+}
+
+void
+RtoTimer::compact()
+{
+  std::vector<Deadline> deadlines;
+  deadlines.reserve(m_table.size());
+  m_table.forEach([&deadlines] (uint64_t segNo, const SegmentInfo& segInfo) {
+    if (segInfo.state != SegmentState::InRetxQueue) {
+      deadlines.push_back({segInfo.timeSent + segInfo.rto, segNo});
+    }
+  });
+  m_deadlines = decltype(m_deadlines)(std::greater<Deadline>(), std::move(deadlines));
+}
+
+} // namespace chunks
+} // namespace ndn
@@ -0,0 +1,133 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016-2019, Regents of the University of California,
+ *                          Colorado State University,
+ *                          University Pierre & Marie Curie, Sorbonne University.
+ *
+ * This file is part of ndn-tools (Named Data Networking Essential Tools).
+ * See AUTHORS.md for complete list of ndn-tools authors and contributors.
+ *
+ * ndn-tools is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-tools is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-tools, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NDN_TOOLS_CHUNKS_CATCHUNKS_RTO_TIMER_HPP
+#define NDN_TOOLS_CHUNKS_CATCHUNKS_RTO_TIMER_HPP
+
+#include "segment-table.hpp"
+
+#include <functional>
+#include <queue>
+
+namespace ndn {
+namespace chunks {
+
+/**
+ * @brief Retransmission timer of the segments held in a SegmentTable
+ *
+ * Keeps one deadline per sent Interest in a heap, earliest first, and a single scheduler event
+ * for the earliest one, so that no periodic scan of the table is needed. Deadlines of segments
+ * that were received or sent again since are skipped when they come up, and dropped in bulk
+ * before they outnumber the segments in the table.
+ */
+class RtoTimer : noncopyable
+{
+public:
+  using ExpiryCallback = std::function<void()>;
+
+  /**
+   * @param onExpiry invoked when the earliest deadline passes; it should call popExpired()
+   */
+  RtoTimer(Scheduler& scheduler, SegmentTable& table, ExpiryCallback onExpiry);
+
+  /**
+   * @brief Record the deadline of the Interest just sent for @p segNo, which is the send time
+   *        plus the RTO in its entry
+   */
+  void
+  add(uint64_t segNo);
+
+  /**
+   * @brief Invoke @p onExpired with every segment whose deadline has passed and which is still
+   *        awaited, i.e. neither received, queued for retransmission nor sent again since
+   *
+   * Re-arms the timer for the remaining deadlines. @p onExpired is invoked as
+   * `void(uint64_t segNo, SegmentInfo& info)` and must not insert or erase entries.
+   */
+  template<typename Function>
+  void
+  popExpired(const Function& onExpired)
+  {
+    m_timerExpiry = time::steady_clock::TimePoint::max();
+    auto now = time::steady_clock::now();
+
+    while (!m_deadlines.empty() && m_deadlines.top().expiry <= now) {
+      Deadline deadline = m_deadlines.top();
+      m_deadlines.pop();
+
+      SegmentInfo* segInfo = m_table.find(deadline.segNo);
+      if (segInfo == nullptr ||
+          segInfo->state == SegmentState::InRetxQueue ||
+          segInfo->timeSent + segInfo->rto != deadline.expiry) {
+        continue;
+      }
+      onExpired(deadline.segNo, *segInfo);
+    }
+
+    arm();
+  }
+
+  /**
+   * @brief Drop all deadlines and disarm the timer
+   */
+  void
+  cancel();
+
+private:
+  /**
+   * @brief Arm the timer for the earliest deadline, unless it is already armed at or before it
+   */
+  void
+  arm();
+
+  /**
+   * @brief Rebuild the heap from the entries of the table
+   */
+  void
+  compact();
+
+PUBLIC_WITH_TESTS_ELSE_PRIVATE:
+  static constexpr size_t MIN_DEADLINES_TO_COMPACT = 64;
+
+  struct Deadline
+  {
+    time::steady_clock::TimePoint expiry;
+    uint64_t segNo;
+
+    bool
+    operator>(const Deadline& other) const
+    {
+      return expiry > other.expiry;
+    }
+  };
+
+  Scheduler& m_scheduler;
+  SegmentTable& m_table;
+  const ExpiryCallback m_onExpiry;
+  std::priority_queue<Deadline, std::vector<Deadline>, std::greater<Deadline>> m_deadlines;
+  scheduler::ScopedEventId m_timerEvent;
+  time::steady_clock::TimePoint m_timerExpiry; ///< when m_timerEvent fires, max() if unarmed
+};
+
+} // namespace chunks
+} // namespace ndn
+
+#endif // NDN_TOOLS_CHUNKS_CATCHUNKS_RTO_TIMER_HPP
@@ -0,0 +1,150 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016-2019, Regents of the University of California,
+ *                          Colorado State University,
+ *                          University Pierre & Marie Curie, Sorbonne University.
+ *
+ * This file is part of ndn-tools (Named Data Networking Essential Tools).
+ * See AUTHORS.md for complete list of ndn-tools authors and contributors.
+ *
+ * ndn-tools is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-tools is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-tools, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "segment-table.hpp"
+#include "ring-util.hpp"
+
+namespace ndn {
+namespace chunks {
+
+SegmentTable::SegmentTable(size_t initialCapacity)
+  : m_slots(roundUpToPowerOf2(std::max<size_t>(initialCapacity, 1)))
+{
+}
+
+SegmentInfo*
+SegmentTable::find(uint64_t segNo)
+{
+  if (segNo < m_begin || segNo >= m_end) {
+    return nullptr;
+  }
+  Slot& slot = m_slots[getIndex(segNo)];
+  return slot.isOccupied ? &slot.info : nullptr;
+}
+
+SegmentInfo&
+SegmentTable::insert(uint64_t segNo)
+{
+  if (m_size == 0) {
+    m_begin = m_end = segNo;
+  }
+  uint64_t begin = std::min(m_begin, segNo);
+  uint64_t end = std::max(m_end, segNo + 1);
+  if (end - begin > m_slots.size()) {
+    grow(begin, end);
+  }
+  m_begin = begin;
+  m_end = end;
+
+  Slot& slot = m_slots[getIndex(segNo)];
+  if (!slot.isOccupied) {
+    slot.isOccupied = true;
+    slot.info.nRetx = 0;
+    ++m_size;
+  }
+  return slot.info;
+}
+
+void
+SegmentTable::erase(uint64_t segNo)
+{
+  if (segNo < m_begin || segNo >= m_end) {
+    return;
+  }
+  Slot& slot = m_slots[getIndex(segNo)];
+  if (!slot.isOccupied) {
+    return;
+  }
+  slot.info.interestHdl.cancel();
+  slot.isOccupied = false;
+  --m_size;
+
+  // shrink the span to the remaining entries
+  if (m_size == 0) {
+    m_begin = m_end;
+    return;
+  }
+  while (!m_slots[getIndex(m_begin)].isOccupied) {
+    ++m_begin;
+  }
+  while (!m_slots[getIndex(m_end - 1)].isOccupied) {
+    --m_end;
+  }
+}
+
+size_t
+SegmentTable::eraseAfter(uint64_t segNo)
+{
+  size_t nErased = 0;
+  while (m_size > 0 && m_end - 1 > segNo) {
+    // erase() moves m_end back to the highest remaining entry
+    erase(m_end - 1);
+    ++nErased;
+  }
+  return nErased;
+}
+
+void
+SegmentTable::clear()
+{
+  for (uint64_t segNo = m_begin; segNo < m_end; ++segNo) {
+    Slot& slot = m_slots[getIndex(segNo)];
+    if (slot.isOccupied) {
+      slot.info.interestHdl.cancel();
+      slot.isOccupied = false;
+    }
+  }
+  m_begin = m_end = 0;
+  m_size = 0;
+}
+
+void
+SegmentTable::grow(uint64_t begin, uint64_t end)
+{
+  std::vector<Slot> slots(roundUpToPowerOf2(static_cast<size_t>(end - begin)));
+  for (uint64_t segNo = m_begin; segNo < m_end; ++segNo) {
+    Slot& slot = m_slots[getIndex(segNo)];
+    if (slot.isOccupied) {
+      slots[static_cast<size_t>(segNo) & (slots.size() - 1)] = std::move(slot);
+    }
+  }
+  m_slots = std::move(slots);
+}
+
+std::ostream&
+operator<<(std::ostream& os, SegmentState state)
+{
+  switch (state) {
+  case SegmentState::FirstTimeSent:
+    os << "FirstTimeSent";
+    break;
+  case SegmentState::InRetxQueue:
+    os << "InRetxQueue";
+    break;
+  case SegmentState::Retransmitted:
+    os << "Retransmitted";
+    break;
+  }
+  return os;
+}
+
+} // namespace chunks
+} // namespace ndn
@@ -0,0 +1,189 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016-2019, Regents of the University of California,
+ *                          Colorado State University,
+ *                          University Pierre & Marie Curie, Sorbonne University.
+ *
+ * This file is part of ndn-tools (Named Data Networking Essential Tools).
+ * See AUTHORS.md for complete list of ndn-tools authors and contributors.
+ *
+ * ndn-tools is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-tools is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-tools, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NDN_TOOLS_CHUNKS_CATCHUNKS_SEGMENT_TABLE_HPP
+#define NDN_TOOLS_CHUNKS_CATCHUNKS_SEGMENT_TABLE_HPP
+
+#include "core/common.hpp"
+
+namespace ndn {
+namespace chunks {
+
+/**
+ * @brief indicates the state of the segment
+ */
+enum class SegmentState {
+  FirstTimeSent, ///< segment has been sent for the first time
+  InRetxQueue,   ///< segment is in retransmission queue
+  Retransmitted, ///< segment has been retransmitted
+};
+
+std::ostream&
+operator<<(std::ostream& os, SegmentState state);
+
+/**
+ * @brief Wraps up information that's necessary for segment transmission
+ */
+struct SegmentInfo
+{
+  ScopedPendingInterestHandle interestHdl;
+  time::steady_clock::TimePoint timeSent;
+  time::nanoseconds rto;
+  SegmentState state;
+  int nRetx = 0; ///< # of times the segment has been retransmitted
+  uint64_t nDeliveredAtSend; ///< # of segments delivered when the Interest was sent
+  time::steady_clock::TimePoint deliveredTimeAtSend; ///< time of the last delivery at that point
+  size_t sourceIdx = 0; ///< source the Interest was last sent to, for pipelines with several
+};
+
+/**
+ * @brief Holds the SegmentInfo of the segments a pipeline has requested but not received
+ *
+ * Entries are kept in a ring indexed by segment number modulo the capacity, which spans from the
+ * lowest segment with an entry to the highest. Entries are contiguous and reused by later
+ * segments, so sending an Interest and receiving its Data neither hash nor allocate once the
+ * ring has warmed up. The ring doubles when a segment falls beyond its span.
+ */
+class SegmentTable : noncopyable
+{
+public:
+  explicit
+  SegmentTable(size_t initialCapacity = 64);
+
+  /**
+   * @return the entry of @p segNo, or nullptr if it has none
+   */
+  SegmentInfo*
+  find(uint64_t segNo);
+
+  /**
+   * @brief Entry of @p segNo, created if it has none
+   *
+   * A created entry has a zero retransmission count; its other fields must be set by the caller.
+   * The returned reference is invalidated by the next insert().
+   */
+  SegmentInfo&
+  insert(uint64_t segNo);
+
+  /**
+   * @brief Remove the entry of @p segNo, if any, and cancel its pending Interest
+   */
+  void
+  erase(uint64_t segNo);
+
+  /**
+   * @brief Remove the entries of the segments after @p segNo
+   * @return number of entries removed
+   */
+  size_t
+  eraseAfter(uint64_t segNo);
+
+  /**
+   * @brief Invoke @p onLost with the segments that Data of a segment at least @p threshold
+   *        higher overtook
+   *
+   * Checks each segment number once, in increasing order, from @p cursor up to
+   * @p highData - @p threshold, and advances @p cursor past them. Only segments sent once are
+   * reported: a retransmission was sent after the segments beyond it, so only its RTO can tell.
+   * @p onLost is invoked as `void(uint64_t segNo, SegmentInfo& info)` and must not insert or
+   * erase entries. A zero @p threshold disables the detection.
+   */
+  template<typename Function>
+  void
+  detectOvertaken(uint64_t& cursor, uint64_t highData, uint64_t threshold, const Function& onLost)
+  {
+    if (threshold == 0 || highData < threshold)
+      return;
+
+    for (; cursor + threshold <= highData; ++cursor) {
+      SegmentInfo* info = find(cursor);
+      if (info != nullptr && info->state == SegmentState::FirstTimeSent) {
+        onLost(cursor, *info);
+      }
+    }
+  }
+
+  /**
+   * @brief Invoke @p f with the segment number and entry of every segment, in increasing order
+   */
+  template<typename Function>
+  void
+  forEach(const Function& f) const
+  {
+    for (uint64_t segNo = m_begin; segNo < m_end; ++segNo) {
+      const Slot& slot = m_slots[getIndex(segNo)];
+      if (slot.isOccupied) {
+        f(segNo, slot.info);
+      }
+    }
+  }
+
+  bool
+  empty() const
+  {
+    return m_size == 0;
+  }
+
+  size_t
+  size() const
+  {
+    return m_size;
+  }
+
+  size_t
+  getCapacity() const
+  {
+    return m_slots.size();
+  }
+
+  /**
+   * @brief Remove all entries, cancelling their pending Interests
+   */
+  void
+  clear();
+
+private:
+  size_t
+  getIndex(uint64_t segNo) const
+  {
+    return static_cast<size_t>(segNo) & (m_slots.size() - 1);
+  }
+
+  void
+  grow(uint64_t begin, uint64_t end);
+
+private:
+  struct Slot
+  {
+    SegmentInfo info;
+    bool isOccupied = false;
+  };
+
+  std::vector<Slot> m_slots; ///< size is always a power of 2
+  uint64_t m_begin = 0;      ///< lowest segment with an entry
+  uint64_t m_end = 0;        ///< one past the highest segment with an entry
+  size_t m_size = 0;
+};
+
+} // namespace chunks
+} // namespace ndn
+
+#endif // NDN_TOOLS_CHUNKS_CATCHUNKS_SEGMENT_TABLE_HPP
@@ -0,0 +1,119 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016-2019, Regents of the University of California,
+ *                          Colorado State University,
+ *                          University Pierre & Marie Curie, Sorbonne University.
+ *
+ * This file is part of ndn-tools (Named Data Networking Essential Tools).
+ * See AUTHORS.md for complete list of ndn-tools authors and contributors.
+ *
+ * ndn-tools is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-tools is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-tools, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NDN_TOOLS_CHUNKS_CATCHUNKS_SPSC_QUEUE_HPP
+#define NDN_TOOLS_CHUNKS_CATCHUNKS_SPSC_QUEUE_HPP
+
+#include "ring-util.hpp"
+
+#include <atomic>
+
+namespace ndn {
+namespace chunks {
+
+/**
+ * @brief Bounded lock-free queue for exactly one producer thread and one consumer thread
+ *
+ * Elements stay in place until pop(), so the consumer can work on them through peek() without
+ * moving them out, e.g. while an asynchronous write of their contents is in flight.
+ */
+template<typename T>
+class SpscQueue : noncopyable
+{
+public:
+  /**
+   * @param capacity maximum number of elements, rounded up to a power of 2
+   */
+  explicit
+  SpscQueue(size_t capacity)
+    : m_slots(roundUpToPowerOf2(std::max<size_t>(capacity, 2)))
+    , m_mask(m_slots.size() - 1)
+  {
+  }
+
+  /**
+   * @brief Append @p value, called by the producer
+   * @return false if the queue is full, in which case @p value is left untouched
+   */
+  bool
+  push(T&& value)
+  {
+    size_t tail = m_tail.load(std::memory_order_relaxed);
+    if (tail - m_head.load(std::memory_order_acquire) == m_slots.size()) {
+      return false;
+    }
+    m_slots[tail & m_mask] = std::move(value);
+    m_tail.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * @brief Return the @p i-th element from the front, or nullptr, called by the consumer
+   */
+  T*
+  peek(size_t i = 0)
+  {
+    size_t head = m_head.load(std::memory_order_relaxed);
+    if (m_tail.load(std::memory_order_acquire) - head <= i) {
+      return nullptr;
+    }
+    return &m_slots[(head + i) & m_mask];
+  }
+
+  /**
+   * @brief Remove the first @p n elements, called by the consumer
+   * @pre at least @p n elements are in the queue
+   */
+  void
+  pop(size_t n = 1)
+  {
+    size_t head = m_head.load(std::memory_order_relaxed);
+    for (size_t i = 0; i < n; ++i) {
+      // release the resources held by the element before handing its slot back to the producer
+      m_slots[(head + i) & m_mask] = T();
+    }
+    m_head.store(head + n, std::memory_order_release);
+  }
+
+  bool
+  empty() const
+  {
+    return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire);
+  }
+
+  size_t
+  capacity() const
+  {
+    return m_slots.size();
+  }
+
+private:
+  std::vector<T> m_slots;
+  const size_t m_mask;
+  // kept on separate cache lines, each index is written by one thread only
+  alignas(64) std::atomic<size_t> m_head{0};
+  alignas(64) std::atomic<size_t> m_tail{0};
+};
+
+} // namespace chunks
+} // namespace ndn
+
+#endif // NDN_TOOLS_CHUNKS_CATCHUNKS_SPSC_QUEUE_HPP
@@ -0,0 +1,102 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016-2019, Regents of the University of California,
+ *                          Colorado State University,
+ *                          University Pierre & Marie Curie, Sorbonne University.
+ *
+ * This file is part of ndn-tools (Named Data Networking Essential Tools).
+ * See AUTHORS.md for complete list of ndn-tools authors and contributors.
+ *
+ * ndn-tools is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-tools is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-tools, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "validation-pool.hpp"
+
+#include <algorithm>
+
+namespace ndn {
+namespace chunks {
+
+constexpr size_t ValidationPool::MAX_PENDING_PER_THREAD;
+
+ValidationPool::ValidationPool(boost::asio::io_service& io, size_t nThreads,
+                               const ValidatorFactory& makeValidator)
+  : m_io(io)
+{
+  BOOST_ASSERT(nThreads > 0);
+  for (size_t i = 0; i < nThreads; ++i) {
+    auto worker = make_unique<Worker>();
+    worker->work = make_unique<boost::asio::io_service::work>(worker->io);
+    worker->validator = makeValidator(worker->io);
+    m_workers.push_back(std::move(worker));
+  }
+  // the validators are in place before any thread starts
+  for (auto& worker : m_workers) {
+    worker->thread = std::thread([&io = worker->io] { io.run(); });
+  }
+}
+
+ValidationPool::~ValidationPool()
+{
+  for (auto& worker : m_workers) {
+    worker->work.reset();
+    worker->io.stop();
+  }
+  for (auto& worker : m_workers) {
+    worker->thread.join();
+  }
+}
+
+void
+ValidationPool::validate(const Data& data,
+                         const security::v2::DataValidationSuccessCallback& successCb,
+                         const security::v2::DataValidationFailureCallback& failureCb)
+{
+  auto it = std::min_element(m_workers.begin(), m_workers.end(),
+                             [] (const auto& a, const auto& b) { return a->nPending < b->nPending; });
+  Worker& worker = **it;
+
+  ++worker.nPending;
+  if (m_nPending++ == 0) {
+    m_ioWork = make_unique<boost::asio::io_service::work>(m_io);
+  }
+
+  // the copy shares the wire encoding, but its parsed elements belong to the worker
+  auto copy = make_shared<Data>(data);
+  worker.io.post([this, &worker, copy, successCb, failureCb] {
+    worker.validator->validate(*copy,
+      [this, &worker, copy, successCb] (const Data&) {
+        m_io.post([this, &worker, copy, successCb] {
+          onValidationDone(worker);
+          successCb(*copy);
+        });
+      },
+      [this, &worker, copy, failureCb] (const Data&, const security::v2::ValidationError& error) {
+        m_io.post([this, &worker, copy, failureCb, error] {
+          onValidationDone(worker);
+          failureCb(*copy, error);
+        });
+      });
+  });
+}
+
+void
+ValidationPool::onValidationDone(Worker& worker)
+{
+  --worker.nPending;
+  if (--m_nPending == 0) {
+    m_ioWork.reset();
+  }
+}
+
+} // namespace chunks
+} // namespace ndn
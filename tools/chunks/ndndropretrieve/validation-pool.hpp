@@ -0,0 +1,121 @@
+/* -*- Mode:C++; c-file-style:"gnu"; indent-tabs-mode:nil; -*- */
+/*
+ * Copyright (c) 2016-2019, Regents of the University of California,
+ *                          Colorado State University,
+ *                          University Pierre & Marie Curie, Sorbonne University.
+ *
+ * This file is part of ndn-tools (Named Data Networking Essential Tools).
+ * See AUTHORS.md for complete list of ndn-tools authors and contributors.
+ *
+ * ndn-tools is free software: you can redistribute it and/or modify it under the terms
+ * of the GNU General Public License as published by the Free Software Foundation,
+ * either version 3 of the License, or (at your option) any later version.
+ *
+ * ndn-tools is distributed in the hope that it will be useful, but WITHOUT ANY WARRANTY;
+ * without even the implied warranty of MERCHANTABILITY or FITNESS FOR A PARTICULAR
+ * PURPOSE.  See the GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along with
+ * ndn-tools, e.g., in COPYING.md file.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef NDN_TOOLS_CHUNKS_CATCHUNKS_VALIDATION_POOL_HPP
+#define NDN_TOOLS_CHUNKS_CATCHUNKS_VALIDATION_POOL_HPP
+
+#include "core/common.hpp"
+
+#include <ndn-cxx/security/v2/validator.hpp>
+
+#include <boost/asio/io_service.hpp>
+#include <thread>
+
+namespace ndn {
+namespace chunks {
+
+/**
+ * @brief Validates Data packets on worker threads
+ *
+ * Each worker runs its own io_service and owns a Validator made by a ValidatorFactory, so
+ * validators never need to be thread-safe and may fetch certificates through a Face created on
+ * the worker's io_service. Results are posted back to the io_service given to the constructor,
+ * which is kept running while validations are outstanding. Results of different packets may be
+ * reported in a different order than the packets were submitted.
+ *
+ * All member functions must be called from the thread running that io_service.
+ */
+class ValidationPool : noncopyable
+{
+public:
+  using ValidatorFactory = std::function<unique_ptr<security::v2::Validator>(boost::asio::io_service& io)>;
+
+  /**
+   * @param io io_service on which the validation results are reported
+   * @param nThreads number of worker threads, at least one
+   * @param makeValidator invoked once per worker
+   */
+  ValidationPool(boost::asio::io_service& io, size_t nThreads, const ValidatorFactory& makeValidator);
+
+  /**
+   * @brief Stop the workers, dropping the outstanding validations
+   */
+  ~ValidationPool();
+
+  /**
+   * @brief Validate a copy of @p data on the least loaded worker
+   *
+   * Exactly one of the callbacks is later invoked on the io_service given to the constructor,
+   * unless the pool is destroyed first.
+   */
+  void
+  validate(const Data& data,
+           const security::v2::DataValidationSuccessCallback& successCb,
+           const security::v2::DataValidationFailureCallback& failureCb);
+
+  /**
+   * @brief Number of validations whose result has not been reported yet
+   */
+  size_t
+  getNPending() const
+  {
+    return m_nPending;
+  }
+
+  /**
+   * @brief Whether the workers have more work queued than they can start right away
+   *
+   * A consumer should stop increasing its request rate while this is true, since packets
+   * would only queue up waiting for validation.
+   */
+  bool
+  isBacklogged() const
+  {
+    return m_nPending > m_workers.size() * MAX_PENDING_PER_THREAD;
+  }
+
+private:
+  struct Worker
+  {
+    boost::asio::io_service io;
+    unique_ptr<boost::asio::io_service::work> work;
+    unique_ptr<security::v2::Validator> validator;
+    std::thread thread;
+    size_t nPending = 0;
+  };
+
+  void
+  onValidationDone(Worker& worker);
+
+private:
+  boost::asio::io_service& m_io;
+  std::vector<unique_ptr<Worker>> m_workers;
+  size_t m_nPending = 0;
+  unique_ptr<boost::asio::io_service::work> m_ioWork; ///< held while validations are outstanding
+
+PUBLIC_WITH_TESTS_ELSE_PRIVATE:
+  static constexpr size_t MAX_PENDING_PER_THREAD = 16;
+};
+
+} // namespace chunks
+} // namespace ndn
+
+#endif // NDN_TOOLS_CHUNKS_CATCHUNKS_VALIDATION_POOL_HPP